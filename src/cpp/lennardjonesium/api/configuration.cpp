@@ -20,23 +20,196 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <cstdint>
 #include <variant>
 #include <random>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <memory>
+#include <stdexcept>
+#include <istream>
+#include <map>
+#include <charconv>
+#include <algorithm>
+#include <cctype>
 
 #include <lennardjonesium/tools/system_parameters.hpp>
 #include <lennardjonesium/tools/cubic_lattice.hpp>
+#include <lennardjonesium/tools/overloaded_visitor.hpp>
 #include <lennardjonesium/physics/lennard_jones_force.hpp>
 #include <lennardjonesium/engine/initial_condition.hpp>
+#include <lennardjonesium/output/sinks.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
 #include <lennardjonesium/control/simulation_phase.hpp>
 #include <lennardjonesium/api/simulation.hpp>
 #include <lennardjonesium/api/configuration.hpp>
 
 namespace api
 {
+    namespace
+    {
+        output::LogFormat parse_log_format(const std::string& format)
+        {
+            if (format == "csv") {return output::LogFormat::csv;}
+            if (format == "binary") {return output::LogFormat::binary;}
+
+            throw std::invalid_argument("Unknown log format: " + format);
+        }
+
+        output::FileBackend parse_file_backend(const std::string& backend)
+        {
+            if (backend == "standard") {return output::FileBackend::standard;}
+            if (backend == "async") {return output::FileBackend::async;}
+            if (backend == "direct") {return output::FileBackend::direct;}
+            if (backend == "memory") {return output::FileBackend::memory;}
+
+            throw std::invalid_argument("Unknown file backend: " + backend);
+        }
+
+        output::LogCompression parse_log_compression(const std::string& compression)
+        {
+            if (compression == "none") {return output::LogCompression::none;}
+            if (compression == "gzip") {return output::LogCompression::gzip;}
+            if (compression == "zstd") {return output::LogCompression::zstd;}
+
+            throw std::invalid_argument("Unknown log compression: " + compression);
+        }
+
+        output::TrajectoryFormat parse_trajectory_format(const std::string& format)
+        {
+            if (format == "float64") {return output::TrajectoryFormat::float64;}
+            if (format == "float32") {return output::TrajectoryFormat::float32;}
+            if (format == "compressed") {return output::TrajectoryFormat::compressed;}
+
+            throw std::invalid_argument("Unknown trajectory format: " + format);
+        }
+
+        // A pointer to one of the settings in a Configuration, by type
+        using Setting = std::variant<double*, int*, unsigned int*, bool*, std::string*>;
+
+        // The settings of a Configuration, by their "section.key" names in an INI file
+        std::map<std::string, Setting, std::less<>> settings(Configuration& configuration)
+        {
+            auto& [system, minimization, equilibration, observation, filepaths] = configuration;
+
+            return {
+                {"system.temperature", &system.temperature},
+                {"system.density", &system.density},
+                {"system.particle_count", &system.particle_count},
+                {"system.random_seed", &system.random_seed},
+                {"system.cutoff_distance", &system.cutoff_distance},
+                {"system.time_delta", &system.time_delta},
+                {"system.checkpoint_interval", &system.checkpoint_interval},
+                {"system.snapshot_interval", &system.snapshot_interval},
+                {"system.trajectory_position_precision", &system.trajectory_position_precision},
+                {"system.trajectory_velocity_precision", &system.trajectory_velocity_precision},
+                {"system.trajectory_keyframe_interval", &system.trajectory_keyframe_interval},
+                {"system.replica_count", &system.replica_count},
+                {"system.thread_count", &system.thread_count},
+
+                {"minimization.enabled", &minimization.enabled},
+                {"minimization.name", &minimization.name},
+                {"minimization.energy_tolerance", &minimization.energy_tolerance},
+                {"minimization.check_interval", &minimization.check_interval},
+                {"minimization.mixing", &minimization.mixing},
+                {"minimization.mixing_decay", &minimization.mixing_decay},
+                {"minimization.delay", &minimization.delay},
+                {"minimization.timeout", &minimization.timeout},
+                {"minimization.thermodynamic_log_interval",
+                    &minimization.thermodynamic_log_interval},
+                {"minimization.thermodynamic_log_aggregate",
+                    &minimization.thermodynamic_log_aggregate},
+
+                {"equilibration.name", &equilibration.name},
+                {"equilibration.tolerance", &equilibration.tolerance},
+                {"equilibration.sample_size", &equilibration.sample_size},
+                {"equilibration.adjustment_interval", &equilibration.adjustment_interval},
+                {"equilibration.steady_state_time", &equilibration.steady_state_time},
+                {"equilibration.timeout", &equilibration.timeout},
+                {"equilibration.thermodynamic_log_interval",
+                    &equilibration.thermodynamic_log_interval},
+                {"equilibration.thermodynamic_log_aggregate",
+                    &equilibration.thermodynamic_log_aggregate},
+
+                {"observation.name", &observation.name},
+                {"observation.tolerance", &observation.tolerance},
+                {"observation.sample_size", &observation.sample_size},
+                {"observation.observation_interval", &observation.observation_interval},
+                {"observation.observation_count", &observation.observation_count},
+                {"observation.thermodynamic_log_interval",
+                    &observation.thermodynamic_log_interval},
+                {"observation.thermodynamic_log_aggregate",
+                    &observation.thermodynamic_log_aggregate},
+
+                {"filepaths.event_log", &filepaths.event_log},
+                {"filepaths.thermodynamic_log", &filepaths.thermodynamic_log},
+                {"filepaths.observation_log", &filepaths.observation_log},
+                {"filepaths.snapshot_log", &filepaths.snapshot_log},
+                {"filepaths.thermodynamic_log_format", &filepaths.thermodynamic_log_format},
+                {"filepaths.observation_log_format", &filepaths.observation_log_format},
+                {"filepaths.file_backend", &filepaths.file_backend},
+                {"filepaths.log_compression", &filepaths.log_compression},
+                {"filepaths.trajectory", &filepaths.trajectory},
+                {"filepaths.trajectory_format", &filepaths.trajectory_format},
+                {"filepaths.checkpoint", &filepaths.checkpoint},
+                {"filepaths.initial_state", &filepaths.initial_state},
+                {"filepaths.final_state", &filepaths.final_state},
+                {"filepaths.state_cache", &filepaths.state_cache},
+                {"filepaths.state_cache_megabytes", &filepaths.state_cache_megabytes}
+            };
+        }
+
+        std::string_view trim(std::string_view text)
+        {
+            auto is_space = [](unsigned char c) {return std::isspace(c);};
+
+            while (!text.empty() && is_space(text.front())) {text.remove_prefix(1);}
+            while (!text.empty() && is_space(text.back())) {text.remove_suffix(1);}
+
+            return text;
+        }
+
+        std::string lowercase(std::string_view text)
+        {
+            std::string result{text};
+            std::ranges::transform(
+                result, result.begin(), [](unsigned char c) {return std::tolower(c);}
+            );
+            return result;
+        }
+
+        // Parses the whole of the text as a number (allowing a leading '+', as Python does)
+        template<class Number>
+        Number parse_number(std::string_view text, const std::string& name)
+        {
+            if (text.starts_with('+')) {text.remove_prefix(1);}
+
+            Number value{};
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+            if (error != std::errc{} || end != text.data() + text.size())
+            {
+                throw std::invalid_argument(
+                    "Invalid value for " + name + ": " + std::string{text}
+                );
+            }
+
+            return value;
+        }
+
+        bool parse_bool(std::string_view text, const std::string& name)
+        {
+            auto value = lowercase(text);
+
+            if (value == "1" || value == "yes" || value == "true" || value == "on") {return true;}
+            if (value == "0" || value == "no" || value == "false" || value == "off") {return false;}
+
+            throw std::invalid_argument("Invalid value for " + name + ": " + value);
+        }
+    }
+
     std::unique_ptr<Simulation> make_simulation(const Configuration& configuration)
     {
         // First create the Simulation::Parameters struct
@@ -58,37 +231,157 @@ namespace api
 
             .time_delta = configuration.system.time_delta,
 
-            .schedule_parameters = {
-                {
-                    configuration.equilibration.name,
-                    control::EquilibrationPhase::Parameters{
-                        .tolerance = configuration.equilibration.tolerance,
-                        .sample_size =  configuration.equilibration.sample_size,
-                        .adjustment_interval = configuration.equilibration.adjustment_interval,
-                        .steady_state_time = configuration.equilibration.steady_state_time,
-                        .timeout = configuration.equilibration.timeout
-                    }
-                },
-
-                {
-                    configuration.observation.name,
-                    control::ObservationPhase::Parameters{
-                        .tolerance = configuration.observation.tolerance,
-                        .sample_size = configuration.observation.sample_size,
-                        .observation_interval = configuration.observation.observation_interval,
-                        .observation_count = configuration.observation.observation_count
-                    }
-                }
-            },
+            .schedule_parameters = {},
 
             .event_log_path = configuration.filepaths.event_log,
             .thermodynamic_log_path = configuration.filepaths.thermodynamic_log,
             .observation_log_path = configuration.filepaths.observation_log,
-            .snapshot_log_path = configuration.filepaths.snapshot_log
+            .snapshot_log_path = configuration.filepaths.snapshot_log,
+
+            .thermodynamic_log_format =
+                parse_log_format(configuration.filepaths.thermodynamic_log_format),
+            .observation_log_format =
+                parse_log_format(configuration.filepaths.observation_log_format),
+            .file_backend = parse_file_backend(configuration.filepaths.file_backend),
+            .log_compression = parse_log_compression(configuration.filepaths.log_compression),
+
+            .trajectory_path = configuration.filepaths.trajectory,
+            .snapshot_interval = configuration.system.snapshot_interval,
+            .trajectory_format =
+                parse_trajectory_format(configuration.filepaths.trajectory_format),
+            .trajectory_compression = {
+                .position_precision = configuration.system.trajectory_position_precision,
+                .velocity_precision = configuration.system.trajectory_velocity_precision,
+                .keyframe_interval = configuration.system.trajectory_keyframe_interval
+            },
+
+            .checkpoint_path = configuration.filepaths.checkpoint,
+            .checkpoint_interval = configuration.system.checkpoint_interval,
+
+            .initial_state_path = configuration.filepaths.initial_state,
+            .final_state_path = configuration.filepaths.final_state,
+
+            .state_cache_path = configuration.filepaths.state_cache,
+            .state_cache_size =
+                static_cast<std::uintmax_t>(configuration.filepaths.state_cache_megabytes) << 20,
+
+            .replica_count = configuration.system.replica_count,
+            .thread_count = configuration.system.thread_count
         };
 
+        // Next assemble the schedule, which optionally begins with energy minimization
+        if (configuration.minimization.enabled)
+        {
+            parameters.schedule_parameters.emplace_back(
+                configuration.minimization.name,
+                control::MinimizationPhase::Parameters{
+                    .energy_tolerance = configuration.minimization.energy_tolerance,
+                    .check_interval = configuration.minimization.check_interval,
+                    .mixing = configuration.minimization.mixing,
+                    .mixing_decay = configuration.minimization.mixing_decay,
+                    .delay = configuration.minimization.delay,
+                    .timeout = configuration.minimization.timeout,
+                    .thermodynamic_log = {
+                        .interval = configuration.minimization.thermodynamic_log_interval,
+                        .aggregate = configuration.minimization.thermodynamic_log_aggregate
+                    }
+                }
+            );
+        }
+
+        parameters.schedule_parameters.emplace_back(
+            configuration.equilibration.name,
+            control::EquilibrationPhase::Parameters{
+                .tolerance = configuration.equilibration.tolerance,
+                .sample_size =  configuration.equilibration.sample_size,
+                .adjustment_interval = configuration.equilibration.adjustment_interval,
+                .steady_state_time = configuration.equilibration.steady_state_time,
+                .timeout = configuration.equilibration.timeout,
+                .thermodynamic_log = {
+                    .interval = configuration.equilibration.thermodynamic_log_interval,
+                    .aggregate = configuration.equilibration.thermodynamic_log_aggregate
+                }
+            }
+        );
+
+        parameters.schedule_parameters.emplace_back(
+            configuration.observation.name,
+            control::ObservationPhase::Parameters{
+                .tolerance = configuration.observation.tolerance,
+                .sample_size = configuration.observation.sample_size,
+                .observation_interval = configuration.observation.observation_interval,
+                .observation_count = configuration.observation.observation_count,
+                .thermodynamic_log = {
+                    .interval = configuration.observation.thermodynamic_log_interval,
+                    .aggregate = configuration.observation.thermodynamic_log_aggregate
+                }
+            }
+        );
+
         // Now create the Simulation object
         return std::make_unique<Simulation>(parameters);
     }
+
+    Configuration parse_configuration(std::istream& input)
+    {
+        Configuration configuration{};
+        auto configuration_settings = settings(configuration);
+
+        std::string section;
+        std::string line;
+        int line_number = 0;
+
+        while (std::getline(input, line))
+        {
+            ++line_number;
+            auto text = trim(line);
+
+            // Blank lines and comments
+            if (text.empty() || text.starts_with('#') || text.starts_with(';')) {continue;}
+
+            if (text.starts_with('['))
+            {
+                if (!text.ends_with(']'))
+                {
+                    throw std::invalid_argument(
+                        "Malformed section header on line " + std::to_string(line_number)
+                    );
+                }
+
+                section = trim(text.substr(1, text.size() - 2));
+                continue;
+            }
+
+            auto separator = text.find_first_of("=:");
+
+            if (separator == std::string_view::npos || section.empty())
+            {
+                throw std::invalid_argument(
+                    "Malformed setting on line " + std::to_string(line_number)
+                );
+            }
+
+            // As in Python's configparser, the keys are not case-sensitive
+            auto name = section + "." + lowercase(trim(text.substr(0, separator)));
+            auto value = trim(text.substr(separator + 1));
+
+            auto setting = configuration_settings.find(name);
+            if (setting == configuration_settings.end()) {continue;}
+
+            std::visit(
+                tools::OverloadedVisitor
+                {
+                    [&](double* target) {*target = parse_number<double>(value, name);},
+                    [&](int* target) {*target = parse_number<int>(value, name);},
+                    [&](unsigned int* target) {*target = parse_number<unsigned int>(value, name);},
+                    [&](bool* target) {*target = parse_bool(value, name);},
+                    [&](std::string* target) {*target = value;}
+                },
+                setting->second
+            );
+        }
+
+        return configuration;
+    }
 } // namespace api
 
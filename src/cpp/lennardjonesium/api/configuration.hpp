@@ -26,6 +26,7 @@
 #include <random>
 #include <string>
 #include <memory>
+#include <istream>
 
 #include <lennardjonesium/api/seed_generator.hpp>
 #include <lennardjonesium/api/simulation.hpp>
@@ -58,6 +59,41 @@ namespace api
 
             // Time step size
             double time_delta = 0.005;
+
+            // Time steps between checkpoints (0 means only on request)
+            int checkpoint_interval = 0;
+
+            // Time steps between trajectory frames (only used if a trajectory file is given)
+            int snapshot_interval = 0;
+
+            // Precision of the compressed trajectory format, and frames between its keyframes
+            double trajectory_position_precision = 1.0e-3;
+            double trajectory_velocity_precision = 1.0e-3;
+            int trajectory_keyframe_interval = 100;
+
+            // Number of independent replicas to run and combine
+            int replica_count = 1;
+
+            // Number of threads to run the replicas on (0 means one per replica)
+            int thread_count = 0;
+        };
+
+        struct Minimization
+        {
+            // Minimization Phase parameters (the phase is only run if enabled):
+            bool enabled = false;
+            std::string name = "Minimization Phase";
+            double energy_tolerance = 1.0e-6;
+            int check_interval = 20;
+            double mixing = 0.1;
+            double mixing_decay = 0.99;
+            int delay = 5;
+            int timeout = 2000;
+
+            // Log every interval-th measurement, or aggregate blocks of interval measurements
+            // (see control::ThermodynamicLogPolicy)
+            int thermodynamic_log_interval = 1;
+            bool thermodynamic_log_aggregate = false;
         };
 
         struct Equilibration
@@ -69,6 +105,10 @@ namespace api
             int adjustment_interval = 200;
             int steady_state_time = 1000;
             int timeout = 5000;
+
+            // Thermodynamic log policy, as for the Minimization Phase
+            int thermodynamic_log_interval = 1;
+            bool thermodynamic_log_aggregate = false;
         };
 
         struct Observation
@@ -79,6 +119,10 @@ namespace api
             int sample_size = 50;
             int observation_interval = 200;
             int observation_count = 20;
+
+            // Thermodynamic log policy, as for the Minimization Phase
+            int thermodynamic_log_interval = 1;
+            bool thermodynamic_log_aggregate = false;
         };
 
         struct Filepaths
@@ -88,14 +132,43 @@ namespace api
             std::string thermodynamic_log = "thermodynamics.csv";
             std::string observation_log = "observations.csv";
             std::string snapshot_log = "snapshots.csv";
+
+            // Formats of the thermodynamic and observation logs ("csv" or "binary")
+            std::string thermodynamic_log_format = "csv";
+            std::string observation_log_format = "csv";
+
+            // How the log files are written ("standard", "async", "direct", or "memory"; see
+            // output::FileBackend)
+            std::string file_backend = "standard";
+
+            // Compression of the text logs ("none", "gzip", or "zstd"; see output::LogCompression)
+            std::string log_compression = "none";
+
+            // Trajectory file (empty means no trajectory) and its format ("float64", "float32",
+            // or "compressed")
+            std::string trajectory = "";
+            std::string trajectory_format = "float64";
+
+            // Checkpoint file (empty means no checkpoints)
+            std::string checkpoint = "";
+
+            // State files for warm starts (empty means start from the lattice / do not save)
+            std::string initial_state = "";
+            std::string final_state = "";
+
+            // Equilibrated-state cache directory (empty means no cache) and its size limit
+            std::string state_cache = "";
+            int state_cache_megabytes = 1024;
         };
 
         /**
          * We include one instance of each parameter category.  So, we will always run a simulation
-         * consisting of one Equilibration phase followed by one Observation phase.
+         * consisting of one Equilibration phase followed by one Observation phase, optionally
+         * preceded by one Minimization phase.
          */
 
         System system{};
+        Minimization minimization{};
         Equilibration equilibration{};
         Observation observation{};
         Filepaths filepaths{};
@@ -105,6 +178,15 @@ namespace api
      * We also provide a factory function which creates a simulation from these parameters.
      */
     std::unique_ptr<Simulation> make_simulation(const Configuration&);
+
+    /**
+     * Reads a Configuration from an INI file, as written by the Python Configuration class: one
+     * section per category ([system], [minimization], and so on), and one "key = value" line per
+     * setting.  Settings which are not given keep their defaults, and unknown sections and keys
+     * are ignored, as in Python.  Booleans may be written as true/false, yes/no, on/off, or 1/0.
+     * Throws std::invalid_argument on a line or value which cannot be parsed.
+     */
+    Configuration parse_configuration(std::istream&);
 } // namespace api
 
 
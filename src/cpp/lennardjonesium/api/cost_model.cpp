@@ -0,0 +1,98 @@
+/**
+ * cost_model.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <numbers>
+#include <variant>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+#include <lennardjonesium/physics/lennard_jones_force.hpp>
+#include <lennardjonesium/control/simulation_phase.hpp>
+#include <lennardjonesium/api/simulation.hpp>
+#include <lennardjonesium/api/cost_model.hpp>
+
+namespace api
+{
+    namespace
+    {
+        // The average number of neighbors of a particle within the cutoff distance
+        struct NeighborCount
+        {
+            double density;
+
+            double operator() (const physics::LennardJonesForce::Parameters& parameters)
+            {
+                double cutoff = parameters.cutoff_distance;
+                return density * (4.0 / 3.0) * std::numbers::pi * cutoff * cutoff * cutoff;
+            }
+        };
+    }
+
+    CostModel::Features CostModel::features(const Simulation::Parameters& parameters)
+    {
+        double time_steps = Simulation::maximum_time_steps(parameters);
+
+        double particle_steps = time_steps
+            * parameters.system_parameters.particle_count
+            * parameters.replica_count;
+
+        double neighbors = std::visit(
+            NeighborCount{parameters.system_parameters.density}, parameters.force_parameters
+        );
+
+        return {.pair_work = particle_steps * neighbors, .particle_steps = particle_steps};
+    }
+
+    Eigen::Vector2d CostModel::scaled_(const Features& features)
+    {
+        return {
+            features.pair_work * default_pair_time,
+            features.particle_steps * default_particle_step_time
+        };
+    }
+
+    double CostModel::estimate(const Features& features) const
+    {
+        return scaled_(features).dot(scale_factors_);
+    }
+
+    void CostModel::observe(const Features& features, double seconds)
+    {
+        Eigen::Vector2d x = scaled_(features);
+
+        ++observation_count_;
+        normal_matrix_ += x * x.transpose();
+        normal_vector_ += seconds * x;
+
+        // Ridge regression towards scale factors of 1, i.e. the defaults
+        Eigen::Matrix2d regularized = normal_matrix_
+            + default_weight * Eigen::Matrix2d::Identity();
+        Eigen::Vector2d target = normal_vector_ + default_weight * Eigen::Vector2d::Ones();
+
+        scale_factors_ = regularized.ldlt().solve(target);
+
+        // The two features are nearly proportional across a typical sweep, so the fit can trade
+        // one against the other; a negative time per unit of work is never meaningful
+        scale_factors_ = scale_factors_.cwiseMax(0.0);
+    }
+} // namespace api
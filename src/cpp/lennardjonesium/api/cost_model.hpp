@@ -0,0 +1,102 @@
+/**
+ * cost_model.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_COST_MODEL_HPP
+#define LJ_COST_MODEL_HPP
+
+#include <Eigen/Dense>
+
+#include <lennardjonesium/api/simulation.hpp>
+
+namespace api
+{
+    class CostModel
+    {
+        /**
+         * CostModel estimates the running time of a Simulation in seconds, so that the
+         * SimulationPool can start the longest jobs first.
+         * 
+         * The time is modeled as a linear function of two features of the Parameters:
+         * 
+         *  pair_work:      the number of pair interactions computed, i.e. time steps times
+         *                  particle count times the number of neighbors within the cutoff
+         *                  distance (which grows with the density)
+         * 
+         *  particle_steps: time steps times particle count, for the work done on each particle
+         *                  (integration, boundary conditions, measurements)
+         * 
+         * The number of time steps is the maximum that the schedule allows (the timeout of the
+         * Minimization and Equilibration Phases, and the full length of the Observation Phases),
+         * times the number of replicas.
+         * 
+         * The coefficients start from rough defaults, and are refitted by ridge regression
+         * towards those defaults as the observed running times of finished jobs come in.  So the
+         * estimates improve over the course of a sweep, and a few outliers (e.g. jobs which
+         * equilibrated early, or were warm-started) do not throw them off.
+         */
+
+        public:
+            struct Features
+            {
+                double pair_work{};
+                double particle_steps{};
+
+                Features& operator+= (const Features& other)
+                {
+                    pair_work += other.pair_work;
+                    particle_steps += other.particle_steps;
+                    return *this;
+                }
+            };
+
+            static Features features(const Simulation::Parameters&);
+
+            // Estimated running time in seconds
+            double estimate(const Features&) const;
+
+            // Record the observed running time of a finished job
+            void observe(const Features&, double seconds);
+
+            int observation_count() const {return observation_count_;}
+
+        private:
+            // Rough defaults for the time per pair interaction and per particle step, in seconds
+            static constexpr double default_pair_time = 2.0e-8;
+            static constexpr double default_particle_step_time = 1.0e-7;
+
+            // The weight of the defaults in the fit, in units of (seconds)^2: the defaults count
+            // for about as much as one observed job of one second
+            static constexpr double default_weight = 1.0;
+
+            // The fit is done in terms of scale factors relative to the defaults, so that both
+            // features have comparable sizes
+            static Eigen::Vector2d scaled_(const Features&);
+
+            int observation_count_{0};
+            Eigen::Matrix2d normal_matrix_ = Eigen::Matrix2d::Zero();
+            Eigen::Vector2d normal_vector_ = Eigen::Vector2d::Zero();
+            Eigen::Vector2d scale_factors_ = Eigen::Vector2d::Ones();
+    };
+} // namespace api
+
+
+#endif
@@ -39,6 +39,20 @@ namespace api
         public:
             inline std::random_device::result_type get() {return rd();}
 
+            // Derive the seed for an independent replica of a simulation.  Replica 0 keeps the
+            // original seed, so that a single replica is the same as no replicas at all.
+            inline static std::random_device::result_type replica_seed(
+                std::random_device::result_type seed, int replica
+            )
+            {
+                if (replica == 0) {return seed;}
+
+                std::seed_seq sequence{seed, static_cast<std::random_device::result_type>(replica)};
+                std::random_device::result_type derived_seed;
+                sequence.generate(&derived_seed, &derived_seed + 1);
+                return derived_seed;
+            }
+
             inline static constexpr std::random_device::result_type default_seed =
                 engine::InitialCondition::random_number_engine_type::default_seed;
 
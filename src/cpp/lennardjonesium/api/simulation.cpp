@@ -21,30 +21,80 @@
  */
 
 #include <cassert>
+#include <csignal>
 #include <memory>
+#include <ostream>
 #include <variant>
 #include <vector>
+#include <string>
 #include <utility>
+#include <optional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
 #include <filesystem>
+#include <system_error>
+
+#include <fmt/format.h>
 
 #include <boost/iostreams/stream.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/chain.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/device/file.hpp>
 
 #include <lennardjonesium/tools/overloaded_visitor.hpp>
 #include <lennardjonesium/tools/system_parameters.hpp>
+#include <lennardjonesium/physics/system_state.hpp>
+#include <lennardjonesium/physics/observation.hpp>
+#include <lennardjonesium/physics/observation_statistics.hpp>
 #include <lennardjonesium/physics/forces.hpp>
 #include <lennardjonesium/physics/lennard_jones_force.hpp>
 #include <lennardjonesium/engine/initial_condition.hpp>
 #include <lennardjonesium/engine/integrator_builder.hpp>
 #include <lennardjonesium/output/logger.hpp>
+#include <lennardjonesium/output/io_service.hpp>
+#include <lennardjonesium/output/async_file.hpp>
+#include <lennardjonesium/output/log_compression.hpp>
+#include <lennardjonesium/output/memory_logs.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
+#include <lennardjonesium/output/state_file.hpp>
+#include <lennardjonesium/output/observation_log.hpp>
+#include <lennardjonesium/output/sinks.hpp>
 #include <lennardjonesium/control/simulation_phase.hpp>
 #include <lennardjonesium/control/simulation_controller.hpp>
+#include <lennardjonesium/api/seed_generator.hpp>
+#include <lennardjonesium/api/state_cache.hpp>
 #include <lennardjonesium/api/simulation.hpp>
 
 namespace api
 {
+    namespace
+    {
+        // The log files are opened by streams which fail silently, so check that they can be
+        // created at all, rather than run a simulation whose output goes nowhere
+        void require_directories(const std::vector<std::filesystem::path>& paths)
+        {
+            for (const auto& path : paths)
+            {
+                auto directory = path.parent_path();
+
+                if (!directory.empty() && !std::filesystem::is_directory(directory))
+                {
+                    throw std::filesystem::filesystem_error(
+                        "Output directory does not exist",
+                        path,
+                        std::make_error_code(std::errc::no_such_file_or_directory)
+                    );
+                }
+            }
+        }
+    }
+
     Simulation::Simulation(Simulation::Parameters parameters)
         : parameters_{parameters},
           initial_condition_{
@@ -67,56 +117,758 @@ namespace api
         );
 
         assert(short_range_force_ != nullptr && "Failed to construct ShortRangeForce");
+
+        // Resuming cuts the logs back to their size at the checkpoint, which cannot be done to a
+        // compressed stream
+        if (parameters_.log_compression != output::LogCompression::none
+            && !parameters_.checkpoint_path.empty())
+        {
+            throw std::invalid_argument("Compressed logs cannot be combined with checkpoints");
+        }
+
+        // Logs kept in memory cannot be cut back to a checkpoint, or read back to be combined
+        if (parameters_.file_backend == output::FileBackend::memory
+            && (!parameters_.checkpoint_path.empty() || parameters_.replica_count > 1))
+        {
+            throw std::invalid_argument(
+                "In-memory logs cannot be combined with checkpoints or replicas"
+            );
+        }
+
+        set_initial_state(parameters_.initial_state);
     }
 
-    void Simulation::run(echo_chain_type echo_chain)
+    void Simulation::set_initial_state(std::shared_ptr<const physics::SystemState> initial_state)
     {
-        using event_stream_type = boost::iostreams::filtering_ostream;
-        using file_sink_type = boost::iostreams::file_sink;
-        using file_stream_type = boost::iostreams::stream<file_sink_type>;
+        if (initial_state
+            && initial_state->particle_count() != parameters_.system_parameters.particle_count)
+        {
+            throw std::invalid_argument("The initial state has the wrong number of particles");
+        }
+
+        parameters_.initial_state = std::move(initial_state);
+    }
 
-        // Set up streams
-        echo_chain.push(file_sink_type{parameters_.event_log_path});
-        event_stream_type event_stream{echo_chain};
+    int Simulation::requested_thread_count() const
+    {
+        if (parameters_.thread_count <= 0) {return parameters_.replica_count;}
+        return std::min(parameters_.thread_count, parameters_.replica_count);
+    }
 
-        file_stream_type thermodynamic_stream{
-            file_sink_type{parameters_.thermodynamic_log_path}
+    int Simulation::maximum_time_steps(const Parameters& parameters)
+    {
+        auto phase_time_steps = tools::OverloadedVisitor
+        {
+            [](const control::MinimizationPhase::Parameters& phase) {return phase.timeout;},
+            [](const control::EquilibrationPhase::Parameters& phase) {return phase.timeout;},
+            [](const control::ObservationPhase::Parameters& phase)
+                {return phase.observation_interval * phase.observation_count;}
         };
 
-        file_stream_type observation_stream{
-            file_sink_type{parameters_.observation_log_path}
+        int time_steps = 0;
+
+        for (const auto& named_phase : parameters.schedule_parameters)
+        {
+            time_steps += std::visit(phase_time_steps, named_phase.second);
+        }
+
+        return time_steps;
+    }
+
+    void Simulation::run(
+        echo_chain_type echo_chain,
+        output::IOService* io_service,
+        int thread_count,
+        control::Progress* progress
+    )
+    {
+        if (parameters_.replica_count > 1)
+        {
+            run_replicas_(std::move(echo_chain), false, io_service, thread_count, progress);
+            return;
+        }
+
+        run_(std::move(echo_chain), std::nullopt, io_service, progress);
+    }
+
+    void Simulation::resume(
+        echo_chain_type echo_chain,
+        output::IOService* io_service,
+        int thread_count,
+        control::Progress* progress
+    )
+    {
+        // Each replica resumes from its own checkpoint
+        if (parameters_.replica_count > 1)
+        {
+            run_replicas_(std::move(echo_chain), true, io_service, thread_count, progress);
+            return;
+        }
+
+        std::optional<output::Checkpoint> checkpoint;
+
+        if (!parameters_.checkpoint_path.empty())
+        {
+            checkpoint = output::read_checkpoint(parameters_.checkpoint_path);
+        }
+
+        // Refuse to continue a checkpoint that was written by a different simulation
+        if (checkpoint && (checkpoint->prelude != fingerprint()
+                           || checkpoint->log_sizes.size() != log_paths_().size()))
+        {
+            throw std::runtime_error(
+                "Checkpoint " + parameters_.checkpoint_path.string()
+                + " does not belong to this simulation"
+            );
+        }
+
+        run_(std::move(echo_chain), std::move(checkpoint), io_service, progress);
+    }
+
+    void Simulation::checkpoint_on_signal(int signal_number)
+    {
+        std::signal(
+            signal_number,
+            [](int) {control::SimulationController::request_checkpoint();}
+        );
+    }
+
+    std::string Simulation::fingerprint() const
+    {
+        return describe_(parameters_.schedule_parameters.size(), true);
+    }
+
+    std::string Simulation::describe_(std::size_t phase_count, bool with_names) const
+    {
+        /**
+         * We print every parameter which affects the physics, in a fixed order.  Floating-point
+         * values are printed in their shortest round-trip representation, so two descriptions are
+         * equal exactly when the parameters are.
+         */
+
+        fmt::memory_buffer buffer;
+        auto out = std::back_inserter(buffer);
+
+        const auto& system = parameters_.system_parameters;
+        fmt::format_to(
+            out, "particle_count={};temperature={};density={};random_seed={};time_delta={};",
+            system.particle_count, system.temperature, system.density,
+            parameters_.random_seed, parameters_.time_delta
+        );
+
+        fmt::format_to(out, "unit_cell=");
+        for (auto coefficient : parameters_.unit_cell.reshaped())
+        {
+            fmt::format_to(out, "{},", coefficient);
+        }
+        fmt::format_to(out, ";");
+
+        auto describe_force = tools::OverloadedVisitor
+        {
+            [&out](const physics::LennardJonesForce::Parameters& p)
+            {
+                fmt::format_to(out, "lennard_jones(cutoff_distance={});", p.cutoff_distance);
+            }
         };
 
-        file_stream_type snapshot_stream{
-            file_sink_type{parameters_.snapshot_log_path}
+        std::visit(describe_force, parameters_.force_parameters);
+
+        // Only mentioned when used, so that descriptions of single runs are unaffected
+        if (parameters_.replica_count > 1)
+        {
+            fmt::format_to(out, "replica_count={};", parameters_.replica_count);
+        }
+
+        auto describe_phase = tools::OverloadedVisitor
+        {
+            [&out](const control::MinimizationPhase::Parameters& p)
+            {
+                fmt::format_to(
+                    out, "minimization({},{},{},{},{},{})",
+                    p.energy_tolerance, p.check_interval, p.mixing, p.mixing_decay, p.delay,
+                    p.timeout
+                );
+            },
+
+            [&out](const control::EquilibrationPhase::Parameters& p)
+            {
+                fmt::format_to(
+                    out, "equilibration({},{},{},{},{})",
+                    p.tolerance, p.sample_size, p.adjustment_interval, p.steady_state_time,
+                    p.timeout
+                );
+            },
+
+            [&out](const control::ObservationPhase::Parameters& p)
+            {
+                fmt::format_to(
+                    out, "observation({},{},{},{})",
+                    p.tolerance, p.sample_size, p.observation_interval, p.observation_count
+                );
+            }
+        };
+
+        for (std::size_t i = 0; i < phase_count; ++i)
+        {
+            const auto& [name, phase_parameters] = parameters_.schedule_parameters[i];
+
+            fmt::format_to(out, "phase[{}]=", with_names ? name : std::to_string(i));
+            std::visit(describe_phase, phase_parameters);
+            fmt::format_to(out, ";");
+        }
+
+        return fmt::to_string(buffer);
+    }
+
+    bool Simulation::thermodynamic_log_aggregated_() const
+    {
+        auto aggregates = [](const auto& phase_parameters)
+        {
+            return phase_parameters.thermodynamic_log.aggregate;
+        };
+
+        return std::ranges::any_of(
+            parameters_.schedule_parameters,
+            [&aggregates](const auto& phase) {return std::visit(aggregates, phase.second);}
+        );
+    }
+
+    physics::SystemState Simulation::initial_state_()
+    {
+        // A state given directly is used as it is, apart from the velocities, and its forces are
+        // recomputed (as for a fresh lattice), since they may not have been given
+        if (parameters_.initial_state)
+        {
+            const auto& given_state = *parameters_.initial_state;
+
+            auto state = given_state.velocities.isZero()
+                ? engine::InitialCondition{
+                      parameters_.system_parameters,
+                      given_state.positions,
+                      parameters_.random_seed
+                  }.system_state()
+                : engine::InitialCondition{
+                      parameters_.system_parameters,
+                      given_state,
+                      parameters_.system_parameters,
+                      parameters_.random_seed
+                  }.system_state();
+
+            state | physics::clear_dynamics;
+            return state;
+        }
+
+        if (parameters_.initial_state_path.empty())
+        {
+            return initial_condition_.system_state();
+        }
+
+        auto previous = output::read_state_file(parameters_.initial_state_path);
+
+        if (!previous
+            || previous->system_parameters.particle_count
+                != parameters_.system_parameters.particle_count)
+        {
+            return initial_condition_.system_state();
+        }
+
+        engine::InitialCondition warm_start{
+            parameters_.system_parameters,
+            std::move(previous->system_state),
+            previous->system_parameters,
+            parameters_.random_seed
         };
 
+        return warm_start.system_state();
+    }
+
+    void Simulation::run_(
+        echo_chain_type echo_chain,
+        std::optional<output::Checkpoint> checkpoint,
+        output::IOService* io_service,
+        control::Progress* progress
+    )
+    {
+        auto log_paths = log_paths_();
+        bool recording_trajectory = !parameters_.trajectory_path.empty();
+
+        // When resuming, discard anything logged after the checkpoint, and append from there
+        bool resuming = checkpoint.has_value();
+
+        if (resuming)
+        {
+            for (std::size_t i = 0; i < log_paths.size(); ++i)
+            {
+                std::filesystem::resize_file(log_paths[i], checkpoint->log_sizes[i]);
+            }
+        }
+
+        auto mode = std::ios::out | std::ios::binary;
+        if (resuming) {mode |= std::ios::app;}
+
+        // Set up streams, which end either in the log files or in new memory buffers
+        bool in_memory = (parameters_.file_backend == output::FileBackend::memory);
+
+        std::unique_ptr<std::ostream> thermodynamic_stream;
+        std::unique_ptr<std::ostream> observation_stream;
+        std::unique_ptr<std::ostream> snapshot_stream;
+
+        // New buffers, which are published when the run is over
+        output::MemoryLogs memory_logs;
+
+        if (in_memory)
+        {
+            echo_chain.push(output::memory_log_device{*memory_logs.event_log});
+
+            thermodynamic_stream = std::make_unique<output::MemoryLogStream>(
+                output::memory_log_device{*memory_logs.thermodynamic_log}
+            );
+            observation_stream = std::make_unique<output::MemoryLogStream>(
+                output::memory_log_device{*memory_logs.observation_log}
+            );
+            snapshot_stream = std::make_unique<output::MemoryLogStream>(
+                output::memory_log_device{*memory_logs.snapshot_log}
+            );
+        }
+        else
+        {
+            require_directories(log_paths);
+
+            if (async_files_())
+            {
+                echo_chain.push(
+                    output::AsyncFileSink{parameters_.event_log_path, mode, async_file_options_()}
+                );
+            }
+            else
+            {
+                echo_chain.push(boost::iostreams::file_sink{parameters_.event_log_path, mode});
+            }
+
+            thermodynamic_stream = open_log_(
+                parameters_.thermodynamic_log_path,
+                mode,
+                log_compression_(parameters_.thermodynamic_log_format)
+            );
+            observation_stream = open_log_(
+                parameters_.observation_log_path,
+                mode,
+                log_compression_(parameters_.observation_log_format)
+            );
+            snapshot_stream = open_log_(
+                parameters_.snapshot_log_path, mode, log_compression_(output::LogFormat::csv)
+            );
+        }
+
+        // The event stream writes directly into the echo chain (rather than through a
+        // filtering_ostream wrapped around it), so that flushing it reaches the file.
+        std::ostream event_stream{&echo_chain.front()};
+
+        // Set up the trajectory, if requested.  When resuming, the frames already in the file
+        // are carried over into the index.
+        std::unique_ptr<std::ostream> trajectory_stream;
+        std::optional<output::TrajectorySink> trajectory_sink;
+
+        if (recording_trajectory)
+        {
+            std::optional<output::TrajectoryIndex> existing_frames;
+            if (resuming)
+            {
+                existing_frames = output::read_trajectory_index(parameters_.trajectory_path);
+            }
+
+            trajectory_stream = open_log_(parameters_.trajectory_path, mode);
+
+            if (parameters_.trajectory_format == output::TrajectoryFormat::compressed)
+            {
+                trajectory_sink.emplace(
+                    *trajectory_stream,
+                    parameters_.system_parameters.particle_count,
+                    initial_condition_.bounding_box(),
+                    parameters_.trajectory_compression,
+                    std::move(existing_frames)
+                );
+            }
+            else
+            {
+                trajectory_sink.emplace(
+                    *trajectory_stream,
+                    parameters_.system_parameters.particle_count,
+                    parameters_.trajectory_format,
+                    std::move(existing_frames)
+                );
+            }
+        }
+
+        // Set up checkpoints, if requested
+        std::optional<output::CheckpointSink> checkpoint_sink;
+
+        if (!parameters_.checkpoint_path.empty())
+        {
+            checkpoint_sink.emplace(parameters_.checkpoint_path, log_paths, fingerprint());
+        }
+
         // Set up logger
-        output::Logger logger{output::Logger::Streams{
-            .event_log = event_stream,
-            .thermodynamic_log = thermodynamic_stream,
-            .observation_log = observation_stream,
-            .snapshot_log = snapshot_stream
-        }};
+        output::Logger logger{
+            output::Logger::Streams{
+                .event_log = event_stream,
+                .thermodynamic_log = *thermodynamic_stream,
+                .observation_log = *observation_stream,
+                .snapshot_log = *snapshot_stream,
+                .thermodynamic_log_format = in_memory
+                    ? output::LogFormat::binary
+                    : parameters_.thermodynamic_log_format,
+                .observation_log_format = in_memory
+                    ? output::LogFormat::binary
+                    : parameters_.observation_log_format,
+                .snapshot_log_format = in_memory
+                    ? output::LogFormat::binary
+                    : output::LogFormat::csv,
+                .thermodynamic_log_aggregated = thermodynamic_log_aggregated_()
+            },
+            std::move(checkpoint_sink),
+            resuming,
+            std::move(trajectory_sink),
+            io_service
+        };
         
-        // Create initial state and SimulationController
-        auto initial_state = initial_condition_.system_state();
-        auto simulation_controller = make_simulation_controller_(logger);
+        // Create initial state
+        auto state = resuming ? initial_condition_.system_state() : initial_state_();
+
+        // Set up the equilibrated-state cache, if requested
+        control::SimulationController::Parameters controller_parameters{
+            .checkpoint_interval = parameters_.checkpoint_interval,
+            .snapshot_interval = recording_trajectory ? parameters_.snapshot_interval : 0,
+            .progress = progress
+        };
+
+        if (progress) {progress->set_expected_time_steps(maximum_time_steps(parameters_));}
+
+        auto equilibration_phase_count = equilibration_phase_count_();
+        std::optional<StateCache> state_cache;
+        std::optional<physics::SystemState> cached_state;
+        std::string cache_key;
+
+        if (!parameters_.state_cache_path.empty() && equilibration_phase_count > 0)
+        {
+            state_cache.emplace(parameters_.state_cache_path, parameters_.state_cache_size);
+            cache_key = describe_(equilibration_phase_count, false);
+
+            if (!resuming) {cached_state = state_cache->load(cache_key);}
+
+            // Store the state once equilibration is over (unless it came from the cache)
+            if (!cached_state)
+            {
+                controller_parameters.phase_complete_callback =
+                    [&state_cache, &cache_key, equilibration_phase_count]
+                    (int phases_completed, const physics::SystemState& equilibrated_state)
+                    {
+                        if (static_cast<std::size_t>(phases_completed) == equilibration_phase_count)
+                        {
+                            state_cache->store(cache_key, equilibrated_state);
+                        }
+                    };
+            }
+        }
+
+        // Create SimulationController
+        auto simulation_controller = make_simulation_controller_(logger, controller_parameters);
+
+        if (cached_state)
+        {
+            state = std::move(*cached_state);
+            state | physics::clear_displacements;
+            state.time = 0.0;
+
+            simulation_controller.skip_phases(static_cast<int>(equilibration_phase_count));
+        }
 
         // Run the actual simulation
-        initial_state | simulation_controller;
+        if (resuming)
+        {
+            simulation_controller.resume(state, checkpoint->payload);
+        }
+        else
+        {
+            state | simulation_controller;
+        }
 
         // Close the logger
         logger.close();
 
-        // Close the streams (note that event_stream is a different type)
-        event_stream.reset();
-        thermodynamic_stream.close();
-        observation_stream.close();
-        snapshot_stream.close();
+        // Save the final state for warm starts, but only if it is an equilibrium state
+        if (!parameters_.final_state_path.empty() && !simulation_controller.aborted())
+        {
+            output::write_state_file(
+                parameters_.final_state_path,
+                {.system_parameters = parameters_.system_parameters, .system_state = state}
+            );
+        }
+
+        auto final_state = std::make_shared<const physics::SystemState>(std::move(state));
+
+        // Close the streams (note that the event stream is closed through its chain)
+        echo_chain.reset();
+        thermodynamic_stream.reset();
+        observation_stream.reset();
+        snapshot_stream.reset();
+        trajectory_stream.reset();
+
+        // Only now that nothing more will be written are the results made visible
+        std::lock_guard<std::mutex> lock(*results_mutex_);
+        if (in_memory) {memory_logs_ = std::move(memory_logs);}
+        final_state_ = std::move(final_state);
+    }
+
+    bool Simulation::async_files_() const
+    {
+        return parameters_.file_backend == output::FileBackend::async
+            || parameters_.file_backend == output::FileBackend::direct;
+    }
+
+    output::AsyncFileOptions Simulation::async_file_options_() const
+    {
+        return {.direct = parameters_.file_backend == output::FileBackend::direct};
+    }
+
+    std::unique_ptr<std::ostream> Simulation::open_log_(
+        const std::filesystem::path& path,
+        std::ios::openmode mode,
+        output::LogCompression compression
+    ) const
+    {
+        // Destroying the stream closes the file (and ends the compressed stream)
+        if (compression != output::LogCompression::none)
+        {
+            auto stream = std::make_unique<boost::iostreams::filtering_ostream>();
+            output::push_compressor(*stream, compression);
+
+            if (async_files_())
+            {
+                stream->push(output::AsyncFileSink{path, mode, async_file_options_()});
+            }
+            else
+            {
+                stream->push(boost::iostreams::file_sink{path, mode});
+            }
+
+            return stream;
+        }
+
+        if (async_files_())
+        {
+            return std::make_unique<boost::iostreams::stream<output::AsyncFileSink>>(
+                output::AsyncFileSink{path, mode, async_file_options_()}
+            );
+        }
+
+        return std::make_unique<boost::iostreams::stream<boost::iostreams::file_sink>>(
+            boost::iostreams::file_sink{path, mode}
+        );
+    }
+
+    output::LogCompression Simulation::log_compression_(output::LogFormat format) const
+    {
+        return (format == output::LogFormat::csv)
+            ? parameters_.log_compression
+            : output::LogCompression::none;
+    }
+
+    std::vector<std::filesystem::path> Simulation::log_paths_() const
+    {
+        std::vector<std::filesystem::path> log_paths{
+            parameters_.event_log_path,
+            parameters_.thermodynamic_log_path,
+            parameters_.observation_log_path,
+            parameters_.snapshot_log_path
+        };
+
+        if (!parameters_.trajectory_path.empty())
+        {
+            log_paths.push_back(parameters_.trajectory_path);
+        }
+
+        return log_paths;
+    }
+
+    Simulation::Parameters Simulation::replica_parameters_(int replica) const
+    {
+        auto replica_path = [replica](const std::filesystem::path& path)
+        {
+            if (path.empty()) {return path;}
+
+            return std::filesystem::path{path}.replace_filename(
+                fmt::format(
+                    "{}.replica{}{}", path.stem().string(), replica, path.extension().string()
+                )
+            );
+        };
+
+        auto parameters = parameters_;
+        parameters.replica_count = 1;
+        parameters.random_seed = SeedGenerator::replica_seed(parameters_.random_seed, replica);
+        parameters.observation_log_path = replica_path(parameters_.observation_log_path);
+        parameters.observation_log_format = output::LogFormat::csv;
+
+        if (replica > 0)
+        {
+            parameters.event_log_path = replica_path(parameters_.event_log_path);
+            parameters.thermodynamic_log_path = replica_path(parameters_.thermodynamic_log_path);
+            parameters.snapshot_log_path = replica_path(parameters_.snapshot_log_path);
+            parameters.checkpoint_path = replica_path(parameters_.checkpoint_path);
+            parameters.trajectory_path = replica_path(parameters_.trajectory_path);
+
+            // A warm start would make the replicas start out identical, so only replica 0 uses
+            // one (and only replica 0 saves its final state for the next simulation)
+            parameters.initial_state_path.clear();
+            parameters.initial_state = nullptr;
+            parameters.final_state_path.clear();
+        }
+
+        return parameters;
     }
 
-    control::SimulationController Simulation::make_simulation_controller_(output::Logger& logger)
+    void Simulation::run_replicas_(
+        echo_chain_type echo_chain,
+        bool resuming,
+        output::IOService* io_service,
+        int thread_count,
+        control::Progress* progress
+    )
+    {
+        auto replica_count = static_cast<std::size_t>(parameters_.replica_count);
+
+        if (thread_count <= 0) {thread_count = requested_thread_count();}
+        auto team_size = std::min(static_cast<std::size_t>(thread_count), replica_count);
+
+        std::vector<Simulation> replicas;
+        replicas.reserve(replica_count);
+
+        for (std::size_t i = 0; i < replica_count; ++i)
+        {
+            replicas.emplace_back(replica_parameters_(static_cast<int>(i)));
+        }
+
+        // Replica 0 runs in this thread, with the echo chain and the Progress record; the rest
+        // are taken in turn by whichever thread of the team is free.  Exceptions are passed back
+        // to this thread once all replicas have finished.
+        std::vector<std::exception_ptr> errors(replica_count);
+
+        auto run_replica = [&](std::size_t i, echo_chain_type echo)
+        {
+            auto replica_progress = (i == 0) ? progress : nullptr;
+
+            try
+            {
+                if (resuming)
+                {
+                    replicas[i].resume(std::move(echo), io_service, 1, replica_progress);
+                }
+                else
+                {
+                    replicas[i].run(std::move(echo), io_service, 1, replica_progress);
+                }
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        std::atomic<std::size_t> next_replica{1};
+
+        auto run_remaining_replicas = [&run_replica, &next_replica, replica_count]()
+        {
+            for (auto i = next_replica++; i < replica_count; i = next_replica++)
+            {
+                run_replica(i, Echo::Silent());
+            }
+        };
+
+        {
+            std::vector<std::jthread> threads;
+            threads.reserve(team_size - 1);
+
+            for (std::size_t i = 1; i < team_size; ++i)
+            {
+                threads.emplace_back(run_remaining_replicas);
+            }
+
+            run_replica(0, std::move(echo_chain));
+            run_remaining_replicas();
+        }
+
+        for (auto& error : errors)
+        {
+            if (error) {std::rethrow_exception(error);}
+        }
+
+        // Combine the observations.  A replica which aborted may have fewer of them, so each row
+        // combines only the replicas which got that far.
+        std::vector<std::vector<output::ObservationRecord>> replica_logs;
+
+        for (const auto& replica : replicas)
+        {
+            replica_logs.push_back(
+                output::read_observation_log(replica.parameters_.observation_log_path)
+            );
+        }
+
+        auto observation_stream = open_log_(
+            parameters_.observation_log_path,
+            std::ios::out | std::ios::binary,
+            log_compression_(output::LogFormat::csv)
+        );
+        output::ReplicaObservationSink observation_sink{*observation_stream};
+        observation_sink.write_header();
+
+        for (std::size_t row = 0; ; ++row)
+        {
+            std::vector<physics::Observation> observations;
+            int time_step = 0;
+
+            for (const auto& log : replica_logs)
+            {
+                if (row >= log.size()) {continue;}
+
+                observations.push_back(log[row].observation.data);
+                time_step = std::max(time_step, log[row].time_step);
+            }
+
+            if (observations.empty()) {break;}
+
+            observation_sink.write(
+                time_step,
+                output::ReplicaObservationData{physics::combine_observations(observations)}
+            );
+        }
+
+        observation_sink.flush();
+        observation_stream.reset();
+
+        std::lock_guard<std::mutex> lock(*results_mutex_);
+        final_state_ = replicas.front().final_state();
+    }
+
+    std::size_t Simulation::equilibration_phase_count_() const
+    {
+        auto first_observation = std::ranges::find_if(
+            parameters_.schedule_parameters,
+            [](const auto& phase)
+            {
+                return std::holds_alternative<control::ObservationPhase::Parameters>(phase.second);
+            }
+        );
+
+        // Without an observation phase, there is nothing to skip to
+        if (first_observation == parameters_.schedule_parameters.end()) {return 0;}
+
+        return first_observation - parameters_.schedule_parameters.begin();
+    }
+
+    control::SimulationController Simulation::make_simulation_controller_(
+        output::Logger& logger, control::SimulationController::Parameters controller_parameters
+    )
     {
         // First build the integrator
         auto integrator = engine::Integrator::Builder(parameters_.time_delta)
@@ -129,6 +881,16 @@ namespace api
 
         for (auto [name, phase_parameters] : parameters_.schedule_parameters)
         {
+            if (auto min_phase_parameters =
+                std::get_if<control::MinimizationPhase::Parameters>(&phase_parameters))
+            {
+                schedule.push(
+                    std::make_unique<control::MinimizationPhase>(
+                        name, parameters_.system_parameters, *min_phase_parameters
+                    )
+                );
+            }
+
             if (auto eq_phase_parameters =
                 std::get_if<control::EquilibrationPhase::Parameters>(&phase_parameters))
             {
@@ -151,6 +913,11 @@ namespace api
         }
 
         // Finally return the SimulationController
-        return {std::move(integrator), std::move(schedule), logger};
+        return {
+            std::move(integrator),
+            std::move(schedule),
+            logger,
+            std::move(controller_parameters)
+        };
     }
 } // namespace api
@@ -23,12 +23,16 @@
 #ifndef LJ_SIMULATION_HPP
 #define LJ_SIMULATION_HPP
 
+#include <csignal>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <variant>
 #include <random>
 #include <vector>
 #include <string>
 #include <utility>
+#include <optional>
 #include <filesystem>
 #include <iostream>
 
@@ -37,12 +41,21 @@
 
 #include <lennardjonesium/tools/system_parameters.hpp>
 #include <lennardjonesium/tools/cubic_lattice.hpp>
+#include <lennardjonesium/physics/system_state.hpp>
 #include <lennardjonesium/physics/forces.hpp>
 #include <lennardjonesium/physics/lennard_jones_force.hpp>
 #include <lennardjonesium/engine/initial_condition.hpp>
+#include <lennardjonesium/output/sinks.hpp>
 #include <lennardjonesium/output/logger.hpp>
+#include <lennardjonesium/output/io_service.hpp>
+#include <lennardjonesium/output/async_file.hpp>
+#include <lennardjonesium/output/log_compression.hpp>
+#include <lennardjonesium/output/memory_logs.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
 #include <lennardjonesium/control/simulation_phase.hpp>
 #include <lennardjonesium/control/simulation_controller.hpp>
+#include <lennardjonesium/control/progress.hpp>
 
 namespace api
 {
@@ -57,14 +70,48 @@ namespace api
          *                      Logger launches a consumer thread for logging, but it should not be
          *                      too active as it is for file IO only.
          * 
+         *      resume():       Continues the simulation from its checkpoint file, if there is a
+         *                      valid one; otherwise the same as run().  The log files are cut
+         *                      back to where they were when the checkpoint was taken, and then
+         *                      appended to, so the output is identical to an uninterrupted run.
+         * 
+         *  Checkpoints:
+         *      checkpoint_on_signal(): Installs a signal handler (SIGUSR1 by default) which asks
+         *                      all running simulations to write a checkpoint.
+         * 
          *  Information:
          *      parameters():   Get the parameters used to define the simulation
+         *      fingerprint():  A canonical description of the parameters which determine the
+         *                      physics (i.e., everything except the file paths)
+         *      memory_logs():  The logs of the last run, if they were kept in memory (see below)
+         *      final_state():  The SystemState at the end of the last run (of replica 0, if there
+         *                      are replicas), or nullptr before the first run
          * 
          *  Used for making plots:
          *      potential():    Evaluate the potential for a given separation distance
          *      virial():       Evaluate the virial for a given separation distance
          *      force():        Evaluate the force for a given separation distance
          * 
+         * Replicas:
+         *      If replica_count is greater than 1, run() and resume() run that many independent
+         *      copies of the simulation concurrently, with seeds derived from random_seed (see
+         *      SeedGenerator::replica_seed()).  Each replica equilibrates on its own and writes
+         *      its own log files, named like observations.replica2.csv.  The replicas are run by a
+         *      team of thread_count threads (by default, one per replica), each of which takes the
+         *      next replica as it finishes one.  The observation log
+         *      combines the replicas' Observations, with standard errors (see
+         *      physics::combine_observations()); the replica and combined observation logs are
+         *      always CSV.  Replica 0 writes to the main event, thermodynamic,
+         *      and snapshot logs, takes the echo chain, and is the one which uses and saves warm
+         *      start states.
+         * 
+         * In-memory logs:
+         *      With FileBackend::memory, the event, thermodynamic, observation, and snapshot logs
+         *      are not written to files, but kept in memory (see output::MemoryLogs), and their
+         *      paths and formats are ignored.  Each run starts new buffers.  The trajectory and
+         *      state files are still written if their paths are given.  Since there are no log
+         *      files to cut back or to combine, this cannot be used with checkpoints or replicas.
+         * 
          * NOTE: Whenever the simulation is re-run, the files it generated will be overwritten.
          */
 
@@ -73,6 +120,7 @@ namespace api
         >;
 
         using simulation_phase_parameter_type = std::variant<
+            control::MinimizationPhase::Parameters,
             control::EquilibrationPhase::Parameters,
             control::ObservationPhase::Parameters
         >;
@@ -115,6 +163,59 @@ namespace api
                 std::filesystem::path thermodynamic_log_path = "thermodynamics.csv";
                 std::filesystem::path observation_log_path = "observations.csv";
                 std::filesystem::path snapshot_log_path = "snapshots.csv";
+
+                // The thermodynamic and observation logs can also be written in a binary columnar
+                // format (see output::ColumnarWriter), which is much faster to write and to load
+                output::LogFormat thermodynamic_log_format = output::LogFormat::csv;
+                output::LogFormat observation_log_format = output::LogFormat::csv;
+
+                // The log files can also be written asynchronously in large blocks (see
+                // output::AsyncFileSink), optionally bypassing the page cache, or kept in memory
+                output::FileBackend file_backend = output::FileBackend::standard;
+
+                // The text logs (thermodynamics, observations and snapshots) can be compressed as
+                // they are written (see output::LogCompression).  Binary columnar logs are never
+                // compressed, so that they can still be mapped into memory.
+                output::LogCompression log_compression = output::LogCompression::none;
+
+                // The trajectory is recorded only if a path is given, with a frame every
+                // snapshot_interval time steps (see output::TrajectorySink for the format)
+                std::filesystem::path trajectory_path = "";
+                int snapshot_interval = 0;
+                output::TrajectoryFormat trajectory_format = output::TrajectoryFormat::float64;
+                output::TrajectoryCompression trajectory_compression = {};  // If compressed
+
+                // Checkpoints are written only if a path is given.  A checkpoint_interval of 0
+                // means that checkpoints are written only on request (e.g. on a signal).
+                std::filesystem::path checkpoint_path = "";
+                int checkpoint_interval = 0;
+
+                // Warm starts: if initial_state_path names a state file (written by a simulation
+                // of the same particle count), the run starts from that state, rescaled to this
+                // temperature and density, instead of from the lattice.  A missing file is not an
+                // error, so that a chain of simulations degrades gracefully if one of them fails.
+                // If final_state_path is given, the final state of a completed run is saved there.
+                std::filesystem::path initial_state_path = "";
+                std::filesystem::path final_state_path = "";
+
+                // The initial state can also be given directly (e.g. from Python), which takes
+                // precedence over initial_state_path.  Its velocities are rescaled to this
+                // temperature; if they are all zero, they are chosen as for the lattice instead.
+                std::shared_ptr<const physics::SystemState> initial_state = nullptr;
+
+                // Equilibrated-state cache: if a directory is given, the state at the end of the
+                // phases before the first ObservationPhase is stored there, and a later simulation
+                // with the same parameters skips those phases and starts from the stored state.
+                // Least recently used entries are evicted to keep the cache below the given size.
+                std::filesystem::path state_cache_path = "";
+                std::uintmax_t state_cache_size = std::uintmax_t{1} << 30;
+
+                // Number of independent replicas to run and combine (see above)
+                int replica_count = 1;
+
+                // Number of threads to run the replicas on (0 means one per replica).  This is the
+                // number of cores the simulation asks for in a SimulationPool.
+                int thread_count = 0;
             };
 
             explicit Simulation(Parameters parameters);
@@ -140,10 +241,58 @@ namespace api
                 Echo() = delete;
             };
 
-            void run(echo_chain_type = Echo::Silent());
+            // If an IOService is given, the log files are written by its threads (see
+            // output::IOService), rather than by a thread belonging to this Simulation.  If a
+            // thread_count is given, it overrides the one in the Parameters.  If a Progress record
+            // is given, the progress of the run (of replica 0, if there are replicas) is written
+            // to it.  Throws std::filesystem::filesystem_error if the directory of a log file
+            // does not exist.
+            void run(
+                echo_chain_type = Echo::Silent(),
+                output::IOService* io_service = nullptr,
+                int thread_count = 0,
+                control::Progress* progress = nullptr
+            );
+
+            void resume(
+                echo_chain_type = Echo::Silent(),
+                output::IOService* io_service = nullptr,
+                int thread_count = 0,
+                control::Progress* progress = nullptr
+            );
+
+            // The number of threads the simulation can make use of, given its Parameters
+            int requested_thread_count() const;
+
+            // The largest number of time steps the schedule allows (the timeouts of the
+            // Minimization and Equilibration Phases, and the full length of the Observation Phases)
+            static int maximum_time_steps(const Parameters&);
+
+            static void checkpoint_on_signal(int signal_number = SIGUSR1);
 
             Parameters parameters() {return parameters_;}
 
+            std::string fingerprint() const;
+
+            // The buffers are shared, so they can be kept after the next run has started.  They
+            // are only published once a run has finished, so these may be called (e.g. from
+            // Python) while a run is in progress, and return the results of the run before.
+            output::MemoryLogs memory_logs() const
+            {
+                std::lock_guard<std::mutex> lock(*results_mutex_);
+                return memory_logs_;
+            }
+
+            // Shared for the same reason; it is never modified once the run is over
+            std::shared_ptr<const physics::SystemState> final_state() const
+            {
+                std::lock_guard<std::mutex> lock(*results_mutex_);
+                return final_state_;
+            }
+
+            // Replace Parameters::initial_state, for the runs which follow
+            void set_initial_state(std::shared_ptr<const physics::SystemState>);
+
             // Evaluate the basic functions that describe the force.  Useful for plotting.
             double potential(double distance) {return short_range_force_->potential(distance);}
             double virial(double distance) {return short_range_force_->virial(distance);}
@@ -157,8 +306,65 @@ namespace api
             // other ShortRangeForces in the future
             std::unique_ptr<const physics::ShortRangeForce> short_range_force_;
 
+            // The logs of the last run, with FileBackend::memory, and its final state.  These are
+            // replaced under the mutex (held by pointer, so the Simulation can still be moved).
+            output::MemoryLogs memory_logs_;
+            std::shared_ptr<const physics::SystemState> final_state_;
+            std::unique_ptr<std::mutex> results_mutex_ = std::make_unique<std::mutex>();
+
             // Construct the SimulationController from the local parameters and a Logger
-            control::SimulationController make_simulation_controller_(output::Logger&);
+            control::SimulationController make_simulation_controller_(
+                output::Logger&, control::SimulationController::Parameters
+            );
+
+            // Canonical description of the system and of the first phase_count phases
+            std::string describe_(std::size_t phase_count, bool with_names) const;
+
+            // Number of phases which come before the first ObservationPhase
+            std::size_t equilibration_phase_count_() const;
+
+            // Whether any phase logs blocks of time steps, so that the thermodynamic log needs
+            // the aggregated layout
+            bool thermodynamic_log_aggregated_() const;
+
+            // The lattice state, or the warm start state if one is available
+            physics::SystemState initial_state_();
+
+            // Open a log file with the chosen FileBackend, compressing it if requested.  Files
+            // which are written even with FileBackend::memory use the standard backend.
+            bool async_files_() const;
+            output::AsyncFileOptions async_file_options_() const;
+            std::unique_ptr<std::ostream> open_log_(
+                const std::filesystem::path& path,
+                std::ios::openmode mode,
+                output::LogCompression compression = output::LogCompression::none
+            ) const;
+
+            // The compression of a text log with the given format
+            output::LogCompression log_compression_(output::LogFormat format) const;
+
+            // The log files which are cut back when resuming from a checkpoint
+            std::vector<std::filesystem::path> log_paths_() const;
+
+            // Shared implementation of run() and resume()
+            void run_(
+                echo_chain_type,
+                std::optional<output::Checkpoint>,
+                output::IOService*,
+                control::Progress*
+            );
+
+            // The parameters of a single replica, with its own seed and file paths
+            Parameters replica_parameters_(int replica) const;
+
+            // Run all replicas on a team of threads and combine their observations
+            void run_replicas_(
+                echo_chain_type,
+                bool resuming,
+                output::IOService*,
+                int thread_count,
+                control::Progress*
+            );
     };
 } // namespace api
 
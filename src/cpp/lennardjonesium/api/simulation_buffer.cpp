@@ -20,9 +20,11 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <exception>
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
 
 #include <boost/iostreams/chain.hpp>
 
@@ -43,13 +45,22 @@ namespace api
         // Start the simulation job
         simulation_job_ = std::jthread(
             // Copy the buffer pointer to share ownership
-            [buffer=buffer_, &simulation]() mutable {
+            [buffer=buffer_, &simulation, &error=error_]() mutable {
                 // Create the echo chain
                 Simulation::echo_chain_type echo_chain{};
                 echo_chain.push(tools::TextBufferFilter(*buffer));
 
-                // Run the simulation
-                simulation.run(echo_chain);
+                // Run the simulation.  If it throws, the chain is not closed, so close the buffer
+                // here to let the reader finish.
+                try
+                {
+                    simulation.run(echo_chain);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                    buffer->close();
+                }
 
                 // Free our copy of the shared buffer (should happen automatically)
                 buffer.reset();
@@ -64,6 +75,8 @@ namespace api
         {
             simulation_job_.join();
         }
+
+        if (error_) {std::rethrow_exception(std::exchange(error_, nullptr));}
     }
 
     std::string SimulationBuffer::read()
@@ -23,6 +23,7 @@
 #ifndef LJ_SIMULATION_BUFFER_HPP
 #define LJ_SIMULATION_BUFFER_HPP
 
+#include <exception>
 #include <memory>
 #include <string>
 #include <thread>
@@ -43,6 +44,9 @@ namespace api
          * in a separate thread without this lock).  So, by putting the Events messages in a buffer
          * and allowing Python to explicitly call read(), then Python itself can manage synchronous
          * printing via its own print() function.
+         * 
+         * If the Simulation throws, the output ends there, and the exception is rethrown by
+         * wait() (rather than escaping from the thread and terminating the program).
          */
 
         public:
@@ -55,6 +59,7 @@ namespace api
         private:
             std::shared_ptr<tools::TextBuffer> buffer_;
             std::jthread simulation_job_;
+            std::exception_ptr error_;
     };
 } // namespace api
 
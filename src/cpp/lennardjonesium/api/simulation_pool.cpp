@@ -20,56 +20,328 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
+#include <chrono>
+#include <optional>
 #include <algorithm>
 #include <ranges>
+#include <stdexcept>
 
-#include <lennardjonesium/tools/message_buffer.hpp>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include <lennardjonesium/tools/cpu_topology.hpp>
+#include <lennardjonesium/output/io_service.hpp>
 #include <lennardjonesium/api/simulation.hpp>
+#include <lennardjonesium/api/cost_model.hpp>
 #include <lennardjonesium/api/simulation_pool.hpp>
 
 namespace api
 {
-    SimulationPool::SimulationPool(int thread_count)
+    namespace
+    {
+        // The CPUs of every NUMA node, for pinning the log writer threads
+        std::vector<std::vector<int>> node_cpu_sets(
+            const tools::CpuTopology& topology, SimulationPool::Affinity affinity
+        )
+        {
+            std::vector<std::vector<int>> cpu_sets;
+
+            if (affinity == SimulationPool::Affinity::none) {return cpu_sets;}
+
+            for (auto node : std::views::iota(0, topology.node_count()))
+            {
+                cpu_sets.push_back(topology.node(node));
+            }
+
+            return cpu_sets;
+        }
+    }
+
+    SimulationPool::SimulationPool(int thread_count, int io_thread_count, Affinity affinity)
+        : topology_{tools::CpuTopology::detect()},
+          io_service_{io_thread_count, node_cpu_sets(topology_, affinity)},
+          core_count_{std::max(thread_count, 1)}
     {
+#ifdef __linux__
+        completion_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+        auto spread_order = topology_.spread_order();
+
+        if (affinity != Affinity::none)
+        {
+            node_jobs_.resize(static_cast<std::size_t>(topology_.node_count()));
+            node_idle_workers_.resize(static_cast<std::size_t>(topology_.node_count()));
+        }
+
         // Populate the thread pool
-        for (auto i [[maybe_unused]] : std::views::iota(0, thread_count))
+        for (auto i : std::views::iota(0, thread_count))
         {
-            threads_.emplace_back(Worker(*this));
+            auto& slot = *slots_.emplace_back(std::make_unique<Slot>());
+            std::vector<int> cpus, node_cpus;
+            int node = -1;
+
+            if (affinity == Affinity::node && topology_.node_count() > 0)
+            {
+                node = i % topology_.node_count();
+                cpus = topology_.node(node);
+            }
+            else if (affinity == Affinity::core && !spread_order.empty())
+            {
+                int cpu = spread_order[static_cast<std::size_t>(i) % spread_order.size()];
+                cpus = {cpu};
+
+                for (auto candidate : std::views::iota(0, topology_.node_count()))
+                {
+                    const auto& candidate_cpus = topology_.node(candidate);
+
+                    if (std::ranges::find(candidate_cpus, cpu) != candidate_cpus.end())
+                    {
+                        node = candidate;
+                        node_cpus = candidate_cpus;
+                    }
+                }
+            }
+
+            threads_.emplace_back(
+                Worker(*this, slot, std::move(cpus), std::move(node_cpus), node)
+            );
         }
     }
 
-    SimulationPool::Status SimulationPool::status()
+    SimulationPool::Affinity SimulationPool::parse_affinity(const std::string& affinity)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        if (affinity == "none") {return Affinity::none;}
+        if (affinity == "node") {return Affinity::node;}
+        if (affinity == "core") {return Affinity::core;}
+
+        throw std::invalid_argument("Unknown affinity: " + affinity);
+    }
+
+    void SimulationPool::push_chain(Chain chain, CompletionHandler on_completion)
+    {
+        Job job{
+            .chain = std::move(chain), .on_completion = std::move(on_completion), .features = {}
+        };
+
+        for (Simulation& simulation : job.chain)
+        {
+            int requested_cores = simulation.requested_thread_count();
+
+            job.features.push_back(CostModel::features(simulation.parameters()));
+            job.requested_cores = std::max(job.requested_cores, requested_cores);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // As with a closed MessageBuffer, jobs pushed after close() are dropped
+            if (closed_) {return;}
+
+            job.first_id = queued_.fetch_add(
+                static_cast<int>(job.chain.size()), std::memory_order_release
+            );
+            waiting_.push_back(std::move(job));
+        }
+
+        // When the workers are placed on nodes, the one that should take the job may not be the
+        // one that would be woken, so wake them all and let them sort it out
+        if (node_jobs_.empty()) {job_signal_.notify_one();}
+        else {job_signal_.notify_all();}
+    }
+
+    void SimulationPool::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+
+        job_signal_.notify_all();
+    }
+
+    bool SimulationPool::defers_to_other_node_(int node) const
+    {
+        if (node < 0 || node_jobs_.empty()) {return false;}
+
+        auto node_index = static_cast<std::size_t>(node);
+
+        for (auto other : std::views::iota(std::size_t{0}, node_jobs_.size()))
+        {
+            if (node_idle_workers_[other] > 0 && node_jobs_[other] < node_jobs_[node_index])
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::optional<SimulationPool::Job> SimulationPool::next_job_(int node)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        bool counted = (node >= 0 && !node_idle_workers_.empty());
+        if (counted) {++node_idle_workers_[static_cast<std::size_t>(node)];}
+
+        job_signal_.wait(
+            lock,
+            [this, node]()
+            {
+                return (
+                    !waiting_.empty()
+                    && cores_in_use_.load() < core_count_
+                    && !defers_to_other_node_(node)
+                ) || (waiting_.empty() && closed_);
+            }
+        );
+
+        if (counted) {--node_idle_workers_[static_cast<std::size_t>(node)];}
+
+        if (waiting_.empty()) {return {};}
+
+        // The estimates are recomputed each time, since the CostModel learns as jobs finish
+        auto total_cost = [this](const Job& job)
+        {
+            CostModel::Features total{};
+            for (const auto& features : job.features) {total += features;}
+            return cost_model_.estimate(total);
+        };
+
+        // max_element returns the first of equal elements, so ties go to the earliest pushed
+        auto longest = std::ranges::max_element(
+            waiting_, [&](const Job& a, const Job& b) {return total_cost(a) < total_cost(b);}
+        );
+
+        Job job = std::move(*longest);
+        waiting_.erase(longest);
+
+        // A large job takes what is free, rather than holding up the pool until enough is
+        int cores_in_use = cores_in_use_.load(std::memory_order_relaxed);
+        job.granted_cores = std::min(job.requested_cores, core_count_ - cores_in_use);
+        cores_in_use_.store(cores_in_use + job.granted_cores, std::memory_order_relaxed);
+
+        if (counted)
+        {
+            ++node_jobs_[static_cast<std::size_t>(node)];
+
+            // Workers which deferred to this one may now be next in line
+            if (!waiting_.empty()) {job_signal_.notify_all();}
+        }
+
+        return job;
+    }
+
+    SimulationPool::Status SimulationPool::status() const
+    {
+        // Each counter is incremented (with release) only after the one before it in the chain
+        // queued -> started -> completed, so loading them (with acquire) in the opposite order
+        // gives queued >= started >= completed
+        int completed = completed_.load(std::memory_order_acquire);
+        int started = started_.load(std::memory_order_acquire);
+        int queued = queued_.load(std::memory_order_acquire);
+
+        auto first_start = first_start_time_.load(std::memory_order_relaxed);
+        auto last_completion = last_completion_time_.load(std::memory_order_relaxed);
+
+        std::chrono::duration<double> makespan{0};
+
+        if (first_start != no_time && last_completion != no_time)
+        {
+            makespan = clock::duration{last_completion} - clock::duration{first_start};
+        }
 
         return SimulationPool::Status{
-            .queued = queued_,
-            .waiting = queued_ - started_,
-            .started = started_,
-            .running = started_ - completed_,
-            .completed = completed_
+            .queued = queued,
+            .waiting = queued - started,
+            .started = started,
+            .running = started - completed,
+            .completed = completed,
+            .makespan = makespan.count(),
+            .cores_in_use = cores_in_use_.load(std::memory_order_relaxed)
         };
     }
 
-    void SimulationPool::increment_queued_()
+    std::vector<SimulationPool::JobProgress> SimulationPool::progress() const
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        ++queued_;
+        std::vector<JobProgress> progress;
+
+        for (const auto& slot : slots_)
+        {
+            int job = slot->job.load(std::memory_order_relaxed);
+
+            if (job >= 0)
+            {
+                progress.push_back({.job = job, .report = slot->progress.report()});
+            }
+        }
+
+        return progress;
     }
 
-    void SimulationPool::increment_started_()
+    void SimulationPool::start_(clock::time_point start_time)
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-        ++started_;
+        started_.fetch_add(1, std::memory_order_release);
+
+        auto expected = no_time;
+        first_start_time_.compare_exchange_strong(
+            expected, start_time.time_since_epoch().count(), std::memory_order_relaxed
+        );
     }
 
-    void SimulationPool::increment_completed_()
+    void SimulationPool::complete_(
+        const CostModel::Features& features,
+        clock::time_point start_time,
+        clock::time_point completion_time,
+        int cores,
+        bool succeeded
+    )
     {
+        auto completion = completion_time.time_since_epoch().count();
+        auto last_completion = last_completion_time_.load(std::memory_order_relaxed);
+
+        while (
+            (last_completion == no_time || last_completion < completion)
+            && !last_completion_time_.compare_exchange_weak(
+                last_completion, completion, std::memory_order_relaxed
+            )
+        ) {}
+
+        completed_.fetch_add(1, std::memory_order_release);
+        signal_completion_();
+
+        // A simulation which threw stopped partway through, so its running time says nothing
+        // about the cost of a whole run
+        if (!succeeded) {return;}
+
+        // The CostModel estimates the total work, so a job on several cores is counted in
+        // core-seconds
+        std::chrono::duration<double> running_time = completion_time - start_time;
+
         std::lock_guard<std::mutex> lock(mutex_);
-        ++completed_;
+        cost_model_.observe(features, cores * running_time.count());
+    }
+
+    void SimulationPool::release_cores_(int cores, int node)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cores_in_use_.fetch_sub(cores, std::memory_order_relaxed);
+            if (node >= 0 && !node_jobs_.empty()) {--node_jobs_[static_cast<std::size_t>(node)];}
+        }
+
+        job_signal_.notify_all();
     }
 
     void SimulationPool::wait()
@@ -88,15 +360,70 @@ namespace api
         // Wait for any running simulations to finish
         try {wait();}
         catch (...) {}
+
+#ifdef __linux__
+        if (completion_fd_ >= 0) {::close(completion_fd_);}
+#endif
+    }
+
+    void SimulationPool::signal_completion_()
+    {
+#ifdef __linux__
+        if (completion_fd_ < 0) {return;}
+
+        // The eventfd adds up the signals until they are read, so none can be lost (and the write
+        // can only fail if the counter would overflow, in which case the fd is readable anyway)
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(completion_fd_, &one, sizeof(one));
+#endif
     }
 
     void SimulationPool::Worker::operator() ()
     {
-        while (auto job = pool_.jobs_.get())
+        if (!cpus_.empty()) {tools::pin_this_thread(cpus_);}
+
+        while (auto job = pool_.next_job_(node_))
         {
-            pool_.increment_started_();
-            job.value().get().run();
-            pool_.increment_completed_();
+            // A team of threads inherits the affinity of this thread, so it needs room
+            bool widened = (job->granted_cores > 1 && !node_cpus_.empty());
+            if (widened) {tools::pin_this_thread(node_cpus_);}
+
+            std::exception_ptr error;
+
+            for (auto i : std::views::iota(std::size_t{0}, job->chain.size()))
+            {
+                Simulation& simulation = job->chain[i];
+                int cores = std::min(job->granted_cores, simulation.requested_thread_count());
+
+                auto start_time = clock::now();
+                pool_.start_(start_time);
+                slot_.job.store(job->first_id + static_cast<int>(i), std::memory_order_relaxed);
+
+                bool succeeded = true;
+
+                try
+                {
+                    simulation.run(
+                        Simulation::Echo::Silent(), &pool_.io_service_, cores, &slot_.progress
+                    );
+                }
+                catch (...)
+                {
+                    // Without a handler, there is nobody to report the error to
+                    if (!job->on_completion) {throw;}
+                    if (!error) {error = std::current_exception();}
+                    succeeded = false;
+                }
+
+                slot_.job.store(-1, std::memory_order_relaxed);
+                pool_.complete_(job->features[i], start_time, clock::now(), cores, succeeded);
+            }
+
+            if (job->on_completion) {job->on_completion(error);}
+
+            pool_.release_cores_(job->granted_cores, node_);
+
+            if (widened) {tools::pin_this_thread(cpus_);}
         }
     }
 } // namespace api
@@ -23,13 +23,24 @@
 #ifndef LJ_SIMULATION_POOL_HPP
 #define LJ_SIMULATION_POOL_HPP
 
+#include <string>
 #include <vector>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
+#include <chrono>
+#include <optional>
 #include <functional>
+#include <utility>
+#include <exception>
 
-#include <lennardjonesium/tools/message_buffer.hpp>
+#include <lennardjonesium/tools/cpu_topology.hpp>
+#include <lennardjonesium/output/io_service.hpp>
+#include <lennardjonesium/control/progress.hpp>
 #include <lennardjonesium/api/simulation.hpp>
+#include <lennardjonesium/api/cost_model.hpp>
 
 namespace api
 {
@@ -39,21 +50,82 @@ namespace api
          * SimulationPool is a thread pool for running batches of simulations in parallel.  The
          * simulation jobs themselves are run without printing anything to stdout.  One should also
          * take care that the simulation jobs are given different filepaths for the output files.
+         * 
+         * Simulations which depend on each other (e.g., a warm-started simulation which starts
+         * from the final state of another) can be pushed together as a chain.  A chain is run in
+         * order by a single worker, while separate chains run in parallel.  The Status counts
+         * individual simulations, not chains.
+         * 
+         * Waiting jobs are not started in the order they were pushed, but longest first, as
+         * estimated by a CostModel (chains by their total cost, with ties going to the earliest
+         * pushed).  The CostModel is refitted to the running times of the simulations which run to
+         * completion (not those which throw partway through).  This way a sweep over very
+         * different state points does not end with a single large job running while the other
+         * workers sit idle.  The makespan (the time from the start of the first job to the end of
+         * the last one so far) is reported in the Status.
+         * 
+         * The thread_count of the pool is a budget of cores.  Each job asks for as many cores as
+         * it can use (see Simulation::requested_thread_count(); a simulation with replicas can use
+         * one per replica), and is granted as many as are free, up to that number.  Its
+         * simulations are then run on a team of threads of the granted size.  A job is only
+         * started while some cores are free, so a few large jobs can take many cores each while
+         * small jobs take one, without the pool ever using more than its budget.  The cores in
+         * use are reported in the Status.
+         * 
+         * The worker threads can be pinned to the CPUs of the machine (see Affinity), using the
+         * tools::CpuTopology.  By default, each worker is pinned to a NUMA node, going around the
+         * nodes in turn, and a waiting job is taken by an idle worker on the node which is running
+         * the fewest jobs, so that the jobs are spread evenly across the sockets and do not wander
+         * between them.  The SystemState and the rest of a simulation's working memory are
+         * allocated by the worker which runs it, so (by the kernel's first-touch policy) they end
+         * up on the worker's own node.  The log writer threads are spread over the nodes in the
+         * same way.
+         * 
+         * The Status counters are atomics, and each worker records the progress of the job it is
+         * running in a control::Progress (time step, phases completed, throughput and ETA), so
+         * both can be polled from another thread without taking any locks.  Rather than polling,
+         * an event loop can also wait on completion_fd(), which is signaled as each job completes.
+         * 
+         * A chain can also be pushed with a CompletionHandler, which the worker calls when the
+         * whole chain has finished.  Exceptions thrown by the simulations of such a chain are
+         * passed to the handler (the rest of the chain still runs), rather than escaping from the
+         * worker and terminating the program.
+         * 
+         * The log files of all the simulations are written by a shared output::IOService, with
+         * a few writer threads (by default, one for every 8 hardware threads), rather than by a
+         * separate logging thread for each simulation.
          */
 
         public:
+            using Chain = std::vector<std::reference_wrapper<Simulation>>;
+
+            // Called by the worker once a chain has finished, with the first exception thrown by
+            // any of its simulations (or nullptr).  It must not throw.
+            using CompletionHandler = std::function<void(std::exception_ptr)>;
+
+            // How the worker threads are placed:
+            //  none:   not pinned at all
+            //  node:   each worker pinned to all the CPUs of one NUMA node, in turn
+            //  core:   each worker pinned to a single CPU, alternating between the nodes; a
+            //          worker running a job which was granted several cores is widened to its
+            //          node for the duration of the job
+            enum class Affinity {none, node, core};
+
+            // Parse "none", "node" or "core"; throws std::invalid_argument otherwise
+            static Affinity parse_affinity(const std::string&);
+
             // Add a simulation job to the queue
-            void push(Simulation& simulation)
+            void push(Simulation& simulation, CompletionHandler on_completion = {})
             {
-                // Need to increment the count first, or else it's possible that started_ could be
-                // incremented before queued_
-                increment_queued_();
-                jobs_.put(simulation);
+                push_chain({simulation}, std::move(on_completion));
             }
 
+            // Add a chain of simulation jobs to the queue, to be run one after another
+            void push_chain(Chain chain, CompletionHandler on_completion = {});
+
             // Indicate we are done pushing jobs to the queue (will shut down the workers after they
             // finish their current jobs).
-            void close() {jobs_.close();}
+            void close();
 
             // Wait for all jobs to finish
             void wait();
@@ -66,46 +138,155 @@ namespace api
                 int started;    // Total number of jobs which have been started since initialization
                 int running;    // Number of jobs currently running
                 int completed;  // Number of jobs completed
+                double makespan;    // Seconds from the first start to the latest completion
+                int cores_in_use;   // Number of cores granted to the running jobs
             };
 
-            // Get the current Status
-            Status status();
+            // Get the current Status.  This does not lock, so it can be polled as often as needed
+            // without holding up the workers.
+            Status status() const;
 
-            // We initialize the SimulationPool with the number of threads to use
-            explicit SimulationPool(int thread_count = 4);
+            // The progress of each running simulation, identified by its position in the order
+            // in which simulations were pushed (counting each simulation of a chain).  This does
+            // not lock either; see control::Progress.
+            struct JobProgress
+            {
+                int job;
+                control::Progress::Report report;
+            };
+
+            std::vector<JobProgress> progress() const;
+
+            // A file descriptor which becomes readable whenever a job completes, for waiting on
+            // the pool from an event loop (e.g. with asyncio's add_reader()) instead of polling.
+            // It is an eventfd, which the reader should drain by reading 8 bytes; -1 where
+            // eventfd is not available.  It belongs to the pool, and must not be closed.
+            int completion_fd() const {return completion_fd_;}
+
+            // We initialize the SimulationPool with the number of threads to use (its budget of
+            // cores), the number of threads to use for writing the log files, and the placement
+            // of the threads
+            explicit SimulationPool(
+                int thread_count = 4,
+                int io_thread_count = output::IOService::default_thread_count(),
+                Affinity affinity = Affinity::node
+            );
 
             // Waits for any remaining jobs to finish before destruction
             ~SimulationPool() noexcept;
         
         private:
+            // Each worker reports the job it is running, and its progress, in its own Slot
+            struct Slot
+            {
+                std::atomic<int> job{-1};   // -1 when idle
+                control::Progress progress;
+            };
+
             // Worker is a function object that runs in a thread and processes Simulations
             class Worker
             {
                 public:
-                    Worker(SimulationPool& pool) : pool_{pool} {}
+                    // The worker is pinned to the given CPUs, and widened to node_cpus for jobs
+                    // which were granted more than one core (both empty, and node -1, if not
+                    // pinned)
+                    Worker(
+                        SimulationPool& pool,
+                        Slot& slot,
+                        std::vector<int> cpus,
+                        std::vector<int> node_cpus,
+                        int node
+                    )
+                        : pool_{pool},
+                          slot_{slot},
+                          cpus_{std::move(cpus)},
+                          node_cpus_{std::move(node_cpus)},
+                          node_{node}
+                    {}
 
                     void operator() ();
                 
                 private:
                     SimulationPool& pool_;
+                    Slot& slot_;
+                    std::vector<int> cpus_;
+                    std::vector<int> node_cpus_;
+                    int node_;
             };
 
-            // The actual thread pool
+            // The CPUs of the machine, for placing the threads
+            tools::CpuTopology topology_;
+
+            // Writes the log files for all of the workers
+            output::IOService io_service_;
+
+            // The actual thread pool, and a Slot for each thread
+            std::vector<std::unique_ptr<Slot>> slots_;
             std::vector<std::jthread> threads_;
 
-            // The job queue
-            tools::MessageBuffer<std::reference_wrapper<Simulation>> jobs_;
+            using clock = std::chrono::steady_clock;
+
+            // A chain waiting in the queue, with the cost features of each of its simulations, the
+            // number of cores it asks for, and (once started) the number it was granted
+            struct Job
+            {
+                Chain chain;
+                CompletionHandler on_completion;
+                std::vector<CostModel::Features> features;
+                int requested_cores{1};
+                int granted_cores{0};
+                int first_id{0};
+            };
 
-            // These track the state of the queue
+            // The job queue, the CostModel, and the granting of cores are protected by the mutex
             std::mutex mutex_;
-            int queued_{};
-            int started_{};
-            int completed_{};
+            std::condition_variable job_signal_;
+            std::vector<Job> waiting_;
+            bool closed_{false};
+            CostModel cost_model_;
+
+            // The numbers of running jobs and of idle workers on each NUMA node, when the workers
+            // are pinned (also protected by the mutex)
+            std::vector<int> node_jobs_;
+            std::vector<int> node_idle_workers_;
+
+            // Whether a worker on the given node (or -1) should leave the waiting jobs to an idle
+            // worker on a node which is running fewer of them
+            bool defers_to_other_node_(int node) const;
+
+            int core_count_;
+
+            // The counters are atomic, so that status() can read them without locking (the
+            // cores in use are only changed under the mutex, but read without it)
+            std::atomic<int> cores_in_use_{};
+            std::atomic<int> queued_{};
+            std::atomic<int> started_{};
+            std::atomic<int> completed_{};
+
+            // Times since the clock's epoch, or no_time if there has not been one yet
+            static constexpr clock::rep no_time = 0;
+            std::atomic<clock::rep> first_start_time_{no_time};
+            std::atomic<clock::rep> last_completion_time_{no_time};
+
+            // Signaled by the workers on each completion
+            int completion_fd_{-1};
+            void signal_completion_();
+
+            // Take the waiting job with the largest estimated cost and grant it cores, waiting for
+            // a job and a free core if necessary; returns std::nullopt once the queue is closed
+            // and empty
+            std::optional<Job> next_job_(int node);
 
             // These wrap mutex accesses for changing the state
-            void increment_queued_();
-            void increment_started_();
-            void increment_completed_();
+            void start_(clock::time_point);
+            void complete_(
+                const CostModel::Features&,
+                clock::time_point start,
+                clock::time_point,
+                int cores,
+                bool succeeded
+            );
+            void release_cores_(int cores, int node);
     };
 } // namespace api
 
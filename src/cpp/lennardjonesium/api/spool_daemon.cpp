@@ -0,0 +1,362 @@
+/**
+ * spool_daemon.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <chrono>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <lennardjonesium/api/configuration.hpp>
+#include <lennardjonesium/api/simulation.hpp>
+#include <lennardjonesium/api/simulation_pool.hpp>
+#include <lennardjonesium/api/spool_daemon.hpp>
+
+namespace fs = std::filesystem;
+
+namespace api
+{
+    namespace
+    {
+        // The message of an exception, for error.txt
+        std::string describe(std::exception_ptr error)
+        {
+            try {std::rethrow_exception(error);}
+            catch (const std::exception& e) {return e.what();}
+            catch (...) {return "Unknown error";}
+        }
+
+        // Takes relative paths relative to the job directory, and makes sure their parent
+        // directories exist
+        void place_in_job_directory(std::string& path, const fs::path& job_directory)
+        {
+            if (path.empty()) {return;}
+
+            fs::path full_path{path};
+            if (full_path.is_relative()) {full_path = job_directory / full_path;}
+
+            fs::create_directories(full_path.parent_path());
+            path = full_path.string();
+        }
+    }
+
+    SpoolDaemon::SpoolDaemon(Parameters parameters)
+        : incoming_directory_{parameters.spool_directory / "incoming"},
+          running_directory_{parameters.spool_directory / "running"},
+          done_directory_{parameters.spool_directory / "done"},
+          failed_directory_{parameters.spool_directory / "failed"},
+          simulation_pool_{parameters.thread_count, parameters.io_thread_count, parameters.affinity}
+    {
+        for (const auto& directory
+             : {incoming_directory_, running_directory_, done_directory_, failed_directory_})
+        {
+            fs::create_directories(directory);
+        }
+
+#ifdef __linux__
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (inotify_fd_ >= 0
+            && ::inotify_add_watch(
+                inotify_fd_, incoming_directory_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO
+            ) < 0)
+        {
+            ::close(inotify_fd_);
+            inotify_fd_ = -1;
+        }
+#endif
+    }
+
+    SpoolDaemon::~SpoolDaemon() noexcept
+    {
+        // The workers may still report to us until they have finished
+        try {simulation_pool_.wait();}
+        catch (...) {}
+
+#ifdef __linux__
+        if (wake_fd_ >= 0) {::close(wake_fd_);}
+        if (inotify_fd_ >= 0) {::close(inotify_fd_);}
+#endif
+    }
+
+    void SpoolDaemon::run(std::ostream& log)
+    {
+        // Rerun the jobs which were interrupted the last time
+        for (const auto& entry : fs::directory_iterator{running_directory_})
+        {
+            if (!entry.is_directory()) {continue;}
+
+            auto name = entry.path().filename().string();
+
+            for (const auto& file : fs::directory_iterator{entry.path()})
+            {
+                if (file.path().extension() == ".ini")
+                {
+                    start_job_(name, file.path(), log);
+                    break;
+                }
+            }
+        }
+
+        take_new_jobs_(log);
+
+        while (!stopping_.load())
+        {
+            wait_();
+            file_finished_jobs_(log);
+
+            if (!stopping_.load()) {take_new_jobs_(log);}
+        }
+
+        simulation_pool_.wait();
+        file_finished_jobs_(log);
+    }
+
+    void SpoolDaemon::stop() noexcept
+    {
+        stopping_.store(true);
+        wake_();
+    }
+
+    void SpoolDaemon::take_new_jobs_(std::ostream& log)
+    {
+        // The whole directory is scanned (in order) rather than relying on the inotify events, so
+        // that nothing is missed if they overflow
+        std::vector<fs::path> configs;
+
+        for (const auto& entry : fs::directory_iterator{incoming_directory_})
+        {
+            auto filename = entry.path().filename().string();
+
+            // An entry which has already gone is not a regular file
+            std::error_code error;
+            if (entry.is_regular_file(error) && entry.path().extension() == ".ini"
+                && !filename.starts_with('.'))
+            {
+                configs.push_back(entry.path());
+            }
+        }
+
+        std::ranges::sort(configs);
+
+        for (const auto& config : configs)
+        {
+            auto name = config.stem().string();
+            auto job_directory = running_directory_ / name;
+            auto config_file = job_directory / config.filename();
+            bool created = false;
+
+            // A config can be removed or renamed after the scan, and the directories may not be
+            // writable, but that is no reason to stop taking the others
+            try
+            {
+                for (int suffix = 1; fs::exists(job_directory); ++suffix)
+                {
+                    name = config.stem().string() + "." + std::to_string(suffix);
+                    job_directory = running_directory_ / name;
+                }
+
+                created = fs::create_directory(job_directory);
+
+                config_file = job_directory / config.filename();
+                fs::rename(config, config_file);
+            }
+            catch (const std::exception& e)
+            {
+                if (created) {fail_job_(name, e.what(), log);}
+                else {log << "Failed " << name << ": " << e.what() << std::endl;}
+
+                continue;
+            }
+
+            start_job_(name, config_file, log);
+        }
+    }
+
+    void SpoolDaemon::start_job_(
+        const std::string& name,
+        const fs::path& config_file,
+        std::ostream& log
+    )
+    {
+        auto job_directory = config_file.parent_path();
+
+        try
+        {
+            std::ifstream input{config_file};
+            if (!input) {throw std::runtime_error("Cannot read " + config_file.string());}
+
+            auto configuration = parse_configuration(input);
+
+            auto& filepaths = configuration.filepaths;
+            for (auto* path : {
+                &filepaths.event_log, &filepaths.thermodynamic_log, &filepaths.observation_log,
+                &filepaths.snapshot_log, &filepaths.trajectory, &filepaths.checkpoint,
+                &filepaths.initial_state, &filepaths.final_state, &filepaths.state_cache
+            })
+            {
+                place_in_job_directory(*path, job_directory);
+            }
+
+            simulations_[name] = make_simulation(configuration);
+        }
+        catch (const std::exception& e)
+        {
+            fail_job_(name, e.what(), log);
+            return;
+        }
+
+        simulation_pool_.push(
+            *simulations_[name],
+            [this, name](std::exception_ptr error)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(finished_mutex_);
+                    finished_jobs_.push_back({name, error});
+                }
+
+                wake_();
+            }
+        );
+
+        log << "Started " << name << std::endl;
+    }
+
+    void SpoolDaemon::file_finished_jobs_(std::ostream& log)
+    {
+        std::vector<FinishedJob> finished_jobs;
+
+        {
+            std::lock_guard<std::mutex> lock(finished_mutex_);
+            finished_jobs.swap(finished_jobs_);
+        }
+
+        for (const auto& job : finished_jobs)
+        {
+            simulations_.erase(job.name);
+
+            if (job.error)
+            {
+                fail_job_(job.name, describe(job.error), log);
+                continue;
+            }
+
+            try
+            {
+                file_job_(job.name, done_directory_);
+                log << "Done " << job.name << std::endl;
+            }
+            catch (const std::exception& e)
+            {
+                log << "Could not file " << job.name << " under done/: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    void SpoolDaemon::fail_job_(
+        const std::string& name,
+        const std::string& error,
+        std::ostream& log
+    ) noexcept
+    {
+        try
+        {
+            auto destination = file_job_(name, failed_directory_);
+            std::ofstream{destination / "error.txt"} << error << '\n';
+        }
+        catch (const std::exception& e)
+        {
+            log << "Could not file " << name << " under failed/: " << e.what() << std::endl;
+        }
+
+        log << "Failed " << name << ": " << error << std::endl;
+    }
+
+    fs::path SpoolDaemon::file_job_(const std::string& name, const fs::path& destination)
+    {
+        auto target = destination / name;
+
+        for (int suffix = 1; fs::exists(target); ++suffix)
+        {
+            target = destination / (name + "." + std::to_string(suffix));
+        }
+
+        fs::rename(running_directory_ / name, target);
+        return target;
+    }
+
+    void SpoolDaemon::wait_()
+    {
+#ifdef __linux__
+        if (wake_fd_ >= 0)
+        {
+            pollfd fds[2] = {{wake_fd_, POLLIN, 0}, {inotify_fd_, POLLIN, 0}};
+            int fd_count = (inotify_fd_ >= 0) ? 2 : 1;
+
+            // Without inotify, the incoming directory is checked every second
+            ::poll(fds, static_cast<nfds_t>(fd_count), (inotify_fd_ >= 0) ? -1 : 1000);
+
+            // Drain both, since everything they signal is dealt with by looking at the directory
+            // and the finished jobs
+            std::uint64_t count;
+            [[maybe_unused]] auto unused = ::read(wake_fd_, &count, sizeof(count));
+
+            if (inotify_fd_ >= 0)
+            {
+                alignas(inotify_event) char events[4096];
+                while (::read(inotify_fd_, events, sizeof(events)) > 0) {}
+            }
+
+            return;
+        }
+#endif
+
+        std::this_thread::sleep_for(std::chrono::seconds{1});
+    }
+
+    void SpoolDaemon::wake_() noexcept
+    {
+#ifdef __linux__
+        if (wake_fd_ < 0) {return;}
+
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(wake_fd_, &one, sizeof(one));
+#endif
+    }
+} // namespace api
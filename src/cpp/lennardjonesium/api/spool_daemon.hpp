@@ -0,0 +1,155 @@
+/**
+ * spool_daemon.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_SPOOL_DAEMON_HPP
+#define LJ_SPOOL_DAEMON_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <ostream>
+
+#include <lennardjonesium/output/io_service.hpp>
+#include <lennardjonesium/api/simulation.hpp>
+#include <lennardjonesium/api/simulation_pool.hpp>
+
+namespace api
+{
+    class SpoolDaemon
+    {
+        /**
+         * SpoolDaemon runs the simulations described by config files dropped into a spool
+         * directory, on a SimulationPool which stays up for as long as the daemon does.  This way
+         * a large number of small runs does not pay for starting an interpreter and loading the
+         * library each time.  The spool directory holds four subdirectories:
+         * 
+         *      incoming/   new configs (INI files, as read by parse_configuration())
+         *      running/    a directory for each job which has been taken, holding its config
+         *      done/       the directories of the jobs which ran
+         *      failed/     the directories of the jobs which could not be run, each with an
+         *                  error.txt explaining why
+         * 
+         * A job is named after its config file: incoming/run42.ini becomes running/run42/, and then
+         * done/run42/ (with a numeric suffix if the name is already taken).  Relative paths in the
+         * config are taken relative to the job's directory, so the output files move along with it;
+         * files shared between jobs (such as a state cache) need absolute paths.  A simulation
+         * which aborts (e.g. because it did not equilibrate) still counts as done; a job fails if
+         * its config cannot be read, or its Simulation cannot be created or throws.  A job which
+         * cannot be taken or filed (e.g. because its config was removed before it could be moved
+         * to running/) is reported and skipped, and the daemon carries on with the others.
+         * 
+         * Configs should be moved into incoming/ once complete (e.g. written as run42.ini.tmp and
+         * renamed), since any file ending in .ini may be taken as soon as it appears.  Files whose
+         * names start with a dot are ignored.  The daemon is woken by inotify when files arrive
+         * (and, where inotify is not available, checks the directory every second).  On starting,
+         * it also takes the configs already in incoming/, and reruns the jobs left in running/ by
+         * a daemon which did not shut down cleanly.
+         */
+
+        public:
+            struct Parameters
+            {
+                std::filesystem::path spool_directory;
+                int thread_count = 4;
+                int io_thread_count = output::IOService::default_thread_count();
+                SimulationPool::Affinity affinity = SimulationPool::Affinity::node;
+            };
+
+            // Creates the spool subdirectories, if they do not exist
+            explicit SpoolDaemon(Parameters parameters);
+
+            // Takes and runs jobs, reporting each one on the given stream, until stop() is called;
+            // then waits for the jobs already taken to finish.  This can only be called once.
+            void run(std::ostream& log);
+
+            // Asks run() to return.  This is safe to call from another thread, or from a signal
+            // handler.
+            void stop() noexcept;
+
+            ~SpoolDaemon() noexcept;
+
+        private:
+            struct FinishedJob
+            {
+                std::string name;
+                std::exception_ptr error;
+            };
+
+            std::filesystem::path incoming_directory_;
+            std::filesystem::path running_directory_;
+            std::filesystem::path done_directory_;
+            std::filesystem::path failed_directory_;
+
+            // An eventfd for waking up run(), and an inotify instance watching incoming/ (both -1
+            // where they are not available)
+            int wake_fd_{-1};
+            int inotify_fd_{-1};
+
+            std::atomic<bool> stopping_{false};
+
+            // Jobs which have finished running, reported by the pool's workers
+            std::mutex finished_mutex_;
+            std::vector<FinishedJob> finished_jobs_;
+
+            // The Simulations of the running jobs, by name.  These must outlive the pool, so they
+            // are declared before it.
+            std::map<std::string, std::unique_ptr<Simulation>> simulations_;
+            SimulationPool simulation_pool_;
+
+            // Moves the jobs in incoming/ into running/ and pushes them onto the pool
+            void take_new_jobs_(std::ostream& log);
+
+            // Starts the job in the given directory of running/, or files it under failed/
+            void start_job_(
+                const std::string& name,
+                const std::filesystem::path& config_file,
+                std::ostream& log
+            );
+
+            // Files the jobs which the workers have finished under done/ or failed/
+            void file_finished_jobs_(std::ostream& log);
+
+            // Files the job under failed/ with the given error, and reports it.  If the job
+            // cannot be moved, this is reported too, and it is left in running/.
+            void fail_job_(
+                const std::string& name, const std::string& error, std::ostream& log
+            ) noexcept;
+
+            // Moves a job directory out of running/, and returns its new path
+            std::filesystem::path file_job_(
+                const std::string& name, const std::filesystem::path& destination
+            );
+
+            // Waits until a file arrives, a job finishes, or stop() is called
+            void wait_();
+
+            void wake_() noexcept;
+    };
+} // namespace api
+
+
+#endif
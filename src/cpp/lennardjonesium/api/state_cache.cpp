@@ -0,0 +1,191 @@
+/**
+ * state_cache.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <lennardjonesium/tools/binary_stream.hpp>
+#include <lennardjonesium/physics/system_state.hpp>
+#include <lennardjonesium/api/state_cache.hpp>
+
+namespace api
+{
+    namespace
+    {
+        // Identifies the file type and format version
+        constexpr std::array<char, 8> cache_entry_magic{'L', 'J', 'C', 'A', 'C', 'H', 'E', '1'};
+
+        constexpr const char* cache_entry_extension = ".state";
+
+        // 64-bit FNV-1a, which is stable across platforms and runs (unlike std::hash)
+        std::uint64_t fnv1a(const std::string& text)
+        {
+            std::uint64_t hash = 14695981039346656037ull;
+
+            for (unsigned char c : text)
+            {
+                hash ^= c;
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+    }
+
+    StateCache::StateCache(std::filesystem::path directory, std::uintmax_t max_size)
+        : directory_{std::move(directory)}, max_size_{max_size}
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+    }
+
+    std::filesystem::path StateCache::entry_path(const std::string& key) const
+    {
+        return directory_ / fmt::format("{:016x}{}", fnv1a(key), cache_entry_extension);
+    }
+
+    std::optional<physics::SystemState> StateCache::load(const std::string& key) const
+    {
+        auto path = entry_path(key);
+        std::ifstream source{path, std::ios::binary};
+
+        if (!source) {return std::nullopt;}
+
+        tools::BinaryReader reader{source};
+
+        std::array<char, 8> magic{};
+        std::string stored_key;
+        physics::SystemState state;
+
+        reader >> magic;
+        if (!reader.good() || magic != cache_entry_magic) {return std::nullopt;}
+
+        reader >> stored_key;
+        if (!reader.good() || stored_key != key) {return std::nullopt;}
+
+        reader >> state;
+        if (!reader.good()) {return std::nullopt;}
+
+        // Mark the entry as recently used
+        std::error_code error;
+        std::filesystem::last_write_time(
+            path, std::filesystem::file_time_type::clock::now(), error
+        );
+
+        return state;
+    }
+
+    void StateCache::store(const std::string& key, const physics::SystemState& state) const
+    {
+        auto path = entry_path(key);
+
+        // The temporary file must be unique to this writer, in case of concurrent stores.
+        // The cache may be shared by processes on several nodes, so the thread id alone
+        // is not enough.
+        std::array<char, 256> hostname{};
+        ::gethostname(hostname.data(), hostname.size() - 1);
+
+        auto temporary_path = path;
+        temporary_path += fmt::format(
+            ".{}.{}.{:x}.tmp",
+            hostname.data(),
+            ::getpid(),
+            std::hash<std::thread::id>{}(std::this_thread::get_id())
+        );
+
+        {
+            std::ofstream destination{temporary_path, std::ios::binary | std::ios::trunc};
+            tools::BinaryWriter writer{destination};
+
+            writer << cache_entry_magic << key << state;
+
+            destination.close();
+
+            if (!destination)
+            {
+                std::error_code error;
+                std::filesystem::remove(temporary_path, error);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+
+        if (!error) {evict_(path);}
+    }
+
+    void StateCache::evict_(const std::filesystem::path& keep) const
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type last_used;
+            std::uintmax_t size;
+        };
+
+        std::vector<Entry> entries;
+        std::uintmax_t total_size = 0;
+        std::error_code error;
+
+        for (const auto& item : std::filesystem::directory_iterator{directory_, error})
+        {
+            if (item.path().extension() != cache_entry_extension) {continue;}
+
+            std::error_code item_error;
+            auto size = item.file_size(item_error);
+            auto last_used = item.last_write_time(item_error);
+
+            // Another process may have evicted it in the meantime
+            if (item_error) {continue;}
+
+            entries.push_back({item.path(), last_used, size});
+            total_size += size;
+        }
+
+        if (total_size <= max_size_) {return;}
+
+        // Oldest first
+        std::ranges::sort(entries, {}, &Entry::last_used);
+
+        for (const auto& entry : entries)
+        {
+            if (total_size <= max_size_) {break;}
+            if (entry.path == keep) {continue;}
+
+            if (std::filesystem::remove(entry.path, error)) {total_size -= entry.size;}
+        }
+    }
+} // namespace api
@@ -0,0 +1,75 @@
+/**
+ * state_cache.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_STATE_CACHE_HPP
+#define LJ_STATE_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <optional>
+#include <filesystem>
+
+#include <lennardjonesium/physics/system_state.hpp>
+
+namespace api
+{
+    class StateCache
+    {
+        /**
+         * StateCache is an on-disk cache of equilibrated SystemStates, so that state points which
+         * have been equilibrated once (e.g. in a previous sweep) need not be equilibrated again.
+         * 
+         * Entries are looked up by a key, which is a canonical description of everything that
+         * determines the equilibrated state (particle count, temperature, density, force, seed,
+         * and the phases that came before observation).  Each entry is stored in its own file,
+         * named by a 64-bit hash of the key.  The file also contains the full key, which is
+         * checked on loading, so a hash collision can only cause a miss, never a wrong state.
+         * 
+         * The total size of the cache is kept below max_size by evicting the least recently used
+         * entries (a hit refreshes the modification time of the file).  Entries are written to a
+         * temporary file and renamed into place, so that several simulations (or processes) can
+         * share the same cache directory.
+         */
+
+        public:
+            StateCache(std::filesystem::path directory, std::uintmax_t max_size);
+
+            // Look up an entry; returns std::nullopt on a miss or a damaged entry
+            std::optional<physics::SystemState> load(const std::string& key) const;
+
+            // Add an entry (replacing any existing one), then evict entries if necessary
+            void store(const std::string& key, const physics::SystemState& state) const;
+
+            // The file where the entry for a given key is stored
+            std::filesystem::path entry_path(const std::string& key) const;
+
+        private:
+            std::filesystem::path directory_;
+            std::uintmax_t max_size_;
+
+            // Remove least recently used entries until the cache fits, keeping the given entry
+            void evict_(const std::filesystem::path& keep) const;
+    };
+} // namespace api
+
+
+#endif
@@ -60,6 +60,21 @@ namespace control
         double target_temperature;
     };
 
+    // Set aside the current velocities and bring all particles to rest
+    struct StashVelocities {};
+
+    // Put back the velocities set aside by StashVelocities
+    struct RestoreVelocities {};
+
+    // Bring all particles to rest without stashing their velocities
+    struct ZeroVelocities {};
+
+    // Steer the velocities toward the direction of the forces (FIRE mixing step)
+    struct MixVelocities
+    {
+        double mixing;
+    };
+
     // On success, end this phase and move on to next
     struct PhaseComplete {};
 
@@ -74,6 +89,10 @@ namespace control
         AdvanceTime,
         RecordObservation,
         AdjustTemperature,
+        StashVelocities,
+        RestoreVelocities,
+        ZeroVelocities,
+        MixVelocities,
         PhaseComplete,
         AbortSimulation
     >;
@@ -0,0 +1,69 @@
+/**
+ * progress.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include <lennardjonesium/control/progress.hpp>
+
+namespace control
+{
+    void Progress::start(int time_step, int phases_completed) noexcept
+    {
+        start_time_step_.store(time_step, std::memory_order_relaxed);
+        start_clock_.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        update(time_step, phases_completed);
+        running_.store(true, std::memory_order_relaxed);
+    }
+
+    Progress::Report Progress::report() const noexcept
+    {
+        Report report{
+            .running = running_.load(std::memory_order_relaxed),
+            .phases_completed = phases_completed_.load(std::memory_order_relaxed),
+            .time_step = time_step_.load(std::memory_order_relaxed),
+            .expected_time_steps = expected_time_steps_.load(std::memory_order_relaxed),
+            .elapsed_seconds = 0.0,
+            .steps_per_second = 0.0,
+            .eta_seconds = -1.0
+        };
+
+        if (!report.running) {return report;}
+
+        clock::duration start{start_clock_.load(std::memory_order_relaxed)};
+        std::chrono::duration<double> elapsed = clock::now().time_since_epoch() - start;
+        report.elapsed_seconds = elapsed.count();
+
+        int steps = report.time_step - start_time_step_.load(std::memory_order_relaxed);
+
+        if (steps > 0 && report.elapsed_seconds > 0.0)
+        {
+            report.steps_per_second = steps / report.elapsed_seconds;
+
+            int remaining = std::max(report.expected_time_steps - report.time_step, 0);
+            report.eta_seconds = remaining / report.steps_per_second;
+        }
+
+        return report;
+    }
+} // namespace control
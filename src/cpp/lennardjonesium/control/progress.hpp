@@ -0,0 +1,92 @@
+/**
+ * progress.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_PROGRESS_HPP
+#define LJ_PROGRESS_HPP
+
+#include <atomic>
+#include <chrono>
+
+namespace control
+{
+    class Progress
+    {
+        /**
+         * Progress records how far a running simulation has got, so that it can be watched from
+         * another thread.  The SimulationController writes it on every time step, and any thread
+         * can read a Report at any time.
+         * 
+         * Every field is a separate atomic, written with relaxed ordering, so that writing costs
+         * the simulation no more than a few plain stores.  (The controller does not even read the
+         * clock: the throughput is worked out by the reader, from the time step and the time at
+         * which the run started.)  The fields of a Report may therefore come from slightly
+         * different moments, which is harmless for a progress display.
+         * 
+         * The expected number of time steps is an upper bound (see
+         * api::Simulation::maximum_time_steps()), since the phases may finish early, so the ETA
+         * is an upper bound as well.
+         */
+
+        public:
+            struct Report
+            {
+                bool running;
+                int phases_completed;
+                int time_step;
+                int expected_time_steps;
+                double elapsed_seconds;
+                double steps_per_second;    // Since the start (or resumption) of the run
+                double eta_seconds;         // Negative if there is no estimate yet
+            };
+
+            // Set before the run starts, for the ETA
+            void set_expected_time_steps(int time_steps) noexcept
+                {expected_time_steps_.store(time_steps, std::memory_order_relaxed);}
+
+            // Written by the SimulationController
+            void start(int time_step, int phases_completed) noexcept;
+
+            void update(int time_step, int phases_completed) noexcept
+            {
+                time_step_.store(time_step, std::memory_order_relaxed);
+                phases_completed_.store(phases_completed, std::memory_order_relaxed);
+            }
+
+            void finish() noexcept {running_.store(false, std::memory_order_relaxed);}
+
+            // Read from any thread
+            Report report() const noexcept;
+
+        private:
+            using clock = std::chrono::steady_clock;
+
+            std::atomic<bool> running_{false};
+            std::atomic<int> phases_completed_{0};
+            std::atomic<int> time_step_{0};
+            std::atomic<int> start_time_step_{0};
+            std::atomic<int> expected_time_steps_{0};
+            std::atomic<clock::rep> start_clock_{0};
+    };
+} // namespace control
+
+
+#endif
@@ -20,13 +20,23 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <cassert>
+#include <atomic>
 #include <variant>
 #include <algorithm>
+#include <utility>
+#include <string>
+#include <sstream>
+#include <memory>
+
+#include <Eigen/Dense>
 
 #include <lennardjonesium/tools/overloaded_visitor.hpp>
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/system_state.hpp>
 #include <lennardjonesium/physics/transformations.hpp>
 #include <lennardjonesium/physics/measurements.hpp>
+#include <lennardjonesium/physics/analyzers.hpp>
 #include <lennardjonesium/engine/integrator.hpp>
 #include <lennardjonesium/output/log_message.hpp>
 #include <lennardjonesium/output/logger.hpp>
@@ -36,13 +46,29 @@
 
 namespace control
 {
+    namespace
+    {
+        // Counts checkpoint requests; each controller compares it with the last value it saw
+        std::atomic<unsigned int> checkpoint_requests{0};
+
+        static_assert(
+            std::atomic<unsigned int>::is_always_lock_free,
+            "request_checkpoint() must be async-signal-safe"
+        );
+    }
+
+    void SimulationController::request_checkpoint() noexcept
+    {
+        checkpoint_requests.fetch_add(1, std::memory_order_relaxed);
+    }
+
     physics::SystemState& SimulationController::operator() (physics::SystemState& state)
     {
         // Clock for counting the global time
         int time_step = 0;
 
-        // Measuring device to get the instantaneous thermodynamic information
-        physics::ThermodynamicMeasurement measurement;
+        last_checkpoint_time_ = time_step;
+        checkpoint_requests_seen_ = checkpoint_requests.load(std::memory_order_relaxed);
 
         // Initialize the first SimulationPhase
         simulation_phases_.front()->set_start_time(time_step);
@@ -50,21 +76,204 @@ namespace control
         // Log phase start event
         logger_.log(time_step, output::PhaseStartEvent{simulation_phases_.front()->name()});
 
+        return run_(state, time_step, AdvanceTime{}.time_steps);
+    }
+
+    void SimulationController::skip_phases(int count)
+    {
+        assert(count < static_cast<int>(simulation_phases_.size()) && "Cannot skip every phase");
+
+        for (int i = 0; i < count; ++i)
+        {
+            logger_.log(0, output::PhaseSkippedEvent{simulation_phases_.front()->name()});
+            simulation_phases_.pop();
+            ++phases_completed_;
+        }
+    }
+
+    physics::SystemState& SimulationController::resume(
+        physics::SystemState& state, const std::string& checkpoint
+    )
+    {
+        std::istringstream source{checkpoint};
+        tools::BinaryReader reader{source};
+
+        int time_step{};
+        int time_steps{};
+
+        int phases_completed{};
+        reader >> time_step >> phases_completed >> time_steps;
+
+        // Skip over the phases which were already complete (the schedule must not have been
+        // shortened already)
+        assert(phases_completed_ == 0 && "Cannot resume after skipping phases");
+
+        for (; phases_completed_ < phases_completed; ++phases_completed_)
+        {
+            simulation_phases_.pop();
+        }
+
+        assert(!simulation_phases_.empty() && "Checkpoint does not match schedule");
+
+        simulation_phases_.front()->restore(reader);
+        reader >> state >> stashed_velocities_;
+
+        thermodynamic_block_.restore(reader);
+        reader >> thermodynamic_block_time_step_;
+
+        assert(reader.good() && "Checkpoint is damaged");
+
+        last_checkpoint_time_ = time_step;
+        checkpoint_requests_seen_ = checkpoint_requests.load(std::memory_order_relaxed);
+
+        return run_(state, time_step, time_steps);
+    }
+
+    bool SimulationController::checkpoint_due_(int time_step)
+    {
+        auto requests = checkpoint_requests.load(std::memory_order_relaxed);
+
+        if (requests != checkpoint_requests_seen_) [[unlikely]]
+        {
+            checkpoint_requests_seen_ = requests;
+            return true;
+        }
+
+        return (
+            parameters_.checkpoint_interval > 0
+            && time_step > last_checkpoint_time_
+            && time_step % parameters_.checkpoint_interval == 0
+        );
+    }
+
+    std::string SimulationController::save_(
+        const physics::SystemState& state, int time_step, int time_steps
+    )
+    {
+        std::ostringstream destination;
+        tools::BinaryWriter writer{destination};
+
+        writer << time_step << phases_completed_ << time_steps;
+        simulation_phases_.front()->save(writer);
+        writer << state << stashed_velocities_;
+
+        thermodynamic_block_.save(writer);
+        writer << thermodynamic_block_time_step_;
+
+        return std::move(destination).str();
+    }
+
+    void SimulationController::log_trajectory_frame_(
+        int time_step, const physics::SystemState& state
+    )
+    {
+        auto frame = logger_.trajectory_frame();
+        frame.time = state.time;
+        frame.positions = state.positions;
+        frame.velocities = state.velocities;
+
+        logger_.log(time_step, std::move(frame));
+    }
+
+    void SimulationController::log_snapshot_(int time_step, const physics::SystemState& state)
+    {
+        auto snapshot = logger_.system_snapshot();
+        snapshot.positions = state.positions;
+        snapshot.velocities = state.velocities;
+        snapshot.forces = state.forces;
+
+        logger_.log(time_step, std::move(snapshot));
+    }
+
+    void SimulationController::log_thermodynamics_(
+        int time_step, const physics::ThermodynamicMeasurement& measurement
+    )
+    {
+        auto policy = simulation_phases_.front()->thermodynamic_log_policy();
+
+        assert(policy.interval > 0 && "Thermodynamic log interval must be positive");
+
+        if (!policy.aggregate)
+        {
+            if (time_step % policy.interval == 0)
+            {
+                logger_.log(time_step, output::ThermodynamicData{measurement.result()});
+            }
+
+            return;
+        }
+
+        thermodynamic_block_.collect(measurement);
+        thermodynamic_block_time_step_ = time_step;
+
+        if (thermodynamic_block_.sample_size() >= policy.interval) {log_thermodynamic_block_();}
+    }
+
+    void SimulationController::log_thermodynamic_block_()
+    {
+        if (thermodynamic_block_.sample_size() == 0) {return;}
+
+        logger_.log(thermodynamic_block_time_step_, output::ThermodynamicBlockData{
+            std::make_unique<physics::ThermodynamicBlock>(thermodynamic_block_.result())
+        });
+
+        thermodynamic_block_.clear();
+    }
+
+    physics::SystemState& SimulationController::run_(
+        physics::SystemState& state, int time_step, int first_time_steps
+    )
+    {
+        // Measuring device to get the instantaneous thermodynamic information
+        physics::ThermodynamicMeasurement measurement;
+
+        aborted_ = false;
+
+        if (parameters_.progress) {parameters_.progress->start(time_step, phases_completed_);}
+
         // Prepare the CommandQueue which will control execution
         CommandQueue command_queue;
-        command_queue.push(AdvanceTime{});
+        command_queue.push(AdvanceTime{first_time_steps});
 
         // Create the visitor object once
         auto command_interpreter = tools::OverloadedVisitor
         {
             [&](const AdvanceTime& command)
             {
+                // AdvanceTime is always the last Command issued, so nothing else is pending and
+                // this is a consistent point at which to take a checkpoint
+                if (this->checkpoint_due_(time_step)) [[unlikely]]
+                {
+                    assert(command_queue.size() == 1 && "Commands pending at checkpoint");
+
+                    this->last_checkpoint_time_ = time_step;
+                    this->logger_.log(time_step, output::CheckpointData{
+                        this->save_(state, time_step, command.time_steps)
+                    });
+                }
+
                 state | (*this->integrator_)(command.time_steps) | measurement;
 
                 // Log the measurement
-                this->logger_.log(time_step, output::ThermodynamicData{measurement.result()});
+                this->log_thermodynamics_(time_step, measurement);
 
                 time_step += command.time_steps;
+
+                if (this->parameters_.progress)
+                {
+                    this->parameters_.progress->update(time_step, this->phases_completed_);
+                }
+
+                // Record a trajectory frame whenever we pass a multiple of the snapshot interval
+                auto snapshot_interval = this->parameters_.snapshot_interval;
+
+                if (snapshot_interval > 0
+                    && time_step / snapshot_interval
+                        != (time_step - command.time_steps) / snapshot_interval)
+                {
+                    this->log_trajectory_frame_(time_step, state);
+                }
+
                 this->simulation_phases_.front()->evaluate(command_queue, time_step, measurement);
             },
 
@@ -88,23 +297,55 @@ namespace control
                 });
             },
 
+            [&](const StashVelocities& command [[maybe_unused]])
+            {
+                this->stashed_velocities_ = state.velocities;
+                state | physics::zero_velocities();
+            },
+
+            [&](const RestoreVelocities& command [[maybe_unused]])
+            {
+                assert(
+                    this->stashed_velocities_.cols() == state.particle_count()
+                    && "No velocities were stashed"
+                );
+
+                state.velocities = std::move(this->stashed_velocities_);
+                this->stashed_velocities_.resize(Eigen::NoChange, 0);
+            },
+
+            [&](const ZeroVelocities& command [[maybe_unused]])
+            {
+                state | physics::zero_velocities();
+            },
+
+            [&](const MixVelocities& command)
+            {
+                state | physics::mix_velocities_with_forces(command.mixing);
+            },
+
             [&](const PhaseComplete& command [[maybe_unused]])
             {
+                // Log the rest of the phase's last block
+                this->log_thermodynamic_block_();
+
                 // Log phase complete event
                 this->logger_.log(time_step, output::PhaseCompleteEvent{
                     this->simulation_phases_.front()->name()
                 });
                 
                 this->simulation_phases_.pop();
+                ++this->phases_completed_;
+
+                if (this->parameters_.phase_complete_callback)
+                {
+                    this->parameters_.phase_complete_callback(this->phases_completed_, state);
+                }
 
                 if (this->simulation_phases_.empty())
                 {
                     // If we are finished, then record a snapshot
-                    this->logger_.log(time_step, output::SystemSnapshot{
-                        .positions = state.positions,
-                        .velocities = state.velocities,
-                        .forces = state.forces
-                    });
+                    this->log_snapshot_(time_step, state);
                 }
                 else
                 {
@@ -123,15 +364,15 @@ namespace control
 
             [&](const AbortSimulation& command)
             {
+                this->aborted_ = true;
+
+                this->log_thermodynamic_block_();
+
                 // Log abort event
                 this->logger_.log(time_step, output::AbortSimulationEvent{command.reason});
 
                 // Log snapshot in case we would like it for diagnostic reasons
-                this->logger_.log(time_step, output::SystemSnapshot{
-                    .positions = state.positions,
-                    .velocities = state.velocities,
-                    .forces = state.forces
-                });
+                this->log_snapshot_(time_step, state);
             }
         };
         
@@ -142,6 +383,12 @@ namespace control
             command_queue.pop();
         }
 
+        if (parameters_.progress)
+        {
+            parameters_.progress->update(time_step, phases_completed_);
+            parameters_.progress->finish();
+        }
+
         return state;
     }
 } // namespace control
@@ -25,13 +25,21 @@
 
 #include <cassert>
 #include <queue>
+#include <string>
 #include <utility>
 #include <memory>
+#include <functional>
 
+#include <Eigen/Dense>
+
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/system_state.hpp>
+#include <lennardjonesium/physics/measurements.hpp>
+#include <lennardjonesium/physics/analyzers.hpp>
 #include <lennardjonesium/engine/integrator.hpp>
 #include <lennardjonesium/output/logger.hpp>
 #include <lennardjonesium/control/simulation_phase.hpp>
+#include <lennardjonesium/control/progress.hpp>
 
 namespace control
 {
@@ -43,26 +51,79 @@ namespace control
          * decisions regarding what to do at each time step.  The SimulationController itself is
          * responsible for keeping track of the time step count, as well as pushing relevant data
          * to various message queues.
+         *
+         * The SimulationController can also take checkpoints, which are sent to the Logger like
+         * any other message.  A checkpoint is taken every checkpoint_interval time steps (if
+         * nonzero), and also whenever request_checkpoint() has been called since the last one.
+         * A checkpoint contains everything needed to continue the run bit-for-bit:  the time step,
+         * the position in the schedule, the internal state of the current SimulationPhase, and
+         * the full SystemState.  (The only random numbers are used by the InitialCondition, so
+         * there is no further generator state to save.)
+         * 
+         * If snapshot_interval is nonzero, a TrajectoryFrame is also logged every
+         * snapshot_interval time steps, for recording the trajectory of the system.
          * 
-         * TODO: We have implemented the main message queue, however one thing we'd like to add is
-         * some output of the full system trajectory.  This could be used to draw to the screen,
-         * or write to a file which could afterwards be used to make a movie.  The system trajectory
-         * should get its own buffer, as it will require some special handling.
+         * The ThermodynamicMeasurements are logged according to the ThermodynamicLogPolicy of the
+         * current phase.  Blocks of time steps are aggregated here, so that only one message per
+         * block is sent to the Logger.  A partial block is logged when its phase ends.
+         * 
+         * If a Progress record is given, the time step and the number of completed phases are
+         * written to it as the run goes on, for watching the run from another thread.
          */
 
         public:
             using Schedule = std::queue<std::unique_ptr<SimulationPhase>>;
 
+            struct Parameters
+            {
+                // Number of time steps between checkpoints (0 means only on request)
+                int checkpoint_interval = 0;
+
+                // Number of time steps between trajectory frames (0 means no trajectory)
+                int snapshot_interval = 0;
+
+                // Called with the number of phases completed so far, whenever a phase completes
+                std::function<void (int, const physics::SystemState&)> phase_complete_callback{};
+
+                // Where to record the progress of the run (not recorded if null)
+                Progress* progress = nullptr;
+            };
+
+            // Run the schedule from the beginning on the given initial state
             physics::SystemState& operator() (physics::SystemState&);
 
+            // Drop the first phases of the schedule before running, e.g. because the initial state
+            // is already equilibrated.  They still count as completed phases.
+            void skip_phases(int count);
+
+            // Continue the run saved in a checkpoint payload; the given state is overwritten
+            physics::SystemState& resume(physics::SystemState&, const std::string& checkpoint);
+
+            // Ask every running SimulationController to take a checkpoint at its next time step.
+            // This is async-signal-safe, so it can be called from a signal handler.
+            static void request_checkpoint() noexcept;
+
+            // Whether the last run ended with an AbortSimulation command
+            bool aborted() const {return aborted_;}
+
             SimulationController(
                 std::unique_ptr<const engine::Integrator> integrator,
                 Schedule schedule,
                 output::Logger& logger
+            )
+                : SimulationController(std::move(integrator), std::move(schedule), logger, {})
+            {}
+
+            SimulationController(
+                std::unique_ptr<const engine::Integrator> integrator,
+                Schedule schedule,
+                output::Logger& logger,
+                Parameters parameters
             )
                 : integrator_{std::move(integrator)},
                   simulation_phases_{std::move(schedule)},
-                  logger_{logger}
+                  logger_{logger},
+                  parameters_{parameters}
             {
                 assert(integrator_ != nullptr && "No Integrator instance given");
             }
@@ -71,6 +132,44 @@ namespace control
             std::unique_ptr<const engine::Integrator> integrator_;
             Schedule simulation_phases_;
             output::Logger& logger_;
+            Parameters parameters_;
+
+            bool aborted_{false};
+
+            // Bookkeeping needed for checkpoints
+            int phases_completed_{0};
+            int last_checkpoint_time_{0};
+            unsigned int checkpoint_requests_seen_{0};
+
+            // Velocities set aside while a phase works with the particles at rest
+            Eigen::Matrix4Xd stashed_velocities_;
+
+            // The block of measurements being aggregated, and the time step of the last one
+            physics::ThermodynamicBlockAnalyzer thermodynamic_block_;
+            int thermodynamic_block_time_step_{0};
+
+            // The main loop, starting from the given time step and first command
+            physics::SystemState& run_(
+                physics::SystemState& state, int time_step, int first_time_steps
+            );
+
+            // Decide whether a checkpoint should be taken at this time step
+            bool checkpoint_due_(int time_step);
+
+            // Serialize everything needed to continue from the upcoming AdvanceTime command
+            std::string save_(const physics::SystemState& state, int time_step, int time_steps);
+
+            // Copy the state into recycled messages from the Logger, and log them
+            void log_trajectory_frame_(int time_step, const physics::SystemState& state);
+            void log_snapshot_(int time_step, const physics::SystemState& state);
+
+            // Log a measurement according to the ThermodynamicLogPolicy of the current phase
+            void log_thermodynamics_(
+                int time_step, const physics::ThermodynamicMeasurement& measurement
+            );
+
+            // Log the block of measurements collected so far (if any), and start a new one
+            void log_thermodynamic_block_();
     };
 } // namespace control
 
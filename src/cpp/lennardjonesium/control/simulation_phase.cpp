@@ -20,8 +20,11 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+
 #include <lennardjonesium/tools/math.hpp>
 #include <lennardjonesium/tools/moving_sample.hpp>
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/measurements.hpp>
 #include <lennardjonesium/physics/observation.hpp>
 #include <lennardjonesium/control/command_queue.hpp>
@@ -29,6 +32,111 @@
 
 namespace control
 {
+    MinimizationPhase::MinimizationPhase(
+        std::string name,
+        tools::SystemParameters system_parameters,
+        int start_time
+    )
+        : MinimizationPhase::MinimizationPhase(name, system_parameters, {}, start_time)
+    {}
+
+    void MinimizationPhase::evaluate(
+        CommandQueue& command_queue,    // Output parameter
+        int time_step,
+        const physics::ThermodynamicMeasurement& measurement
+    )
+    {
+        double potential_energy = measurement.result().potential_energy
+            / static_cast<double>(system_parameters_.particle_count);
+
+        // On the first step, set aside the thermal velocities and start from rest
+        if (!velocities_stashed_) [[unlikely]]
+        {
+            velocities_stashed_ = true;
+            mixing_ = minimization_parameters_.mixing;
+            downhill_steps_ = 0;
+            last_potential_energy_ = potential_energy;
+            last_check_potential_energy_ = potential_energy;
+
+            command_queue.push(StashVelocities{});
+            command_queue.push(AdvanceTime{});
+            return;
+        }
+
+        // FIRE step:  stop when moving uphill, otherwise steer toward the forces
+        if (potential_energy > last_potential_energy_)
+        {
+            mixing_ = minimization_parameters_.mixing;
+            downhill_steps_ = 0;
+            command_queue.push(ZeroVelocities{});
+        }
+        else
+        {
+            command_queue.push(MixVelocities{mixing_});
+
+            if (++downhill_steps_ > minimization_parameters_.delay)
+            {
+                mixing_ *= minimization_parameters_.mixing_decay;
+            }
+        }
+
+        last_potential_energy_ = potential_energy;
+
+        // Check whether the potential energy has settled and return early
+        if (time_step - last_check_time_
+            >= minimization_parameters_.check_interval) [[unlikely]]
+        {
+            last_check_time_ = time_step;
+
+            if (std::abs(last_check_potential_energy_ - potential_energy)
+                < minimization_parameters_.energy_tolerance)
+            {
+                command_queue.push(RestoreVelocities{});
+                command_queue.push(PhaseComplete{});
+                return;
+            }
+
+            last_check_potential_energy_ = potential_energy;
+        }
+
+        // Check whether we have reached timeout and return early
+        if (time_step - start_time_ >= minimization_parameters_.timeout) [[unlikely]]
+        {
+            command_queue.push(RestoreVelocities{});
+            command_queue.push(PhaseComplete{});
+            return;
+        }
+
+        // If we reach here, add the default command to advance to next time step
+        command_queue.push(AdvanceTime{});
+    }
+
+    void MinimizationPhase::save(tools::BinaryWriter& writer) const
+    {
+        SimulationPhase::save(writer);
+
+        writer
+            << mixing_
+            << last_potential_energy_
+            << last_check_potential_energy_
+            << last_check_time_
+            << downhill_steps_
+            << velocities_stashed_;
+    }
+
+    void MinimizationPhase::restore(tools::BinaryReader& reader)
+    {
+        SimulationPhase::restore(reader);
+
+        reader
+            >> mixing_
+            >> last_potential_energy_
+            >> last_check_potential_energy_
+            >> last_check_time_
+            >> downhill_steps_
+            >> velocities_stashed_;
+    }
+
     EquilibrationPhase::EquilibrationPhase(
         std::string name,
         tools::SystemParameters system_parameters,
@@ -83,6 +191,28 @@ namespace control
         command_queue.push(AdvanceTime{});
     }
 
+    void EquilibrationPhase::save(tools::BinaryWriter& writer) const
+    {
+        SimulationPhase::save(writer);
+        temperature_analyzer_.save(writer);
+
+        writer
+            << last_temperature_
+            << last_adjustment_check_time_
+            << last_adjustment_time_;
+    }
+
+    void EquilibrationPhase::restore(tools::BinaryReader& reader)
+    {
+        SimulationPhase::restore(reader);
+        temperature_analyzer_.restore(reader);
+
+        reader
+            >> last_temperature_
+            >> last_adjustment_check_time_
+            >> last_adjustment_time_;
+    }
+
     ObservationPhase::ObservationPhase(
         std::string name,
         tools::SystemParameters system_parameters,
@@ -133,5 +263,24 @@ namespace control
         // If we reach here, add the default command to advance to next time step
         command_queue.push(AdvanceTime{});
     }
-} // namespace control
 
+    void ObservationPhase::save(tools::BinaryWriter& writer) const
+    {
+        SimulationPhase::save(writer);
+        thermodynamic_analyzer_.save(writer);
+
+        writer
+            << last_observation_time_
+            << observation_count_;
+    }
+
+    void ObservationPhase::restore(tools::BinaryReader& reader)
+    {
+        SimulationPhase::restore(reader);
+        thermodynamic_analyzer_.restore(reader);
+
+        reader
+            >> last_observation_time_
+            >> observation_count_;
+    }
+} // namespace control
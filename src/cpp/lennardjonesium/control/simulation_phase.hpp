@@ -29,12 +29,27 @@
 
 #include <lennardjonesium/tools/system_parameters.hpp>
 #include <lennardjonesium/tools/moving_sample.hpp>
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/measurements.hpp>
 #include <lennardjonesium/physics/analyzers.hpp>
 #include <lennardjonesium/control/command_queue.hpp>
 
 namespace control
 {
+    struct ThermodynamicLogPolicy
+    {
+        /**
+         * How the ThermodynamicMeasurements are logged while a phase is running.  With the
+         * default interval of 1, every time step is logged.  A larger interval logs only every
+         * interval-th time step, or, if aggregate is set, the statistics of each block of
+         * interval time steps (see physics::ThermodynamicBlock).  Blocks do not extend past the
+         * end of a phase.
+         */
+
+        int interval = 1;
+        bool aggregate = false;
+    };
+
     class SimulationPhase
     {
         /**
@@ -62,6 +77,14 @@ namespace control
             // Derived classes may have further work to do
             virtual void set_start_time(int start_time) {start_time_ = start_time;}
 
+            // How the SimulationController should log the measurements during this phase
+            virtual ThermodynamicLogPolicy thermodynamic_log_policy() const {return {};}
+
+            // Write and read back the internal state of the phase, so that a run can be
+            // checkpointed.  Derived classes with further internal state must extend these.
+            virtual void save(tools::BinaryWriter& writer) const {writer << start_time_;}
+            virtual void restore(tools::BinaryReader& reader) {reader >> start_time_;}
+
             virtual ~SimulationPhase() = default;
         
         protected:
@@ -75,6 +98,110 @@ namespace control
             {set_start_time(start_time);}
     };
 
+    class MinimizationPhase : public SimulationPhase
+    {
+        /**
+         * MinimizationPhase relaxes the particle positions toward a local minimum of the potential
+         * energy before any dynamics takes place.  This is useful for dense starts, where the
+         * lattice positions can produce large forces that blow up the first few time steps.
+         * 
+         * We use the FIRE algorithm (Fast Inertial Relaxation Engine, Bitzek et al. 2006), which
+         * is ordinary molecular dynamics with two modifications:  the velocities are continually
+         * steered toward the direction of the forces, and whenever the system starts moving
+         * uphill, all particles are brought to rest.  We can only see the ThermodynamicMeasurement
+         * here, so "moving uphill" is detected as an increase in the potential energy from one
+         * time step to the next (which, to first order, is the sign of the power F.v).  Since our
+         * Integrator uses a fixed time step, we do not adapt the time step as in the original
+         * algorithm; only the mixing parameter is adapted.
+         * 
+         * The thermal velocities assigned by the InitialCondition are stashed at the start of the
+         * phase and restored at the end, so that the subsequent phases start from the relaxed
+         * positions with the original Maxwell distribution of velocities.
+         * 
+         * The parameters have the following meanings:
+         * 
+         * energy_tolerance:  The minimization has converged when the potential energy per
+         *      particle changes by less than this amount over check_interval time steps.
+         * 
+         * check_interval:  The number of time steps between convergence checks.
+         * 
+         * mixing:  The initial amount of force direction mixed into the velocities at each step
+         *      (called alpha_start in the FIRE literature).
+         * 
+         * mixing_decay:  The factor by which the mixing parameter is reduced at each step, once
+         *      the system has been moving downhill for longer than the delay.
+         * 
+         * delay:  The number of downhill time steps to wait before reducing the mixing.
+         * 
+         * timeout:  If the minimization has not converged after this many time steps, we end the
+         *      phase anyway.  A partially relaxed state is still better than none, so this does
+         *      not abort the simulation.
+         */
+
+        public:
+            struct Parameters
+            {
+                double energy_tolerance = 1.0e-6;
+                int check_interval = 20;
+                double mixing = 0.1;
+                double mixing_decay = 0.99;
+                int delay = 5;
+                int timeout = 2000;
+                ThermodynamicLogPolicy thermodynamic_log = {};
+            };
+
+            // Set all clocks to match start time
+            virtual void set_start_time(int start_time) override
+            {
+                start_time_ = start_time;
+                last_check_time_ = start_time;
+                velocities_stashed_ = false;
+            }
+
+            // Main constructor requires all arguments
+            MinimizationPhase(
+                std::string name,
+                tools::SystemParameters system_parameters,
+                Parameters minimization_parameters,
+                int start_time = 0
+            )
+                : SimulationPhase{name},
+                  system_parameters_{system_parameters},
+                  minimization_parameters_{minimization_parameters},
+                  mixing_{minimization_parameters.mixing}
+            {set_start_time(start_time);}
+
+            // If no parameters given, use defaults
+            MinimizationPhase(
+                std::string name,
+                tools::SystemParameters system_parameters,
+                int start_time = 0
+            );
+
+            // Evaluate the thermodynamic properties of the state and issue commands
+            virtual void evaluate(
+                CommandQueue& command_queue,    // Output parameter
+                int time_step,
+                const physics::ThermodynamicMeasurement& measurement
+            ) override;
+
+            virtual ThermodynamicLogPolicy thermodynamic_log_policy() const override
+                {return minimization_parameters_.thermodynamic_log;}
+
+            virtual void save(tools::BinaryWriter& writer) const override;
+            virtual void restore(tools::BinaryReader& reader) override;
+        
+        private:
+            tools::SystemParameters system_parameters_;
+            Parameters minimization_parameters_;
+            double mixing_;
+            double last_potential_energy_{};
+            double last_check_potential_energy_{};
+            int last_check_time_;
+            int downhill_steps_{0};
+            bool velocities_stashed_{false};
+    };
+
     class EquilibrationPhase : public SimulationPhase
     {
         /**
@@ -117,6 +244,7 @@ namespace control
                 int adjustment_interval = 200;
                 int steady_state_time = 1000;
                 int timeout = 5000;
+                ThermodynamicLogPolicy thermodynamic_log = {};
             };
 
             // Set all clocks to match start time
@@ -153,6 +281,12 @@ namespace control
                 int time_step,
                 const physics::ThermodynamicMeasurement& measurement
             ) override;
+
+            virtual ThermodynamicLogPolicy thermodynamic_log_policy() const override
+                {return equilibration_parameters_.thermodynamic_log;}
+
+            virtual void save(tools::BinaryWriter& writer) const override;
+            virtual void restore(tools::BinaryReader& reader) override;
         
         private:
             physics::TemperatureAnalyzer temperature_analyzer_;
@@ -200,6 +334,7 @@ namespace control
                 int sample_size = 50;
                 int observation_interval = 200;
                 int observation_count = 20;
+                ThermodynamicLogPolicy thermodynamic_log = {};
             };
 
             // Set all clocks to match start time
@@ -235,6 +370,12 @@ namespace control
                 int time_step,
                 const physics::ThermodynamicMeasurement& measurement
             ) override;
+
+            virtual ThermodynamicLogPolicy thermodynamic_log_policy() const override
+                {return observation_parameters_.thermodynamic_log;}
+
+            virtual void save(tools::BinaryWriter& writer) const override;
+            virtual void restore(tools::BinaryReader& reader) override;
         
         private:
             physics::ThermodynamicAnalyzer thermodynamic_analyzer_;
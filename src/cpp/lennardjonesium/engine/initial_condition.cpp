@@ -20,7 +20,10 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <cassert>
+#include <cmath>
 #include <random>
+#include <utility>
 #include <ranges>
 
 #include <Eigen/Dense>
@@ -69,8 +72,34 @@ namespace engine
             ++index;
         }
 
+        choose_velocities_();
+        
+        // Now the initial state is set up.
+    }
+
+    InitialCondition::InitialCondition(
+        tools::SystemParameters system_parameters,
+        Eigen::Matrix4Xd positions,
+        std::random_device::result_type seed
+    )
+        : system_parameters_{system_parameters},
+          bounding_box_{std::cbrt(system_parameters.particle_count / system_parameters.density)},
+          system_state_{system_parameters.particle_count},
+          seed_{seed}
+    {
+        assert(
+            positions.cols() == system_parameters_.particle_count
+            && "Positions have the wrong number of particles"
+        );
+
+        system_state_.positions = std::move(positions);
+        choose_velocities_();
+    }
+
+    void InitialCondition::choose_velocities_()
+    {
         /**
-         * Next, we choose the initial velocities from a Maxwell-Boltzmann distribution.  This is
+         * We choose the initial velocities from a Maxwell-Boltzmann distribution.  This is
          * just a normal distribution with mean 0 and variance equal to the temperature.
          */
         random_number_engine_type gen{seed_};
@@ -99,8 +128,43 @@ namespace engine
             | physics::zero_momentum()
             | physics::zero_angular_momentum(center_of_mass)
             | physics::set_temperature(system_parameters_.temperature);
-        
-        // Now the initial state is set up.
     }
-} // namespace engine
 
+    InitialCondition::InitialCondition(
+        tools::SystemParameters system_parameters,
+        physics::SystemState previous_state,
+        tools::SystemParameters previous_parameters,
+        std::random_device::result_type seed
+    )
+        : system_parameters_{system_parameters},
+          bounding_box_{std::cbrt(system_parameters.particle_count / system_parameters.density)},
+          system_state_{std::move(previous_state)},
+          seed_{seed}
+    {
+        assert(
+            system_state_.particle_count() == system_parameters_.particle_count
+            && "Previous state has the wrong number of particles"
+        );
+
+        /**
+         * The box side length is proportional to the cube root of the volume per particle, so a
+         * change of density is an affine rescaling of the box and all the positions within it.
+         * The forces are then no longer valid, so we clear them, as for a fresh lattice.  (They
+         * are recomputed on the first time step.)
+         */
+        double scale_factor = std::cbrt(previous_parameters.density / system_parameters_.density);
+
+        if (scale_factor != 1.0)
+        {
+            system_state_.positions *= scale_factor;
+            system_state_ | physics::clear_dynamics;
+        }
+
+        // The new simulation keeps its own clock and measures displacements from its own start
+        system_state_ | physics::clear_displacements;
+        system_state_.time = 0.0;
+
+        // Finally, bring the kinetic energy to the new temperature
+        system_state_ | physics::set_temperature(system_parameters_.temperature);
+    }
+} // namespace engine
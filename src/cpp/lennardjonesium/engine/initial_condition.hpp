@@ -44,6 +44,15 @@ namespace engine
          * We do not enforce any particular method of choosing the initial seed.  If not provided,
          * we use the default one.  The caller is responsible for determining their own method of
          * choosing a seed, either via the system time or std::random_device, etc.
+         * 
+         * Alternatively, an InitialCondition can be made from the final state of another
+         * simulation of the same number of particles at a nearby temperature and density (a "warm
+         * start").  The positions and the box are rescaled affinely to the new density, and the
+         * velocities are rescaled to the new temperature.  Since such a state is already close to
+         * equilibrium, it needs a much shorter equilibration than a crystal lattice does.
+         * 
+         * Finally, the positions can simply be given (e.g. from Python), in which case only the
+         * velocities are chosen, in the same way as for the lattice.
          */
 
         public:
@@ -59,6 +68,21 @@ namespace engine
                 std::random_device::result_type seed = random_number_engine_type::default_seed,
                 tools::CubicLattice::UnitCell unit_cell = tools::CubicLattice::FaceCentered()
             );
+
+            // Warm start from a state that was in equilibrium with the previous SystemParameters
+            InitialCondition(
+                tools::SystemParameters system_parameters,
+                physics::SystemState previous_state,
+                tools::SystemParameters previous_parameters,
+                std::random_device::result_type seed = random_number_engine_type::default_seed
+            );
+
+            // Start from the given positions (a 4xN matrix whose last row is zero)
+            InitialCondition(
+                tools::SystemParameters system_parameters,
+                Eigen::Matrix4Xd positions,
+                std::random_device::result_type seed = random_number_engine_type::default_seed
+            );
             
             // These return by value so that the original InitialCondition will not be modified
             tools::BoundingBox bounding_box() {return bounding_box_;}
@@ -78,6 +102,9 @@ namespace engine
                 tools::CubicLattice cubic_lattice
             );
 
+            // Choose velocities at the desired temperature, with no linear or angular momentum
+            void choose_velocities_();
+
             // Data members
             tools::SystemParameters system_parameters_;
             tools::BoundingBox bounding_box_;
@@ -0,0 +1,586 @@
+/**
+ * async_file.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define LJ_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include <lennardjonesium/tools/message_buffer.hpp>
+#include <lennardjonesium/output/async_file.hpp>
+
+namespace output
+{
+    namespace
+    {
+        // Write all of the data, returning the number of bytes written, or -errno on failure
+        long pwrite_all(int fd, const char* data, std::size_t size, off_t offset)
+        {
+            std::size_t written = 0;
+
+            while (written < size)
+            {
+                auto result = ::pwrite(fd, data + written, size - written, offset + written);
+
+                if (result < 0)
+                {
+                    if (errno == EINTR) {continue;}
+                    return -errno;
+                }
+
+                written += static_cast<std::size_t>(result);
+            }
+
+            return static_cast<long>(written);
+        }
+
+        struct Completion
+        {
+            int buffer;     // The buffer which was written
+            long result;    // The number of bytes written, or -errno
+        };
+
+        class WriteBackend
+        {
+            /**
+             * A WriteBackend writes buffers to the file asynchronously.  Each buffer submitted
+             * produces one Completion, which is returned by wait() once the write is done.
+             */
+
+            public:
+                virtual void submit(
+                    int buffer, const char* data, std::size_t size, off_t offset
+                ) = 0;
+
+                virtual Completion wait() = 0;
+
+                virtual ~WriteBackend() = default;
+        };
+
+        class ThreadBackend : public WriteBackend
+        {
+            // The fallback: a thread which calls pwrite() for each buffer in turn
+
+            public:
+                explicit ThreadBackend(int fd)
+                    : fd_{fd}, thread_{[this]() {this->run_();}}
+                {}
+
+                virtual void submit(
+                    int buffer, const char* data, std::size_t size, off_t offset
+                ) override
+                {
+                    requests_.put({buffer, data, size, offset});
+                }
+
+                virtual Completion wait() override {return completions_.get().value();}
+
+                virtual ~ThreadBackend()
+                {
+                    requests_.close();
+                    thread_.join();
+                }
+
+            private:
+                struct Request
+                {
+                    int buffer;
+                    const char* data;
+                    std::size_t size;
+                    off_t offset;
+                };
+
+                int fd_;
+                tools::MessageBuffer<Request> requests_;
+                tools::MessageBuffer<Completion> completions_;
+                std::thread thread_;
+
+                void run_()
+                {
+                    while (auto request = requests_.get())
+                    {
+                        completions_.put({
+                            request->buffer,
+                            pwrite_all(fd_, request->data, request->size, request->offset)
+                        });
+                    }
+                }
+        };
+
+#ifdef LJ_HAVE_IO_URING
+        class UringBackend : public WriteBackend
+        {
+            /**
+             * Submits the writes through an io_uring.  We use the system calls directly rather
+             * than liburing, since we only need to submit one kind of request and wait for it.
+             * The submission and completion rings are shared with the kernel, so their head and
+             * tail indices must be accessed atomically.
+             */
+
+            public:
+                // Returns nullptr if io_uring is not available
+                static std::unique_ptr<UringBackend> create(int fd, unsigned entries)
+                {
+                    std::unique_ptr<UringBackend> backend{new UringBackend{fd}};
+                    if (!backend->setup_(entries)) {return nullptr;}
+                    return backend;
+                }
+
+                virtual void submit(
+                    int buffer, const char* data, std::size_t size, off_t offset
+                ) override
+                {
+                    auto tail = *sq_tail_;
+                    auto index = tail & *sq_mask_;
+
+                    auto& entry = sqes_[index];
+                    entry = {};
+                    entry.opcode = IORING_OP_WRITE;
+                    entry.fd = fd_;
+                    entry.addr = reinterpret_cast<std::uint64_t>(data);
+                    entry.len = static_cast<std::uint32_t>(size);
+                    entry.off = static_cast<std::uint64_t>(offset);
+                    entry.user_data = static_cast<std::uint64_t>(buffer);
+
+                    sq_array_[index] = index;
+                    std::atomic_ref<unsigned>{*sq_tail_}.store(tail + 1, std::memory_order_release);
+
+                    int result;
+                    do {result = enter_(1, 0, 0);} while (result < 0 && errno == EINTR);
+
+                    if (result < 0)
+                    {
+                        // The kernel did not take the entry, so take it back and write it here
+                        std::atomic_ref<unsigned>{*sq_tail_}.store(tail, std::memory_order_release);
+                        ready_.push_back({buffer, pwrite_all(fd_, data, size, offset)});
+                    }
+                }
+
+                virtual Completion wait() override
+                {
+                    if (!ready_.empty())
+                    {
+                        auto completion = ready_.front();
+                        ready_.pop_front();
+                        return completion;
+                    }
+
+                    auto head = *cq_head_;
+                    std::atomic_ref<unsigned> tail{*cq_tail_};
+
+                    while (head == tail.load(std::memory_order_acquire))
+                    {
+                        enter_(0, 1, IORING_ENTER_GETEVENTS);
+                    }
+
+                    const auto& entry = cqes_[head & *cq_mask_];
+                    Completion completion{static_cast<int>(entry.user_data), entry.res};
+
+                    std::atomic_ref<unsigned>{*cq_head_}.store(head + 1, std::memory_order_release);
+
+                    return completion;
+                }
+
+                virtual ~UringBackend()
+                {
+                    if (sqes_ != nullptr) {::munmap(sqes_, sqes_size_);}
+                    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+                    {
+                        ::munmap(cq_ring_, cq_ring_size_);
+                    }
+                    if (sq_ring_ != nullptr) {::munmap(sq_ring_, sq_ring_size_);}
+                    if (ring_fd_ >= 0) {::close(ring_fd_);}
+                }
+
+            private:
+                explicit UringBackend(int fd) : fd_{fd} {}
+
+                int fd_;
+                int ring_fd_ = -1;
+
+                void* sq_ring_ = nullptr;
+                void* cq_ring_ = nullptr;
+                io_uring_sqe* sqes_ = nullptr;
+                std::size_t sq_ring_size_ = 0;
+                std::size_t cq_ring_size_ = 0;
+                std::size_t sqes_size_ = 0;
+
+                unsigned* sq_tail_ = nullptr;
+                unsigned* sq_mask_ = nullptr;
+                unsigned* sq_array_ = nullptr;
+                unsigned* cq_head_ = nullptr;
+                unsigned* cq_tail_ = nullptr;
+                unsigned* cq_mask_ = nullptr;
+                io_uring_cqe* cqes_ = nullptr;
+
+                // Completions of writes which had to be done synchronously
+                std::deque<Completion> ready_;
+
+                int enter_(unsigned to_submit, unsigned min_complete, unsigned flags)
+                {
+                    return static_cast<int>(::syscall(
+                        __NR_io_uring_enter, ring_fd_, to_submit, min_complete, flags, nullptr, 0
+                    ));
+                }
+
+                static void* map_(int ring_fd, std::size_t size, off_t offset)
+                {
+                    auto address = ::mmap(
+                        nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd, offset
+                    );
+
+                    return address == MAP_FAILED ? nullptr : address;
+                }
+
+                bool setup_(unsigned entries)
+                {
+                    io_uring_params params{};
+                    ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                    if (ring_fd_ < 0) {return false;}
+
+                    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+
+                    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+                    if (single_mmap)
+                    {
+                        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+                    }
+
+                    sq_ring_ = map_(ring_fd_, sq_ring_size_, IORING_OFF_SQ_RING);
+                    if (sq_ring_ == nullptr) {return false;}
+
+                    cq_ring_ = single_mmap
+                        ? sq_ring_ : map_(ring_fd_, cq_ring_size_, IORING_OFF_CQ_RING);
+                    if (cq_ring_ == nullptr) {return false;}
+
+                    sqes_ = static_cast<io_uring_sqe*>(map_(ring_fd_, sqes_size_, IORING_OFF_SQES));
+                    if (sqes_ == nullptr) {return false;}
+
+                    auto sq = static_cast<char*>(sq_ring_);
+                    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+                    auto cq = static_cast<char*>(cq_ring_);
+                    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                    return true;
+                }
+        };
+#endif
+
+        constexpr std::size_t round_up(std::size_t size, std::size_t block)
+        {
+            return (size + block - 1) / block * block;
+        }
+    } // namespace
+
+    class AsyncFileSink::File
+    {
+        public:
+            File(const std::filesystem::path& path, std::ios::openmode mode, AsyncFileOptions);
+
+            ~File() noexcept
+            {
+                try {close();}
+                catch (...) {}
+            }
+
+            std::streamsize write(const char* data, std::streamsize size);
+            bool flush();
+            void close();
+
+            bool is_open() const {return fd_ >= 0;}
+            bool using_io_uring() const {return io_uring_;}
+            bool using_direct_io() const {return direct_;}
+
+        private:
+            struct FreeDeleter
+            {
+                void operator()(char* buffer) const {std::free(buffer);}
+            };
+
+            struct Request
+            {
+                const char* data;
+                std::size_t size;
+                off_t offset;
+            };
+
+            int fd_ = -1;
+            bool direct_ = false;
+            bool io_uring_ = false;
+            bool failed_ = false;
+
+            std::size_t buffer_size_;
+            std::vector<std::unique_ptr<char[], FreeDeleter>> buffers_;
+            std::vector<Request> requests_;     // What each buffer is writing
+            std::vector<int> free_buffers_;
+            int in_flight_ = 0;
+
+            // The buffer being filled, how much is in it, and where in the file it goes
+            int current_ = 0;
+            std::size_t fill_ = 0;
+            off_t offset_ = 0;
+
+            std::unique_ptr<WriteBackend> backend_;
+
+            // Submit size bytes of the given buffer, to be written at offset_
+            void submit_(int buffer, std::size_t size);
+
+            // Submit the current buffer and move on to a free one
+            void rotate_();
+
+            // Wait for one write to complete
+            void reap_();
+
+            void wait_all_() {while (in_flight_ > 0) {reap_();}}
+    };
+
+    AsyncFileSink::File::File(
+        const std::filesystem::path& path, std::ios::openmode mode, AsyncFileOptions options
+    )
+        : buffer_size_{round_up(std::max(options.buffer_size, block_size), block_size)}
+    {
+        bool append = (mode & std::ios::app) != 0;
+        int flags = O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC);
+
+        // With O_DIRECT we may need to read back a partial block when appending
+        if (options.direct)
+        {
+            fd_ = ::open(path.c_str(), flags | O_RDWR | O_DIRECT, 0644);
+            direct_ = fd_ >= 0;
+        }
+
+        if (fd_ < 0) {fd_ = ::open(path.c_str(), flags | O_WRONLY, 0644);}
+        if (fd_ < 0) {return;}
+
+        auto buffer_count = std::max(options.buffer_count, 1);
+
+        for (int i = 0; i < buffer_count; ++i)
+        {
+            buffers_.emplace_back(static_cast<char*>(std::aligned_alloc(block_size, buffer_size_)));
+            free_buffers_.push_back(buffer_count - 1 - i);
+
+            // Without a backend to write through, the file can only be closed again
+            if (!buffers_.back())
+            {
+                ::close(fd_);
+                fd_ = -1;
+                return;
+            }
+        }
+
+        requests_.resize(buffers_.size());
+
+        current_ = free_buffers_.back();
+        free_buffers_.pop_back();
+
+        if (append)
+        {
+            offset_ = ::lseek(fd_, 0, SEEK_END);
+
+            if (offset_ < 0)
+            {
+                ::close(fd_);
+                fd_ = -1;
+                return;
+            }
+
+            // Start from the beginning of the last block, which must be written again whole
+            if (direct_ && offset_ % static_cast<off_t>(block_size) != 0)
+            {
+                fill_ = static_cast<std::size_t>(offset_ % static_cast<off_t>(block_size));
+                offset_ -= static_cast<off_t>(fill_);
+
+                if (::pread(fd_, buffers_[current_].get(), block_size, offset_) < 0)
+                {
+                    failed_ = true;
+                }
+            }
+        }
+
+#ifdef LJ_HAVE_IO_URING
+        if (options.use_io_uring)
+        {
+            backend_ = UringBackend::create(fd_, static_cast<unsigned>(buffer_count));
+            io_uring_ = backend_ != nullptr;
+        }
+#endif
+
+        if (!backend_) {backend_ = std::make_unique<ThreadBackend>(fd_);}
+    }
+
+    void AsyncFileSink::File::submit_(int buffer, std::size_t size)
+    {
+        requests_[buffer] = {buffers_[buffer].get(), size, offset_};
+        backend_->submit(buffer, buffers_[buffer].get(), size, offset_);
+        ++in_flight_;
+    }
+
+    void AsyncFileSink::File::rotate_()
+    {
+        submit_(current_, fill_);
+        offset_ += static_cast<off_t>(fill_);
+        fill_ = 0;
+
+        if (free_buffers_.empty()) {reap_();}
+
+        current_ = free_buffers_.back();
+        free_buffers_.pop_back();
+    }
+
+    void AsyncFileSink::File::reap_()
+    {
+        auto completion = backend_->wait();
+        --in_flight_;
+
+        // If the write was cut short or failed (e.g. the kernel does not support this io_uring
+        // operation), write the rest ourselves
+        auto request = requests_[completion.buffer];
+        auto written = static_cast<std::size_t>(std::max(completion.result, 0L));
+
+        if (written < request.size)
+        {
+            auto result = pwrite_all(
+                fd_,
+                request.data + written,
+                request.size - written,
+                request.offset + static_cast<off_t>(written)
+            );
+
+            if (result < 0) {failed_ = true;}
+        }
+
+        free_buffers_.push_back(completion.buffer);
+    }
+
+    std::streamsize AsyncFileSink::File::write(const char* data, std::streamsize size)
+    {
+        if (fd_ < 0 || failed_) {return -1;}
+
+        auto remaining = static_cast<std::size_t>(size);
+
+        while (remaining > 0)
+        {
+            auto count = std::min(remaining, buffer_size_ - fill_);
+            std::memcpy(buffers_[current_].get() + fill_, data, count);
+
+            fill_ += count;
+            data += count;
+            remaining -= count;
+
+            if (fill_ == buffer_size_) {rotate_();}
+        }
+
+        return failed_ ? -1 : size;
+    }
+
+    bool AsyncFileSink::File::flush()
+    {
+        if (fd_ < 0) {return false;}
+
+        auto partial = fill_ % block_size;
+
+        if (!direct_ || partial == 0)
+        {
+            if (fill_ > 0) {rotate_();}
+            wait_all_();
+            return !failed_;
+        }
+
+        // Write the partial block padded with zeros, then cut the file back to its true size.
+        // We keep the partial block in the current buffer, to be written again later.
+        auto whole = fill_ - partial;
+        auto buffer = buffers_[current_].get();
+        std::memset(buffer + fill_, 0, block_size - partial);
+
+        submit_(current_, whole + block_size);
+        wait_all_();
+        std::erase(free_buffers_, current_);
+
+        if (::ftruncate(fd_, offset_ + static_cast<off_t>(fill_)) != 0) {failed_ = true;}
+
+        std::memmove(buffer, buffer + whole, partial);
+        offset_ += static_cast<off_t>(whole);
+        fill_ = partial;
+
+        return !failed_;
+    }
+
+    void AsyncFileSink::File::close()
+    {
+        if (fd_ < 0) {return;}
+
+        flush();
+        backend_.reset();
+
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    AsyncFileSink::AsyncFileSink(
+        const std::filesystem::path& path, std::ios::openmode mode, AsyncFileOptions options
+    )
+        : file_{std::make_shared<File>(path, mode, options)}
+    {}
+
+    std::streamsize AsyncFileSink::write(const char_type* data, std::streamsize size)
+    {
+        return file_->write(data, size);
+    }
+
+    bool AsyncFileSink::flush() {return file_->flush();}
+
+    void AsyncFileSink::close() {file_->close();}
+
+    bool AsyncFileSink::is_open() const {return file_->is_open();}
+
+    bool AsyncFileSink::using_io_uring() const {return file_->using_io_uring();}
+
+    bool AsyncFileSink::using_direct_io() const {return file_->using_direct_io();}
+} // namespace output
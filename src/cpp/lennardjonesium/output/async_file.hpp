@@ -0,0 +1,117 @@
+/**
+ * async_file.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_ASYNC_FILE_HPP
+#define LJ_ASYNC_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <ios>
+#include <memory>
+
+#include <boost/iostreams/categories.hpp>
+
+namespace output
+{
+    // How the log files of a Simulation are written
+    enum class FileBackend
+    {
+        standard,   // boost::iostreams::file_sink
+        async,      // AsyncFileSink
+        direct,     // AsyncFileSink, bypassing the page cache with O_DIRECT
+        memory      // No files at all: the logs are kept in memory (see MemoryLogs)
+    };
+
+    struct AsyncFileOptions
+    {
+        std::size_t buffer_size = std::size_t{1} << 20;     // Rounded up to the block size
+        int buffer_count = 4;                               // The number of buffers in flight
+        bool direct = false;                                // Open the file with O_DIRECT
+        bool use_io_uring = true;                           // If false, always use pwrite()
+    };
+
+    class AsyncFileSink
+    {
+        /**
+         * AsyncFileSink is a Boost.Iostreams Sink (so it can be used in place of
+         * boost::iostreams::file_sink) which writes a file in large buffers, without waiting for
+         * each write to complete before filling the next buffer.
+         * 
+         * The data is collected into one of buffer_count aligned buffers.  When a buffer is full,
+         * it is submitted to the kernel with io_uring, and writing continues in the next free
+         * buffer; we only wait when all of the buffers are in flight.  If io_uring is not
+         * available (e.g. on older kernels, or where it is disabled), a background thread
+         * calling pwrite() takes its place.
+         * 
+         * flush() submits whatever has been collected and waits for all writes to complete, so
+         * that afterward the file has its full size on disk (which the CheckpointSink relies on).
+         * 
+         * With O_DIRECT, writes must cover whole blocks, so a partial block is written padded
+         * with zeros and the file is then truncated to its true size; the partial block is kept
+         * and written again once more data arrives.  If the file system does not support
+         * O_DIRECT, the file is opened normally instead.
+         * 
+         * If the file cannot be opened, or a write fails, write() returns -1 (which sets the
+         * badbit of the stream), in the same way as for boost::iostreams::file_sink.
+         * 
+         * NOTE: Boost.Iostreams copies devices, so all copies share the same open file.
+         */
+
+        public:
+            using char_type = char;
+
+            struct category
+                : boost::iostreams::sink_tag,
+                  boost::iostreams::closable_tag,
+                  boost::iostreams::flushable_tag
+            {};
+
+            // Only std::ios::app is significant in the mode; otherwise the file is truncated
+            AsyncFileSink(
+                const std::filesystem::path& path,
+                std::ios::openmode mode = std::ios::out,
+                AsyncFileOptions options = {}
+            );
+
+            std::streamsize write(const char_type* data, std::streamsize size);
+            bool flush();
+            void close();
+
+            bool is_open() const;
+
+            // Whether the writes go through io_uring (rather than the pwrite() thread)
+            bool using_io_uring() const;
+
+            // Whether the file was opened with O_DIRECT
+            bool using_direct_io() const;
+
+            // The block size used for alignment
+            static constexpr std::size_t block_size = 4096;
+
+        private:
+            class File;
+            std::shared_ptr<File> file_;
+    };
+} // namespace output
+
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * checkpoint.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <lennardjonesium/tools/binary_stream.hpp>
+#include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+
+namespace output
+{
+    namespace
+    {
+        // Identifies the file type and format version
+        constexpr std::array<char, 8> checkpoint_magic{'L', 'J', 'C', 'K', 'P', 'T', '0', '1'};
+    }
+
+    std::optional<Checkpoint> read_checkpoint(const std::filesystem::path& checkpoint_path)
+    {
+        std::ifstream source{checkpoint_path, std::ios::binary};
+
+        if (!source) {return std::nullopt;}
+
+        tools::BinaryReader reader{source};
+
+        std::array<char, 8> magic{};
+        reader >> magic;
+
+        if (!reader.good() || magic != checkpoint_magic) {return std::nullopt;}
+
+        Checkpoint checkpoint;
+        std::uint64_t log_count{};
+
+        reader >> checkpoint.time_step >> checkpoint.prelude >> log_count;
+
+        for (std::uint64_t i = 0; i < log_count && reader.good(); ++i)
+        {
+            std::uintmax_t size{};
+            reader >> size;
+            checkpoint.log_sizes.push_back(size);
+        }
+
+        reader >> checkpoint.payload;
+
+        if (!reader.good()) {return std::nullopt;}
+
+        return checkpoint;
+    }
+
+    namespace
+    {
+        // Flush a file (or directory) to disk; fsync() needs a descriptor, which std::ofstream
+        // does not give us, so the file is opened again
+        void sync_to_disk(const std::filesystem::path& path, int flags)
+        {
+            int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+
+            if (fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), path.string());
+            }
+
+            int result = ::fsync(fd);
+            int error = errno;
+            ::close(fd);
+
+            if (result != 0)
+            {
+                throw std::system_error(error, std::generic_category(), path.string());
+            }
+        }
+    }
+
+    void CheckpointSink::write(int time_step, const CheckpointData& message)
+    {
+        auto temporary_path = checkpoint_path_;
+        temporary_path += ".tmp";
+
+        try
+        {
+            std::ofstream destination{temporary_path, std::ios::binary | std::ios::trunc};
+            tools::BinaryWriter writer{destination};
+
+            writer << checkpoint_magic << time_step << prelude_
+                << static_cast<std::uint64_t>(log_paths_.size());
+
+            for (const auto& log_path : log_paths_)
+            {
+                std::error_code error;
+                auto size = std::filesystem::file_size(log_path, error);
+                writer << (error ? std::uintmax_t{0} : size);
+            }
+
+            writer << message.payload;
+
+            destination.close();
+
+            // Never replace a good checkpoint with a damaged one
+            if (!destination)
+            {
+                throw std::system_error(
+                    std::make_error_code(std::errc::io_error),
+                    "Could not write " + temporary_path.string()
+                );
+            }
+
+            sync_to_disk(temporary_path, O_WRONLY);
+        }
+        catch (...)
+        {
+            std::error_code error;
+            std::filesystem::remove(temporary_path, error);
+            throw;
+        }
+
+        // The rename is only durable once the directory is synced
+        std::filesystem::rename(temporary_path, checkpoint_path_);
+
+        auto directory = checkpoint_path_.parent_path();
+        sync_to_disk(directory.empty() ? "." : directory, O_RDONLY | O_DIRECTORY);
+    }
+} // namespace output
@@ -0,0 +1,102 @@
+/**
+ * checkpoint.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_CHECKPOINT_HPP
+#define LJ_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <filesystem>
+
+#include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/sinks.hpp>
+
+namespace output
+{
+    struct Checkpoint
+    {
+        /**
+         * The contents of a checkpoint file:
+         * 
+         *  time_step:  The time step at which the checkpoint was taken.
+         * 
+         *  prelude:  A description of the simulation which wrote the checkpoint, supplied by the
+         *      owner of the Logger.  This is used to refuse resuming a different simulation.
+         * 
+         *  log_sizes:  The sizes of the log files at the moment the checkpoint was taken.  On
+         *      resume, the log files are truncated to these sizes, so that any output written
+         *      after the checkpoint (but before the run was killed) is not duplicated.
+         * 
+         *  payload:  The serialized state of the SimulationController.
+         */
+
+        int time_step;
+        std::string prelude;
+        std::vector<std::uintmax_t> log_sizes;
+        std::string payload;
+    };
+
+    // Read a checkpoint file; returns std::nullopt if the file is missing or not a valid checkpoint
+    std::optional<Checkpoint> read_checkpoint(const std::filesystem::path& checkpoint_path);
+
+    class CheckpointSink : public detail::MessageSink<CheckpointData>
+    {
+        /**
+         * CheckpointSink writes checkpoints to a file.  Since a checkpoint is only useful if it is
+         * complete, each one is written to a temporary file first, which is then renamed over the
+         * previous checkpoint.  The rename is atomic, so a run killed at any moment leaves behind
+         * either the old checkpoint or the new one.  The temporary file is synced to disk before
+         * the rename, and the directory after it, so that this also holds if the node crashes.
+         * 
+         * If the checkpoint cannot be written, write() throws std::system_error (leaving the
+         * previous checkpoint in place), and the Dispatcher records the failure in the event log.
+         * 
+         * The Dispatcher flushes all the other sinks before writing a checkpoint, so that the
+         * sizes of the log files recorded here correspond exactly to the messages logged before
+         * the checkpoint.
+         */
+
+        public:
+            virtual void write(int time_step, const CheckpointData& message) override;
+
+            CheckpointSink(
+                std::filesystem::path checkpoint_path,
+                std::vector<std::filesystem::path> log_paths,
+                std::string prelude
+            )
+                : checkpoint_path_{std::move(checkpoint_path)},
+                  log_paths_{std::move(log_paths)},
+                  prelude_{std::move(prelude)}
+            {}
+        
+        private:
+            std::filesystem::path checkpoint_path_;
+            std::vector<std::filesystem::path> log_paths_;
+            std::string prelude_;
+    };
+} // namespace output
+
+
+#endif
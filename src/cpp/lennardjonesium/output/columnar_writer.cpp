@@ -0,0 +1,83 @@
+/**
+ * columnar_writer.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <span>
+
+#include <lennardjonesium/output/columnar_writer.hpp>
+
+namespace output
+{
+    // The records are written in memory order, which is only the advertised format on
+    // little-endian machines
+    static_assert(std::endian::native == std::endian::little, "Columnar logs are little-endian");
+
+    void ColumnarWriter::write_header(std::span<const std::string_view> column_names)
+    {
+        std::string description = "TimeStep:<i8\n";
+        for (auto name : column_names)
+        {
+            description.append(name).append(":<f8\n");
+        }
+
+        std::uint64_t field_count = column_names.size() + 1;
+        std::uint64_t record_size = sizeof(std::int64_t) + column_names.size() * sizeof(double);
+
+        // Round the offset of the first record up to a multiple of 64
+        std::uint64_t data_offset = magic.size() + 3 * sizeof(std::uint64_t) + description.size();
+        data_offset = (data_offset + 63) / 64 * 64;
+
+        block_.insert(block_.end(), magic.begin(), magic.end());
+        append_(data_offset);
+        append_(record_size);
+        append_(field_count);
+        block_.insert(block_.end(), description.begin(), description.end());
+        block_.resize(data_offset, '\0');
+
+        flush();
+    }
+
+    void ColumnarWriter::write(int time_step, std::span<const double> values)
+    {
+        append_(static_cast<std::int64_t>(time_step));
+        for (double value : values) {append_(value);}
+
+        if (block_.size() >= block_size) {write_block_();}
+    }
+
+    void ColumnarWriter::flush()
+    {
+        write_block_();
+        destination_.flush();
+    }
+
+    void ColumnarWriter::write_block_()
+    {
+        destination_.write(block_.data(), static_cast<std::streamsize>(block_.size()));
+        block_.clear();
+    }
+} // namespace output
@@ -0,0 +1,103 @@
+/**
+ * columnar_writer.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_COLUMNAR_WRITER_HPP
+#define LJ_COLUMNAR_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+#include <initializer_list>
+#include <span>
+#include <vector>
+
+namespace output
+{
+    class ColumnarWriter
+    {
+        /**
+         * ColumnarWriter writes a table of fixed-width binary records, as an alternative to CSV
+         * for logs which are written on every time step.  Each record is an int64 time step
+         * followed by one float64 for each column, all little-endian.
+         * 
+         * The file begins with a self-describing header:
+         * 
+         *  bytes 0-7:      the magic string "LJCOLS01"
+         *  bytes 8-15:     uint64 offset of the first record (a multiple of 64)
+         *  bytes 16-23:    uint64 record size in bytes
+         *  bytes 24-31:    uint64 number of fields per record (including the time step)
+         *  bytes 32-:      one line "Name:<type>\n" per field, where the type is in NumPy's
+         *                  notation ("<i8" or "<f8"), then zero padding up to the first record
+         * 
+         * so that the records can be mapped directly with numpy.memmap (see the Python function
+         * lennardjonesium.tools.read_columnar_log()).
+         * 
+         * Records are collected into blocks in memory and written a block at a time.  A partial
+         * block is written on flush(), so the file is complete whenever the Sink is flushed.
+         */
+
+        public:
+            inline static constexpr std::string_view magic = "LJCOLS01";
+            inline static constexpr std::size_t block_size = std::size_t{1} << 16;
+
+            // Write the header for the given (floating-point) column names
+            void write_header(std::span<const std::string_view> column_names);
+
+            void write_header(std::initializer_list<std::string_view> column_names)
+            {
+                write_header(std::span{column_names.begin(), column_names.size()});
+            }
+
+            // Append a record to the current block
+            void write(int time_step, std::span<const double> values);
+
+            void write(int time_step, std::initializer_list<double> values)
+            {
+                write(time_step, std::span{values.begin(), values.size()});
+            }
+
+            // Write out the current block
+            void flush();
+
+            explicit ColumnarWriter(std::ostream& destination) : destination_{destination}
+            {
+                block_.reserve(block_size);
+            }
+
+        private:
+            std::ostream& destination_;
+            std::vector<char> block_;
+
+            void write_block_();
+
+            template<class T>
+            void append_(T value)
+            {
+                auto bytes = reinterpret_cast<const char*>(&value);
+                block_.insert(block_.end(), bytes, bytes + sizeof(T));
+            }
+    };
+} // namespace output
+
+
+#endif
@@ -21,60 +21,99 @@
  */
 
 #include <variant>
+#include <exception>
 
 #include <lennardjonesium/tools/overloaded_visitor.hpp>
 #include <lennardjonesium/output/log_message.hpp>
 #include <lennardjonesium/output/sinks.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
 #include <lennardjonesium/output/dispatcher.hpp>
 
 namespace output
 {
-    void Dispatcher::send(int time_step, LogMessage message)
+    void Dispatcher::send(int time_step, const LogMessage& message)
     {
         auto message_dispatcher = tools::OverloadedVisitor
         {
             // Events
-            [time_step, this](PhaseStartEvent message)
+            [time_step, this](const PhaseStartEvent& message)
             {
                 this->event_sink_.write(time_step, message);
             },
             
-            [time_step, this](AdjustTemperatureEvent message)
+            [time_step, this](const AdjustTemperatureEvent& message)
             {
                 this->event_sink_.write(time_step, message);
             },
             
-            [time_step, this](RecordObservationEvent message)
+            [time_step, this](const RecordObservationEvent& message)
             {
                 this->event_sink_.write(time_step, message);
             },
             
-            [time_step, this](PhaseCompleteEvent message)
+            [time_step, this](const PhaseCompleteEvent& message)
             {
                 this->event_sink_.write(time_step, message);
             },
             
-            [time_step, this](AbortSimulationEvent message)
+            [time_step, this](const PhaseSkippedEvent& message)
+            {
+                this->event_sink_.write(time_step, message);
+            },
+            
+            [time_step, this](const AbortSimulationEvent& message)
             {
                 this->event_sink_.write(time_step, message);
             },
             
             // Thermodynamics
-            [time_step, this](ThermodynamicData message)
+            [time_step, this](const ThermodynamicData& message)
+            {
+                this->thermodynamic_sink_.write(time_step, message);
+            },
+
+            [time_step, this](const ThermodynamicBlockData& message)
             {
                 this->thermodynamic_sink_.write(time_step, message);
             },
             
             // Observations
-            [time_step, this](ObservationData message)
+            [time_step, this](const ObservationData& message)
             {
                 this->observation_sink_.write(time_step, message);
             },
 
             // Snapshots
-            [time_step, this](SystemSnapshot message)
+            [time_step, this](const SystemSnapshot& message)
             {
                 this->snapshot_sink_.write(time_step, message);
+            },
+
+            // Trajectory
+            [time_step, this](const TrajectoryFrame& message)
+            {
+                if (this->trajectory_sink_ == nullptr) {return;}
+
+                this->trajectory_sink_->write(time_step, message);
+            },
+
+            // Checkpoints (flush first, so the recorded log sizes include everything before)
+            [time_step, this](const CheckpointData& message)
+            {
+                if (this->checkpoint_sink_ == nullptr) {return;}
+
+                this->flush_all();
+
+                try
+                {
+                    this->checkpoint_sink_->write(time_step, message);
+                }
+                catch (const std::exception& error)
+                {
+                    // The run can go on without this checkpoint, but it should say so
+                    this->event_sink_.write(time_step, CheckpointFailedEvent{error.what()});
+                }
             }
         };
 
@@ -25,6 +25,8 @@
 
 #include <lennardjonesium/output/log_message.hpp>
 #include <lennardjonesium/output/sinks.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
 
 namespace output
 {
@@ -36,32 +38,40 @@ namespace output
          */
 
         public:
-            void send(int time_step, LogMessage message);
+            void send(int time_step, const LogMessage& message);
 
             void flush_all()
             {
                 event_sink_.flush();
                 thermodynamic_sink_.flush();
                 observation_sink_.flush();
+                snapshot_sink_.flush();
+                if (trajectory_sink_ != nullptr) {trajectory_sink_->flush();}
             }
 
             Dispatcher(
                 EventSink& event_sink,
-                ThermodynamicSink& thermodynamic_sink,
-                ObservationSink& observation_sink,
-                SystemSnapshotSink& snapshot_sink
+                ThermodynamicDataSink& thermodynamic_sink,
+                DataSink<ObservationData>& observation_sink,
+                DataSink<SystemSnapshot>& snapshot_sink,
+                CheckpointSink* checkpoint_sink = nullptr,  // Checkpoints are optional
+                TrajectorySink* trajectory_sink = nullptr   // So is the trajectory
             )
                 : event_sink_{event_sink},
                   thermodynamic_sink_{thermodynamic_sink},
                   observation_sink_{observation_sink},
-                  snapshot_sink_{snapshot_sink}
+                  snapshot_sink_{snapshot_sink},
+                  checkpoint_sink_{checkpoint_sink},
+                  trajectory_sink_{trajectory_sink}
             {}
 
         private:
             EventSink& event_sink_;
-            ThermodynamicSink& thermodynamic_sink_;
-            ObservationSink& observation_sink_;
-            SystemSnapshotSink& snapshot_sink_;
+            ThermodynamicDataSink& thermodynamic_sink_;
+            DataSink<ObservationData>& observation_sink_;
+            DataSink<SystemSnapshot>& snapshot_sink_;
+            CheckpointSink* checkpoint_sink_;
+            TrajectorySink* trajectory_sink_;
     };
 } // namespace output
 
@@ -0,0 +1,188 @@
+/**
+ * io_service.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <lennardjonesium/tools/cpu_topology.hpp>
+#include <lennardjonesium/output/logger.hpp>
+#include <lennardjonesium/output/io_service.hpp>
+
+namespace output
+{
+    IOService::IOService(int thread_count, std::vector<std::vector<int>> cpu_sets)
+    {
+        assert(thread_count > 0 && "IOService needs at least one thread");
+
+        for (int i = 0; i < thread_count; ++i)
+        {
+            auto& writer = *writers_.emplace_back(std::make_unique<Writer>());
+
+            if (!cpu_sets.empty()) {writer.cpus = cpu_sets[i % cpu_sets.size()];}
+
+            writer.thread = std::thread(run_, std::ref(writer));
+        }
+    }
+
+    IOService::~IOService() noexcept
+    {
+        for (auto& writer : writers_)
+        {
+            {
+                std::lock_guard<std::mutex> lock(writer->mutex);
+                assert(writer->loggers.empty() && "IOService destroyed while Loggers are open");
+                writer->stopping = true;
+            }
+
+            writer->update_signal.notify_one();
+        }
+
+        for (auto& writer : writers_)
+        {
+            if (writer->thread.joinable()) {writer->thread.join();}
+        }
+    }
+
+    int IOService::default_thread_count()
+    {
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 8);
+    }
+
+    IOService::Writer& IOService::attach_(Logger& logger)
+    {
+        // Choose the Writer with the fewest Loggers
+        Writer* chosen = nullptr;
+        std::size_t fewest = 0;
+
+        for (auto& writer : writers_)
+        {
+            std::lock_guard<std::mutex> lock(writer->mutex);
+
+            if (chosen == nullptr || writer->loggers.size() < fewest)
+            {
+                chosen = writer.get();
+                fewest = writer->loggers.size();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(chosen->mutex);
+            chosen->loggers.push_back(&logger);
+        }
+
+        chosen->update_signal.notify_one();
+
+        return *chosen;
+    }
+
+    void IOService::detach_(Writer& writer, Logger& logger)
+    {
+        std::unique_lock<std::mutex> lock(writer.mutex);
+
+        writer.update_signal.notify_one();
+
+        // The Writer removes the Logger once it has written everything
+        writer.finished_signal.wait(
+            lock,
+            [&writer, &logger]() {
+                return std::ranges::find(writer.loggers, &logger) == writer.loggers.end();
+            }
+        );
+    }
+
+    void IOService::run_(Writer& writer)
+    {
+#ifdef __linux__
+        // On Linux, the nice value can be set per thread
+        setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 10);
+#endif
+
+        if (!writer.cpus.empty()) {tools::pin_this_thread(writer.cpus);}
+
+        std::unique_lock<std::mutex> lock(writer.mutex);
+
+        while (true)
+        {
+            if (writer.loggers.empty())
+            {
+                if (writer.stopping) {return;}
+
+                writer.update_signal.wait(lock);
+                continue;
+            }
+
+            // Loggers may be attached while we work, so work on a copy of the list
+            auto loggers = writer.loggers;
+            lock.unlock();
+
+            bool busy = false;
+            std::vector<Logger*> finished;
+
+            for (auto logger : loggers)
+            {
+                switch (logger->poll_())
+                {
+                    case Logger::PollResult::busy:
+                        busy = true;
+                        break;
+
+                    case Logger::PollResult::finished:
+                        finished.push_back(logger);
+                        break;
+
+                    case Logger::PollResult::idle:
+                        break;
+                }
+            }
+
+            lock.lock();
+
+            if (!finished.empty())
+            {
+                // After this, we must not touch these Loggers again
+                std::erase_if(
+                    writer.loggers,
+                    [&finished](Logger* logger) {
+                        return std::ranges::find(finished, logger) != finished.end();
+                    }
+                );
+
+                writer.finished_signal.notify_all();
+            }
+            else if (!busy)
+            {
+                writer.update_signal.wait_for(lock, poll_interval);
+            }
+        }
+    }
+} // namespace output
@@ -0,0 +1,103 @@
+/**
+ * io_service.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_IO_SERVICE_HPP
+#define LJ_IO_SERVICE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace output
+{
+    class Logger;
+
+    class IOService
+    {
+        /**
+         * IOService is a small set of writer threads which do the file output for many Loggers
+         * at once, so that a batch of simulations running side by side (e.g. in a
+         * SimulationPool) does not need a consumer thread for every Logger.
+         * 
+         * Each Logger still has its own message buffer and its own Sinks.  A Logger which is
+         * given an IOService is attached to one of the writer threads (whichever has the fewest
+         * Loggers), and that thread takes turns writing out everything that is waiting in each
+         * of its Loggers' buffers.  Since a writer sees a whole batch of messages at a time,
+         * the output for each file is written in large pieces rather than message by message.
+         * When a writer finds nothing to do, it sleeps for poll_interval.
+         * 
+         * The writer threads run at a lower scheduling priority (where this is supported), so
+         * that they do not take time away from the simulations.  They can also be pinned to sets
+         * of CPUs (e.g. the NUMA nodes of a tools::CpuTopology), the ith writer to the ith set,
+         * wrapping around if there are fewer sets than writers.
+         * 
+         * NOTE: Every Logger attached to the IOService must be closed (or destroyed) before the
+         * IOService is destroyed.
+         */
+
+        public:
+            explicit IOService(
+                int thread_count = default_thread_count(),
+                std::vector<std::vector<int>> cpu_sets = {}
+            );
+
+            // Stops the writer threads once all of their Loggers have closed
+            ~IOService() noexcept;
+
+            int thread_count() const {return static_cast<int>(writers_.size());}
+
+            // One writer thread for every 8 hardware threads
+            static int default_thread_count();
+
+            static constexpr std::chrono::milliseconds poll_interval{1};
+
+        private:
+            friend class Logger;
+
+            struct Writer
+            {
+                std::mutex mutex;
+                std::condition_variable update_signal;      // Wakes the writer thread
+                std::condition_variable finished_signal;    // Wakes Loggers waiting to close
+                std::vector<Logger*> loggers;
+                bool stopping = false;
+                std::vector<int> cpus;      // Empty if the thread is not pinned
+                std::thread thread;
+            };
+
+            std::vector<std::unique_ptr<Writer>> writers_;
+
+            // The main loop of a writer thread
+            static void run_(Writer& writer);
+
+            // Used by the Logger: attach_() returns the Writer which will serve it, and detach_()
+            // waits until the Writer has written everything and let go of the Logger
+            Writer& attach_(Logger& logger);
+            void detach_(Writer& writer, Logger& logger);
+    };
+} // namespace output
+
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * log_compression.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+
+#include <lennardjonesium/output/log_compression.hpp>
+
+namespace output
+{
+    namespace
+    {
+        constexpr std::array<unsigned char, 2> gzip_magic{0x1f, 0x8b};
+        constexpr std::array<unsigned char, 4> zstd_magic{0x28, 0xb5, 0x2f, 0xfd};
+
+        using head_type = std::array<unsigned char, 4>;
+
+        template<std::size_t N>
+        bool starts_with(const head_type& head, const std::array<unsigned char, N>& magic)
+        {
+            return std::equal(magic.begin(), magic.end(), head.begin());
+        }
+    }
+
+    void push_compressor(boost::iostreams::filtering_ostream& stream, LogCompression compression)
+    {
+        switch (compression)
+        {
+            case LogCompression::none:
+                break;
+
+            case LogCompression::gzip:
+                stream.push(boost::iostreams::gzip_compressor{});
+                break;
+
+            case LogCompression::zstd:
+                stream.push(boost::iostreams::zstd_compressor{});
+                break;
+        }
+    }
+
+    void push_decompressor(boost::iostreams::filtering_istream& stream, LogCompression compression)
+    {
+        switch (compression)
+        {
+            case LogCompression::none:
+                break;
+
+            case LogCompression::gzip:
+                stream.push(boost::iostreams::gzip_decompressor{});
+                break;
+
+            case LogCompression::zstd:
+                stream.push(boost::iostreams::zstd_decompressor{});
+                break;
+        }
+    }
+
+    LogCompression detect_compression(const std::filesystem::path& path)
+    {
+        head_type head{};
+        std::ifstream file{path, std::ios::binary};
+        file.read(reinterpret_cast<char*>(head.data()), head.size());
+
+        if (file.gcount() >= static_cast<std::streamsize>(gzip_magic.size())
+            && starts_with(head, gzip_magic))
+        {
+            return LogCompression::gzip;
+        }
+
+        if (file.gcount() >= static_cast<std::streamsize>(zstd_magic.size())
+            && starts_with(head, zstd_magic))
+        {
+            return LogCompression::zstd;
+        }
+
+        return LogCompression::none;
+    }
+} // namespace output
@@ -0,0 +1,60 @@
+/**
+ * log_compression.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_LOG_COMPRESSION_HPP
+#define LJ_LOG_COMPRESSION_HPP
+
+#include <filesystem>
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+namespace output
+{
+    /**
+     * The text logs (thermodynamics, observations and snapshots) can be compressed as they are
+     * written, by a Boost.Iostreams filter placed in front of the file.  Both formats are
+     * streaming formats, so the file is a single compressed stream which standard tools (gzip,
+     * zstd, Python's gzip module, or pandas) can read.
+     * 
+     * A compressed log cannot be cut back to a given size, so it cannot be combined with
+     * checkpoints.
+     */
+    enum class LogCompression
+    {
+        none,
+        gzip,   // Slower, but readable by the Python standard library
+        zstd    // Faster, and compresses better
+    };
+
+    // Push the compressor for the given LogCompression onto the stream (nothing for none)
+    void push_compressor(boost::iostreams::filtering_ostream& stream, LogCompression compression);
+
+    // Push the decompressor for the given LogCompression onto the stream (nothing for none)
+    void push_decompressor(boost::iostreams::filtering_istream& stream, LogCompression compression);
+
+    // Recognize a compressed file by its magic number.  Anything else (including a missing or
+    // empty file) is taken to be uncompressed.
+    LogCompression detect_compression(const std::filesystem::path& path);
+} // namespace output
+
+
+#endif
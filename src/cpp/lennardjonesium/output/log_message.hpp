@@ -23,13 +23,16 @@
 #ifndef LJ_LOG_MESSAGE_HPP
 #define LJ_LOG_MESSAGE_HPP
 
+#include <memory>
 #include <string>
 #include <variant>
 
 #include <Eigen/Dense>
 
 #include <lennardjonesium/physics/measurements.hpp>
+#include <lennardjonesium/physics/analyzers.hpp>
 #include <lennardjonesium/physics/observation.hpp>
+#include <lennardjonesium/physics/observation_statistics.hpp>
 #include <lennardjonesium/physics/system_state.hpp>
 
 namespace output
@@ -58,6 +61,11 @@ namespace output
         std::string name;
     };
 
+    struct PhaseSkippedEvent
+    {
+        std::string name;
+    };
+
     struct AbortSimulationEvent
     {
         std::string reason;
@@ -68,6 +76,17 @@ namespace output
         physics::ThermodynamicMeasurement::Result data;
     };
 
+    struct ThermodynamicBlockData
+    {
+        /**
+         * The statistics of a block of time steps, logged in place of the individual time steps
+         * (see control::ThermodynamicLogPolicy).  The block is held by pointer, so that the
+         * LogMessage variant does not grow.
+         */
+
+        std::unique_ptr<physics::ThermodynamicBlock> data;
+    };
+
     struct ObservationData
     {
         physics::Observation data;
@@ -86,16 +105,65 @@ namespace output
         Eigen::Matrix4Xd forces;
     };
 
+    struct TrajectoryFrame
+    {
+        /**
+         * A frame of the trajectory, which is recorded periodically during the simulation (unlike
+         * the SystemSnapshot, which is only recorded at the end).  The forces are left out, since
+         * they can be recomputed from the positions.
+         */
+
+        double time;
+        Eigen::Matrix4Xd positions;
+        Eigen::Matrix4Xd velocities;
+    };
+
+    struct CheckpointData
+    {
+        /**
+         * The serialized state of the SimulationController.  It is opaque to the output library;
+         * the CheckpointSink only wraps it with enough information to restore the log files to
+         * the same point.
+         */
+
+        std::string payload;
+    };
+
     using LogMessage = std::variant<
         PhaseStartEvent,
         AdjustTemperatureEvent,
         RecordObservationEvent,
         PhaseCompleteEvent,
+        PhaseSkippedEvent,
         AbortSimulationEvent,
         ThermodynamicData,
+        ThermodynamicBlockData,
         ObservationData,
-        SystemSnapshot
+        SystemSnapshot,
+        TrajectoryFrame,
+        CheckpointData
     >;
+
+    struct ReplicaObservationData
+    {
+        /**
+         * The combined Observations of several independent replicas.  This is not part of the
+         * LogMessage variant, because it is only written once all the replicas have finished,
+         * rather than during the simulation.
+         */
+
+        physics::ObservationStatistics statistics;
+    };
+
+    struct CheckpointFailedEvent
+    {
+        /**
+         * Written by the Dispatcher itself when a checkpoint could not be written, so that a run
+         * which is not actually checkpointing does not go unnoticed.
+         */
+
+        std::string reason;
+    };
 } // namespace output
 
 
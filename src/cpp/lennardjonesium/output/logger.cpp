@@ -22,60 +22,174 @@
 
 #include <iostream>
 #include <utility>
+#include <memory>
 #include <thread>
+#include <optional>
+#include <variant>
 
-#include <lennardjonesium/tools/message_buffer.hpp>
+#include <lennardjonesium/tools/spsc_ring.hpp>
+#include <lennardjonesium/tools/object_pool.hpp>
+#include <lennardjonesium/tools/overloaded_visitor.hpp>
 #include <lennardjonesium/output/log_message.hpp>
 #include <lennardjonesium/output/sinks.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
 #include <lennardjonesium/output/dispatcher.hpp>
+#include <lennardjonesium/output/io_service.hpp>
 #include <lennardjonesium/output/logger.hpp>
 
 namespace output
 {
-    Logger::Logger(Logger::Streams streams)
+    Logger::Logger(Logger::Streams streams) : Logger(streams, std::nullopt) {}
+
+    Logger::Logger(
+        Logger::Streams streams,
+        std::optional<CheckpointSink> checkpoint_sink,
+        bool resume
+    )
+        : Logger(streams, std::move(checkpoint_sink), resume, std::nullopt)
+    {}
+
+    Logger::Logger(
+        Logger::Streams streams,
+        std::optional<CheckpointSink> checkpoint_sink,
+        bool resume,
+        std::optional<TrajectorySink> trajectory_sink
+    )
+        : Logger(
+            streams, std::move(checkpoint_sink), resume, std::move(trajectory_sink), nullptr
+        )
+    {}
+
+    Logger::Logger(
+        Logger::Streams streams,
+        std::optional<CheckpointSink> checkpoint_sink,
+        bool resume,
+        std::optional<TrajectorySink> trajectory_sink,
+        IOService* io_service,
+        tools::BackpressurePolicy backpressure
+    )
         : event_sink_{streams.event_log},
-          thermodynamic_sink_{streams.thermodynamic_log},
-          observation_sink_{streams.observation_log},
-          snapshot_sink_{streams.snapshot_log}
+          thermodynamic_sink_{
+              make_thermodynamic_sink(
+                  streams.thermodynamic_log,
+                  streams.thermodynamic_log_format,
+                  streams.thermodynamic_log_aggregated
+              )
+          },
+          observation_sink_{
+              make_observation_sink(streams.observation_log, streams.observation_log_format)
+          },
+          snapshot_sink_{make_snapshot_sink(streams.snapshot_log, streams.snapshot_log_format)},
+          checkpoint_sink_{std::move(checkpoint_sink)},
+          trajectory_sink_{std::move(trajectory_sink)},
+          dispatcher_{
+              event_sink_,
+              *thermodynamic_sink_,
+              *observation_sink_,
+              *snapshot_sink_,
+              checkpoint_sink_ ? &checkpoint_sink_.value() : nullptr,
+              trajectory_sink_ ? &trajectory_sink_.value() : nullptr
+          },
+          buffer_{buffer_capacity, backpressure},
+          io_service_{io_service}
     {
-        // Initialize the log files
-        event_sink_.write_header();
-        thermodynamic_sink_.write_header();
-        observation_sink_.write_header();
-        snapshot_sink_.write_header();
+        // Initialize the log files, unless we are appending to existing ones
+        if (!resume)
+        {
+            event_sink_.write_header();
+            thermodynamic_sink_->write_header();
+            observation_sink_->write_header();
+            snapshot_sink_->write_header();
+            if (trajectory_sink_) {trajectory_sink_->write_header();}
+        }
 
         event_sink_.flush();
-        thermodynamic_sink_.flush();
-        observation_sink_.flush();
-        snapshot_sink_.flush();
+        thermodynamic_sink_->flush();
+        observation_sink_->flush();
+        snapshot_sink_->flush();
+        if (trajectory_sink_) {trajectory_sink_->flush();}
+
+        if (io_service_ != nullptr)
+        {
+            writer_ = &io_service_->attach_(*this);
+            return;
+        }
 
         // Start the consumer thread
         consumer_ = std::thread(
             [this]() {
-                Dispatcher dispatcher{
-                    this->event_sink_,
-                    this->thermodynamic_sink_,
-                    this->observation_sink_,
-                    this->snapshot_sink_
-                };
-
-                auto dispatch = [&dispatcher](message_type message)
+                // Take all of the messages that are waiting at once
+                auto dispatch = [this](message_type&& message)
                 {
-                    auto [time_step, log_message] = message;
-                    dispatcher.send(time_step, log_message);
+                    this->dispatch_(std::move(message));
                 };
 
-                // while (this->buffer_.get_and(dispatch));
-
-                while (auto o = this->buffer_.get()) {dispatch(o.value());}
+                while (this->buffer_.drain(dispatch));
 
-                dispatcher.flush_all();
+                this->finish_();
             }
         );
     }
 
+    void Logger::dispatch_(message_type&& message)
+    {
+        auto& [time_step, log_message] = message;
+        dispatcher_.send(time_step, log_message);
+
+        auto recycler = tools::OverloadedVisitor
+        {
+            [this](TrajectoryFrame& frame) {this->frame_pool_.recycle(std::move(frame));},
+            [this](SystemSnapshot& snapshot) {this->snapshot_pool_.recycle(std::move(snapshot));},
+            [](auto& other [[maybe_unused]]) {}
+        };
+
+        std::visit(recycler, log_message);
+    }
+
+    void Logger::finish_()
+    {
+        if (trajectory_sink_) {trajectory_sink_->write_index();}
+
+        dispatcher_.flush_all();
+    }
+
+    Logger::PollResult Logger::poll_()
+    {
+        // Check whether the buffer is closed first, so that if it is, everything that was put
+        // before it was closed is taken by try_drain()
+        bool closed = buffer_.closed();
+
+        auto dispatch = [this](message_type&& message) {this->dispatch_(std::move(message));};
+
+        // Take at most one buffer's worth, so the other Loggers get their turn
+        if (buffer_.try_drain(dispatch, buffer_capacity) > 0) {return PollResult::busy;}
+
+        if (closed)
+        {
+            finish_();
+            return PollResult::finished;
+        }
+
+        return PollResult::idle;
+    }
+
     void Logger::close()
     {
+        // If we are attached to an IOService, close the buffer and wait for the IOService to
+        // finish writing it
+        if (io_service_ != nullptr)
+        {
+            if (!closed_)
+            {
+                buffer_.close();
+                io_service_->detach_(*writer_, *this);
+                closed_ = true;
+            }
+
+            return;
+        }
+
         // If consumer thread is running, then close the buffer
         // and wait for consumer thread to finish
 
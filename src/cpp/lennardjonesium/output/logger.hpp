@@ -23,13 +23,22 @@
 #ifndef LJ_LOGGER_HPP
 #define LJ_LOGGER_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <utility>
+#include <memory>
 #include <thread>
+#include <optional>
 
-#include <lennardjonesium/tools/message_buffer.hpp>
+#include <lennardjonesium/tools/spsc_ring.hpp>
+#include <lennardjonesium/tools/object_pool.hpp>
 #include <lennardjonesium/output/log_message.hpp>
 #include <lennardjonesium/output/sinks.hpp>
+#include <lennardjonesium/output/checkpoint.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
+#include <lennardjonesium/output/dispatcher.hpp>
+#include <lennardjonesium/output/io_service.hpp>
 
 namespace output
 {
@@ -45,6 +54,9 @@ namespace output
          * The Logger accepts std::ostream& arguments to its constructor; the caller is responsible
          * for configuring these streams and making sure they point to opened files.  The caller
          * is also responsible for closing the streams afterward.
+         * 
+         * By default, the Logger writes its files from a consumer thread of its own.  If it is
+         * given an IOService, then the IOService's writer threads do this instead.
          */
 
         public:
@@ -54,13 +66,65 @@ namespace output
                 std::ostream& thermodynamic_log;
                 std::ostream& observation_log;
                 std::ostream& snapshot_log;
+
+                // The thermodynamic, observation, and snapshot logs may be written as CSV or binary
+                LogFormat thermodynamic_log_format = LogFormat::csv;
+                LogFormat observation_log_format = LogFormat::csv;
+                LogFormat snapshot_log_format = LogFormat::csv;
+
+                // Whether the thermodynamic log has the aggregated layout (see
+                // ThermodynamicDataSink), because some phase logs blocks of time steps
+                bool thermodynamic_log_aggregated = false;
             };
 
             Logger(Streams);
 
-            // Used by producer thread to send log messages, which will be dispatched to the
-            // appropriate destination
-            void log(int time_step, LogMessage message) {buffer_.put({time_step, message});}
+            // A Logger may also write checkpoints.  When resuming from a checkpoint, the streams
+            // already contain their headers, so these are not written again.
+            Logger(Streams, std::optional<CheckpointSink> checkpoint_sink, bool resume = false);
+
+            // A Logger may also write a trajectory.  Its index is written when the Logger closes.
+            Logger(
+                Streams,
+                std::optional<CheckpointSink> checkpoint_sink,
+                bool resume,
+                std::optional<TrajectorySink> trajectory_sink
+            );
+
+            // The files may be written by a shared IOService rather than by a thread of our own.
+            // The backpressure policy says what log() does when the consumer falls behind.
+            Logger(
+                Streams,
+                std::optional<CheckpointSink> checkpoint_sink,
+                bool resume,
+                std::optional<TrajectorySink> trajectory_sink,
+                IOService* io_service,
+                tools::BackpressurePolicy backpressure = tools::BackpressurePolicy::block
+            );
+
+            // Used by the producer thread to send log messages, which will be dispatched to the
+            // appropriate destination.  There must be only one producer thread.  If the consumer
+            // falls behind by more than buffer_capacity messages, log() waits for it, or discards
+            // the oldest waiting message, according to the backpressure policy.
+            void log(int time_step, LogMessage message)
+            {
+                buffer_.put({time_step, std::move(message)});
+            }
+
+            static constexpr std::size_t buffer_capacity = 1024;
+
+            tools::BackpressurePolicy backpressure() const {return buffer_.policy();}
+
+            // The number of messages discarded under BackpressurePolicy::drop_oldest
+            std::uint64_t dropped_messages() const {return buffer_.dropped();}
+
+            // Messages which carry the whole state of the system are recycled once they have been
+            // written, so the producer can fill these (by assigning to every member) instead of
+            // allocating new matrices each time.
+            TrajectoryFrame trajectory_frame() {return frame_pool_.acquire();}
+            SystemSnapshot system_snapshot() {return snapshot_pool_.acquire();}
+
+            static constexpr std::size_t pool_capacity = 8;
 
             // Call close() after producer threads are finished, this clears the message buffer
             // and terminates consumer thread (optional)
@@ -72,13 +136,36 @@ namespace output
         
         private:
             EventSink event_sink_;
-            ThermodynamicSink thermodynamic_sink_;
-            ObservationSink observation_sink_;
-            SystemSnapshotSink snapshot_sink_;
+            std::unique_ptr<ThermodynamicDataSink> thermodynamic_sink_;
+            std::unique_ptr<DataSink<ObservationData>> observation_sink_;
+            std::unique_ptr<DataSink<SystemSnapshot>> snapshot_sink_;
+            std::optional<CheckpointSink> checkpoint_sink_;
+            std::optional<TrajectorySink> trajectory_sink_;
+
+            tools::ObjectPool<TrajectoryFrame> frame_pool_{pool_capacity};
+            tools::ObjectPool<SystemSnapshot> snapshot_pool_{pool_capacity};
+
+            Dispatcher dispatcher_;
 
             using message_type = std::pair<int, LogMessage>;
-            tools::MessageBuffer<message_type> buffer_;
+            tools::SpscRing<message_type> buffer_;
+
+            // Either the consumer thread is running, or we are attached to an IOService
             std::thread consumer_;
+            IOService* io_service_ = nullptr;
+            IOService::Writer* writer_ = nullptr;
+            bool closed_ = false;
+
+            // Write a message, then return its storage if it is worth keeping
+            void dispatch_(message_type&& message);
+
+            // Write the trajectory index and flush everything, once all messages are written
+            void finish_();
+
+            // Used by the IOService to write whatever messages are waiting, without blocking
+            friend class IOService;
+            enum class PollResult {idle, busy, finished};
+            PollResult poll_();
     };
 } // namespace output
 
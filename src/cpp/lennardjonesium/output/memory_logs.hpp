@@ -0,0 +1,61 @@
+/**
+ * memory_logs.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_MEMORY_LOGS_HPP
+#define LJ_MEMORY_LOGS_HPP
+
+#include <memory>
+#include <vector>
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+
+namespace output
+{
+    struct MemoryLogs
+    {
+        /**
+         * The logs of a Simulation which keeps them in memory instead of writing files (see
+         * FileBackend::memory).  Each log is a contiguous buffer holding exactly what would have
+         * been written to the file.  The event log is text, and the thermodynamic, observation, and
+         * snapshot logs are always in the binary columnar format (see ColumnarWriter), so that
+         * they can be viewed as arrays without parsing or copying them.
+         * 
+         * The buffers are shared, so that a view of one of them (e.g. from Python) remains valid
+         * after the Simulation is run again, which starts new buffers.
+         */
+
+        using buffer_type = std::vector<char>;
+
+        std::shared_ptr<buffer_type> event_log = std::make_shared<buffer_type>();
+        std::shared_ptr<buffer_type> thermodynamic_log = std::make_shared<buffer_type>();
+        std::shared_ptr<buffer_type> observation_log = std::make_shared<buffer_type>();
+        std::shared_ptr<buffer_type> snapshot_log = std::make_shared<buffer_type>();
+    };
+
+    // A stream which appends to one of the buffers of MemoryLogs
+    using memory_log_device = boost::iostreams::back_insert_device<MemoryLogs::buffer_type>;
+    using MemoryLogStream = boost::iostreams::stream<memory_log_device>;
+} // namespace output
+
+
+#endif
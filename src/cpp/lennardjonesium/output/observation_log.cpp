@@ -0,0 +1,97 @@
+/**
+ * observation_log.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <vector>
+#include <string>
+#include <charconv>
+#include <filesystem>
+#include <system_error>
+
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/log_compression.hpp>
+#include <lennardjonesium/output/observation_log.hpp>
+
+namespace output
+{
+    namespace
+    {
+        // Parse one comma-separated field starting at first, and advance first past the comma
+        template<class T>
+        bool parse_field(const char*& first, const char* last, T& value)
+        {
+            auto [end, error] = std::from_chars(first, last, value);
+            if (error != std::errc{}) {return false;}
+
+            first = end;
+            if (first != last)
+            {
+                if (*first != ',') {return false;}
+                ++first;
+            }
+
+            return true;
+        }
+    }
+
+    std::vector<ObservationRecord> read_observation_log(const std::filesystem::path& log_path)
+    {
+        std::vector<ObservationRecord> records;
+        if (!std::filesystem::exists(log_path)) {return records;}
+
+        // The log may have been compressed as it was written
+        boost::iostreams::filtering_istream log;
+        push_decompressor(log, detect_compression(log_path));
+        log.push(boost::iostreams::file_source{log_path.string(), std::ios::binary});
+
+        std::string line;
+
+        // Skip the header
+        if (!std::getline(log, line)) {return records;}
+
+        while (std::getline(log, line))
+        {
+            const char* first = line.data();
+            const char* last = line.data() + line.size();
+
+            ObservationRecord record;
+            auto& o = record.observation.data;
+
+            std::array<double*, 6> fields{
+                &o.temperature, &o.density, &o.total_energy, &o.pressure, &o.specific_heat,
+                &o.diffusion_coefficient
+            };
+
+            bool valid = parse_field(first, last, record.time_step);
+            for (auto field : fields) {valid = valid && parse_field(first, last, *field);}
+
+            if (!valid || first != last) {break;}
+
+            records.push_back(record);
+        }
+
+        return records;
+    }
+} // namespace output
@@ -0,0 +1,49 @@
+/**
+ * observation_log.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_OBSERVATION_LOG_HPP
+#define LJ_OBSERVATION_LOG_HPP
+
+#include <vector>
+#include <filesystem>
+
+#include <lennardjonesium/output/log_message.hpp>
+
+namespace output
+{
+    struct ObservationRecord
+    {
+        int time_step;
+        ObservationData observation;
+    };
+
+    /**
+     * Read back an observation log written by the ObservationSink.  The values are printed in
+     * their shortest round-trip representation, so nothing is lost.  Rows which cannot be parsed
+     * (e.g. a partial last line) end the log; a missing file is an empty log.  A compressed log
+     * (see LogCompression) is decompressed transparently.
+     */
+    std::vector<ObservationRecord> read_observation_log(const std::filesystem::path& log_path);
+} // namespace output
+
+
+#endif
@@ -20,28 +20,33 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <array>
 #include <ranges>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
-// test
-#include <iostream>
-
-#include <fmt/core.h>
-#include <fmt/ostream.h>
+#include <fmt/format.h>
+#include <fmt/compile.h>
 
 #include <lennardjonesium/physics/system_state.hpp>
 #include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/columnar_writer.hpp>
 #include <lennardjonesium/output/sinks.hpp>
 
 namespace output
 {
     // The EventSink flushes after every message.  This should not be a problem, as Events are
-    // not very frequent.
+    // not very frequent.  The other text Sinks only write out their buffer when a block is full
+    // (see detail::SinkCommon).  The format strings are compiled, so they are not parsed again
+    // for every line.
 
-    void EventSink::write(int time_step, PhaseStartEvent message)
+    void EventSink::write(int time_step, const PhaseStartEvent& message)
     {
-        fmt::print(
-            destination_,
-            "{}: Phase started: {}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Phase started: {}\n"),
             time_step,
             message.name
         );
@@ -49,11 +54,11 @@ namespace output
         flush();
     }
 
-    void EventSink::write(int time_step, AdjustTemperatureEvent message)
+    void EventSink::write(int time_step, const AdjustTemperatureEvent& message)
     {
-        fmt::print(
-            destination_,
-            "{}: Temperature measured at: {:.4g}, adjusted to: {:.4g}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Temperature measured at: {:.4g}, adjusted to: {:.4g}\n"),
             time_step,
             message.measured_temperature,
             message.target_temperature
@@ -62,22 +67,34 @@ namespace output
         flush();
     }
     
-    void EventSink::write(int time_step, RecordObservationEvent message [[maybe_unused]])
+    void EventSink::write(int time_step, const RecordObservationEvent& message [[maybe_unused]])
     {
-        fmt::print(
-            destination_,
-            "{}: Observation recorded\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Observation recorded\n"),
             time_step
         );
 
         flush();
     }
     
-    void EventSink::write(int time_step, PhaseCompleteEvent message)
+    void EventSink::write(int time_step, const PhaseCompleteEvent& message)
     {
-        fmt::print(
-            destination_,
-            "{}: Phase complete: {}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Phase complete: {}\n"),
+            time_step,
+            message.name
+        );
+
+        flush();
+    }
+
+    void EventSink::write(int time_step, const PhaseSkippedEvent& message)
+    {
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Phase skipped: {}\n"),
             time_step,
             message.name
         );
@@ -85,11 +102,11 @@ namespace output
         flush();
     }
     
-    void EventSink::write(int time_step, AbortSimulationEvent message)
+    void EventSink::write(int time_step, const AbortSimulationEvent& message)
     {
-        fmt::print(
-            destination_,
-            "{}: Simulation aborted: {}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Simulation aborted: {}\n"),
             time_step,
             message.reason
         );
@@ -97,11 +114,108 @@ namespace output
         flush();
     }
 
+    void EventSink::write(int time_step, const CheckpointFailedEvent& message)
+    {
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{}: Checkpoint failed: {}\n"),
+            time_step,
+            message.reason
+        );
+
+        flush();
+    }
+
+    namespace
+    {
+        using Result = physics::ThermodynamicMeasurement::Result;
+
+        struct ThermodynamicQuantity
+        {
+            std::string_view name;
+            double Result::* value;
+        };
+
+        constexpr std::array<ThermodynamicQuantity, 7> thermodynamic_quantities{{
+            {"Time", &Result::time},
+            {"KineticEnergy", &Result::kinetic_energy},
+            {"PotentialEnergy", &Result::potential_energy},
+            {"TotalEnergy", &Result::total_energy},
+            {"Virial", &Result::virial},
+            {"Temperature", &Result::temperature},
+            {"MeanSquareDisplacement", &Result::mean_square_displacement}
+        }};
+
+        constexpr std::size_t aggregate_column_count = 1 + 4 * thermodynamic_quantities.size();
+
+        // The columns of the aggregated layout, after the TimeStep
+        std::vector<std::string> aggregate_column_names()
+        {
+            std::vector<std::string> names{"Samples"};
+
+            for (const auto& quantity : thermodynamic_quantities)
+            {
+                names.emplace_back(quantity.name);
+                names.push_back(fmt::format(FMT_COMPILE("{}Min"), quantity.name));
+                names.push_back(fmt::format(FMT_COMPILE("{}Max"), quantity.name));
+                names.push_back(fmt::format(FMT_COMPILE("{}Variance"), quantity.name));
+            }
+
+            return names;
+        }
+
+        std::array<double, aggregate_column_count> aggregate_row(
+            const physics::ThermodynamicBlock& block
+        )
+        {
+            std::array<double, aggregate_column_count> row;
+            auto column = row.begin();
+
+            *column++ = block.sample_count;
+
+            for (const auto& quantity : thermodynamic_quantities)
+            {
+                *column++ = block.mean.*quantity.value;
+                *column++ = block.minimum.*quantity.value;
+                *column++ = block.maximum.*quantity.value;
+                *column++ = block.variance.*quantity.value;
+            }
+
+            return row;
+        }
+
+        // A single measurement, in the aggregated layout
+        physics::ThermodynamicBlock single_sample_block(const Result& result)
+        {
+            return {
+                .sample_count = 1,
+                .mean = result,
+                .minimum = result,
+                .maximum = result,
+                .variance = {}
+            };
+        }
+    }
+
     void ThermodynamicSink::write_header()
     {
-        fmt::print(
-            destination_,
-            "{},{},{},{},{},{},{},{}\n",
+        if (aggregated_)
+        {
+            fmt::format_to(fmt::appender(buffer_), FMT_COMPILE("TimeStep"));
+
+            for (const auto& name : aggregate_column_names())
+            {
+                fmt::format_to(fmt::appender(buffer_), FMT_COMPILE(",{}"), name);
+            }
+
+            fmt::format_to(fmt::appender(buffer_), FMT_COMPILE("\n"));
+            end_line_();
+            return;
+        }
+
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{},{}\n"),
             "TimeStep",
             "Time",
             "KineticEnergy",
@@ -111,13 +225,20 @@ namespace output
             "Temperature",
             "MeanSquareDisplacement"
         );
+        end_line_();
     }
 
-    void ThermodynamicSink::write(int time_step, ThermodynamicData message)
+    void ThermodynamicSink::write(int time_step, const ThermodynamicData& message)
     {
-        fmt::print(
-            destination_,
-            "{},{},{},{},{},{},{},{}\n",
+        if (aggregated_)
+        {
+            write_aggregate_(time_step, single_sample_block(message.data));
+            return;
+        }
+
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{},{}\n"),
             time_step,
             message.data.time,
             message.data.kinetic_energy,
@@ -127,13 +248,105 @@ namespace output
             message.data.temperature,
             message.data.mean_square_displacement
         );
+        end_line_();
+    }
+
+    void ThermodynamicSink::write(int time_step, const ThermodynamicBlockData& message)
+    {
+        if (aggregated_)
+        {
+            write_aggregate_(time_step, *message.data);
+            return;
+        }
+
+        write(time_step, ThermodynamicData{message.data->mean});
+    }
+
+    void ThermodynamicSink::write_aggregate_(
+        int time_step, const physics::ThermodynamicBlock& block
+    )
+    {
+        fmt::format_to(fmt::appender(buffer_), FMT_COMPILE("{},{}"), time_step, block.sample_count);
+
+        for (const auto& quantity : thermodynamic_quantities)
+        {
+            fmt::format_to(
+                fmt::appender(buffer_),
+                FMT_COMPILE(",{},{},{},{}"),
+                block.mean.*quantity.value,
+                block.minimum.*quantity.value,
+                block.maximum.*quantity.value,
+                block.variance.*quantity.value
+            );
+        }
+
+        fmt::format_to(fmt::appender(buffer_), FMT_COMPILE("\n"));
+        end_line_();
+    }
+
+    void BinaryThermodynamicSink::write_header()
+    {
+        if (aggregated_)
+        {
+            auto names = aggregate_column_names();
+            std::vector<std::string_view> column_names(names.begin(), names.end());
+            writer_.write_header(column_names);
+            return;
+        }
+
+        writer_.write_header({
+            "Time",
+            "KineticEnergy",
+            "PotentialEnergy",
+            "TotalEnergy",
+            "Virial",
+            "Temperature",
+            "MeanSquareDisplacement"
+        });
+    }
+
+    void BinaryThermodynamicSink::write(int time_step, const ThermodynamicData& message)
+    {
+        if (aggregated_)
+        {
+            write_aggregate_(time_step, single_sample_block(message.data));
+            return;
+        }
+
+        writer_.write(time_step, {
+            message.data.time,
+            message.data.kinetic_energy,
+            message.data.potential_energy,
+            message.data.total_energy,
+            message.data.virial,
+            message.data.temperature,
+            message.data.mean_square_displacement
+        });
+    }
+
+    void BinaryThermodynamicSink::write(int time_step, const ThermodynamicBlockData& message)
+    {
+        if (aggregated_)
+        {
+            write_aggregate_(time_step, *message.data);
+            return;
+        }
+
+        write(time_step, ThermodynamicData{message.data->mean});
+    }
+
+    void BinaryThermodynamicSink::write_aggregate_(
+        int time_step, const physics::ThermodynamicBlock& block
+    )
+    {
+        writer_.write(time_step, aggregate_row(block));
     }
 
     void ObservationSink::write_header()
     {
-        fmt::print(
-            destination_,
-            "{},{},{},{},{},{},{}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{}\n"),
             "TimeStep",
             "Temperature",
             "Density",
@@ -142,13 +355,14 @@ namespace output
             "SpecificHeat",
             "DiffusionCoefficient"
         );
+        end_line_();
     }
 
-    void ObservationSink::write(int time_step, ObservationData message)
+    void ObservationSink::write(int time_step, const ObservationData& message)
     {
-        fmt::print(
-            destination_,
-            "{},{},{},{},{},{},{}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{}\n"),
             time_step,
             message.data.temperature,
             message.data.density,
@@ -157,37 +371,100 @@ namespace output
             message.data.specific_heat,
             message.data.diffusion_coefficient
         );
+        end_line_();
+    }
+
+    void BinaryObservationSink::write_header()
+    {
+        writer_.write_header({
+            "Temperature",
+            "Density",
+            "TotalEnergy",
+            "Pressure",
+            "SpecificHeat",
+            "DiffusionCoefficient"
+        });
+    }
+
+    void BinaryObservationSink::write(int time_step, const ObservationData& message)
+    {
+        writer_.write(time_step, {
+            message.data.temperature,
+            message.data.density,
+            message.data.total_energy,
+            message.data.pressure,
+            message.data.specific_heat,
+            message.data.diffusion_coefficient
+        });
+    }
+
+    void ReplicaObservationSink::write_header()
+    {
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n"),
+            "TimeStep",
+            "Temperature", "TemperatureError",
+            "Density", "DensityError",
+            "TotalEnergy", "TotalEnergyError",
+            "Pressure", "PressureError",
+            "SpecificHeat", "SpecificHeatError",
+            "DiffusionCoefficient", "DiffusionCoefficientError",
+            "Replicas"
+        );
+        end_line_();
+    }
+
+    void ReplicaObservationSink::write(int time_step, const ReplicaObservationData& message)
+    {
+        const auto& mean = message.statistics.mean;
+        const auto& error = message.statistics.standard_error;
+
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n"),
+            time_step,
+            mean.temperature, error.temperature,
+            mean.density, error.density,
+            mean.total_energy, error.total_energy,
+            mean.pressure, error.pressure,
+            mean.specific_heat, error.specific_heat,
+            mean.diffusion_coefficient, error.diffusion_coefficient,
+            message.statistics.replica_count
+        );
+        end_line_();
     }
 
     void SystemSnapshotSink::write_header()
     {
         // We set up two header rows for a multi-index Pandas dataframe
-        fmt::print(
-            destination_,
-            "{},{},{},{},{},{},{},{},{},{},{}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{},{},{},{},{}\n"),
             "TimeStep", "ParticleID",
             "Position", "Position", "Position",
             "Velocity", "Velocity", "Velocity",
             "Force", "Force", "Force"
         );
 
-        fmt::print(
-            destination_,
-            "{},{},{},{},{},{},{},{},{},{},{}\n",
+        fmt::format_to(
+            fmt::appender(buffer_),
+            FMT_COMPILE("{},{},{},{},{},{},{},{},{},{},{}\n"),
             "TimeStep", "ParticleID",
             "X", "Y", "Z",
             "X", "Y", "Z",
             "X", "Y", "Z"
         );
+        end_line_();
     }
 
-    void SystemSnapshotSink::write(int time_step, SystemSnapshot message)
+    void SystemSnapshotSink::write(int time_step, const SystemSnapshot& message)
     {
         for (int particle_id : std::views::iota(0, message.positions.cols()))
         {
-            fmt::print(
-                destination_,
-                "{},{},{},{},{},{},{},{},{},{},{}\n",
+            fmt::format_to(
+                fmt::appender(buffer_),
+                FMT_COMPILE("{},{},{},{},{},{},{},{},{},{},{}\n"),
                 time_step,
                 particle_id,
                 message.positions.col(particle_id).x(),
@@ -200,7 +477,70 @@ namespace output
                 message.forces.col(particle_id).y(),
                 message.forces.col(particle_id).z()
             );
+            end_line_();
         }
     }
-} // namespace output
 
+    void BinarySystemSnapshotSink::write_header()
+    {
+        writer_.write_header({
+            "PositionX", "PositionY", "PositionZ",
+            "VelocityX", "VelocityY", "VelocityZ",
+            "ForceX", "ForceY", "ForceZ"
+        });
+    }
+
+    void BinarySystemSnapshotSink::write(int time_step, const SystemSnapshot& message)
+    {
+        for (int particle_id : std::views::iota(0, message.positions.cols()))
+        {
+            writer_.write(time_step, {
+                message.positions.col(particle_id).x(),
+                message.positions.col(particle_id).y(),
+                message.positions.col(particle_id).z(),
+                message.velocities.col(particle_id).x(),
+                message.velocities.col(particle_id).y(),
+                message.velocities.col(particle_id).z(),
+                message.forces.col(particle_id).x(),
+                message.forces.col(particle_id).y(),
+                message.forces.col(particle_id).z()
+            });
+        }
+    }
+
+    std::unique_ptr<ThermodynamicDataSink> make_thermodynamic_sink(
+        std::ostream& destination, LogFormat format, bool aggregated
+    )
+    {
+        if (format == LogFormat::binary)
+        {
+            return std::make_unique<BinaryThermodynamicSink>(destination, aggregated);
+        }
+
+        return std::make_unique<ThermodynamicSink>(destination, aggregated);
+    }
+
+    std::unique_ptr<DataSink<ObservationData>> make_observation_sink(
+        std::ostream& destination, LogFormat format
+    )
+    {
+        if (format == LogFormat::binary)
+        {
+            return std::make_unique<BinaryObservationSink>(destination);
+        }
+
+        return std::make_unique<ObservationSink>(destination);
+    }
+
+    std::unique_ptr<DataSink<SystemSnapshot>> make_snapshot_sink(
+        std::ostream& destination, LogFormat format
+    )
+    {
+        if (format == LogFormat::binary)
+        {
+            return std::make_unique<BinarySystemSnapshotSink>(destination);
+        }
+
+        return std::make_unique<SystemSnapshotSink>(destination);
+    }
+} // namespace output
@@ -23,24 +23,44 @@
 #ifndef LJ_SINKS_HPP
 #define LJ_SINKS_HPP
 
+#include <cstddef>
 #include <concepts>
 #include <iostream>
+#include <memory>
+
+#include <fmt/format.h>
 
 #include <lennardjonesium/physics/system_state.hpp>
 #include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/columnar_writer.hpp>
 
 namespace detail
 {
     class SinkCommon
     {
+        /**
+         * The text Sinks format their lines into a buffer, which is handed to the destination
+         * stream a block at a time, rather than going through the std::ostream interface for
+         * every line.  A partial block is written on flush(), so the file is complete whenever
+         * the Sink is flushed.
+         */
+
         public:
+            inline static constexpr std::size_t block_size = std::size_t{1} << 16;
+
             virtual void write_header() = 0;
 
-            void flush() {destination_.flush();}
+            virtual void flush()
+            {
+                write_block_();
+                destination_.flush();
+            }
 
             SinkCommon() = default;
             explicit SinkCommon(std::ostream& destination) : destination_{destination} {}
 
+            SinkCommon(SinkCommon&&) = default;
+
             virtual ~SinkCommon() = default;
 
         protected:
@@ -49,13 +69,27 @@ namespace detail
              * open for the duration that the Sink is writing.
              */
             std::ostream& destination_ = std::cout;
+
+            // Lines are formatted into buffer_, and end_line_() writes it out once it is full
+            fmt::memory_buffer buffer_;
+
+            void end_line_()
+            {
+                if (buffer_.size() >= block_size) {write_block_();}
+            }
+
+            void write_block_()
+            {
+                destination_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+                buffer_.clear();
+            }
     };
 
     template<class MessageType>
     class MessageSink
     {
         public:
-            virtual void write(int time_step, MessageType message) = 0;
+            virtual void write(int time_step, const MessageType& message) = 0;
     };
 } // namespace detail
 
@@ -74,6 +108,12 @@ namespace output
      *  EventSink
      *  ThermodynamicSink
      *  ObservationSink
+     * 
+     * The ThermodynamicSink and ObservationSink write CSV files.  Since the thermodynamic log in
+     * particular can become very large, each of them has a binary alternative which writes a
+     * columnar file (see ColumnarWriter).  The two alternatives share a DataSink base class, so
+     * that the format can be chosen at run time.  The same goes for the SystemSnapshotSink, whose
+     * binary alternative is used when the logs are kept in memory (see MemoryLogs).
      */
 
     /**
@@ -89,6 +129,17 @@ namespace output
         && ... && std::derived_from<SinkType, detail::MessageSink<MessageTypes>>
     );
 
+    template<class MessageType>
+    class DataSink : public detail::SinkCommon, public detail::MessageSink<MessageType>
+    {
+        public:
+            DataSink() = default;
+            explicit DataSink(std::ostream& destination) : detail::SinkCommon{destination} {}
+    };
+
+    // File formats available for the DataSinks
+    enum class LogFormat {csv, binary};
+
     /**
      * EventSink will handle writing event messages to the events file, which gives a rough
      * summary of what happened during the simulation.
@@ -99,55 +150,157 @@ namespace output
           public detail::MessageSink<AdjustTemperatureEvent>,
           public detail::MessageSink<RecordObservationEvent>,
           public detail::MessageSink<PhaseCompleteEvent>,
-          public detail::MessageSink<AbortSimulationEvent>
+          public detail::MessageSink<PhaseSkippedEvent>,
+          public detail::MessageSink<AbortSimulationEvent>,
+          public detail::MessageSink<CheckpointFailedEvent>
     {
         public:
             // For the moment, the Events file has no header information
             virtual void write_header() override {}
 
-            virtual void write(int time_step, PhaseStartEvent message) override;
-            virtual void write(int time_step, AdjustTemperatureEvent message) override;
-            virtual void write(int time_step, RecordObservationEvent message) override;
-            virtual void write(int time_step, PhaseCompleteEvent message) override;
-            virtual void write(int time_step, AbortSimulationEvent message) override;
+            virtual void write(int time_step, const PhaseStartEvent& message) override;
+            virtual void write(int time_step, const AdjustTemperatureEvent& message) override;
+            virtual void write(int time_step, const RecordObservationEvent& message) override;
+            virtual void write(int time_step, const PhaseCompleteEvent& message) override;
+            virtual void write(int time_step, const PhaseSkippedEvent& message) override;
+            virtual void write(int time_step, const AbortSimulationEvent& message) override;
+            virtual void write(int time_step, const CheckpointFailedEvent& message) override;
 
             EventSink() = default;
             explicit EventSink(std::ostream& destination) : detail::SinkCommon{destination} {}
     };
 
+    /**
+     * The thermodynamic log has two layouts.  Normally each row is the measurement of a single
+     * time step.  If any phase logs blocks of time steps (see control::ThermodynamicLogPolicy),
+     * the log is aggregated instead:  each row gives the number of samples in the block, followed
+     * by the mean, minimum, maximum, and variance of each quantity over the block.  A single time
+     * step is then written as a block of one sample, so that every row has the same columns.
+     * (A block sent to a Sink which is not aggregated is written as its mean.)
+     */
+    class ThermodynamicDataSink
+        : public DataSink<ThermodynamicData>, public detail::MessageSink<ThermodynamicBlockData>
+    {
+        public:
+            using DataSink<ThermodynamicData>::write;
+            using detail::MessageSink<ThermodynamicBlockData>::write;
+
+            ThermodynamicDataSink() = default;
+
+            ThermodynamicDataSink(std::ostream& destination, bool aggregated)
+                : DataSink<ThermodynamicData>{destination}, aggregated_{aggregated}
+            {}
+
+        protected:
+            bool aggregated_ = false;
+    };
+
     /**
      * ThermodynamicSink will record the raw (instantaneous) thermodynamic measurements to a file,
      * which will allow us to re-analyze them later, if desired.
      */
-    class ThermodynamicSink
-        : public detail::SinkCommon, public detail::MessageSink<ThermodynamicData>
+    class ThermodynamicSink : public ThermodynamicDataSink
     {
         public:
             virtual void write_header() override;
 
-            virtual void write(int time_step, ThermodynamicData message) override;
+            virtual void write(int time_step, const ThermodynamicData& message) override;
+            virtual void write(int time_step, const ThermodynamicBlockData& message) override;
 
             ThermodynamicSink() = default;
 
-            explicit ThermodynamicSink(std::ostream& destination)
-                : detail::SinkCommon{destination}
+            explicit ThermodynamicSink(std::ostream& destination, bool aggregated = false)
+                : ThermodynamicDataSink{destination, aggregated}
+            {}
+
+        private:
+            void write_aggregate_(int time_step, const physics::ThermodynamicBlock& block);
+    };
+
+    /**
+     * BinaryThermodynamicSink records the same columns as the ThermodynamicSink, in binary.
+     */
+    class BinaryThermodynamicSink : public ThermodynamicDataSink
+    {
+        public:
+            virtual void write_header() override;
+
+            virtual void write(int time_step, const ThermodynamicData& message) override;
+            virtual void write(int time_step, const ThermodynamicBlockData& message) override;
+
+            virtual void flush() override {writer_.flush();}
+
+            explicit BinaryThermodynamicSink(std::ostream& destination, bool aggregated = false)
+                : ThermodynamicDataSink{destination, aggregated}, writer_{destination}
             {}
+
+        private:
+            ColumnarWriter writer_;
+
+            void write_aggregate_(int time_step, const physics::ThermodynamicBlock& block);
     };
 
     /**
      * ObservationSink will record the statistical-mechanical Observation results to a file.
      */
-    class ObservationSink
-        : public detail::SinkCommon, public detail::MessageSink<ObservationData>
+    class ObservationSink : public DataSink<ObservationData>
     {
         public:
             virtual void write_header() override;
 
-            virtual void write(int time_step, ObservationData message) override;
+            virtual void write(int time_step, const ObservationData& message) override;
 
             ObservationSink() = default;
             
             explicit ObservationSink(std::ostream& destination)
+                : DataSink<ObservationData>{destination}
+            {}
+    };
+
+    /**
+     * BinaryObservationSink records the same columns as the ObservationSink, in binary.
+     */
+    class BinaryObservationSink : public DataSink<ObservationData>
+    {
+        public:
+            virtual void write_header() override;
+
+            virtual void write(int time_step, const ObservationData& message) override;
+
+            virtual void flush() override {writer_.flush();}
+
+            explicit BinaryObservationSink(std::ostream& destination)
+                : DataSink<ObservationData>{destination}, writer_{destination}
+            {}
+
+        private:
+            ColumnarWriter writer_;
+    };
+
+    // Create the DataSink for the given format (and layout, for the thermodynamic log)
+    std::unique_ptr<ThermodynamicDataSink> make_thermodynamic_sink(
+        std::ostream& destination, LogFormat format, bool aggregated = false
+    );
+
+    std::unique_ptr<DataSink<ObservationData>> make_observation_sink(
+        std::ostream& destination, LogFormat format
+    );
+
+    /**
+     * ReplicaObservationSink records Observations combined across replicas, with a standard error
+     * column after each quantity, and the number of replicas which contributed to each row.
+     */
+    class ReplicaObservationSink
+        : public detail::SinkCommon, public detail::MessageSink<ReplicaObservationData>
+    {
+        public:
+            virtual void write_header() override;
+
+            virtual void write(int time_step, const ReplicaObservationData& message) override;
+
+            ReplicaObservationSink() = default;
+
+            explicit ReplicaObservationSink(std::ostream& destination)
                 : detail::SinkCommon{destination}
             {}
     };
@@ -158,20 +311,44 @@ namespace output
      * However, it can easily write any number of states, so is also suitable to use for the
      * trajectory output.
      */
-    class SystemSnapshotSink
-        : public detail::SinkCommon, public detail::MessageSink<SystemSnapshot>
+    class SystemSnapshotSink : public DataSink<SystemSnapshot>
     {
         public:
             virtual void write_header() override;
 
-            virtual void write(int time_step, SystemSnapshot message) override;
+            virtual void write(int time_step, const SystemSnapshot& message) override;
 
             SystemSnapshotSink() = default;
             
             explicit SystemSnapshotSink(std::ostream& destination)
-                : detail::SinkCommon{destination}
+                : DataSink<SystemSnapshot>{destination}
+            {}
+    };
+
+    /**
+     * BinarySystemSnapshotSink records one row per particle, in binary.  The ParticleID column is
+     * left out, since the particles of each snapshot are written in order.
+     */
+    class BinarySystemSnapshotSink : public DataSink<SystemSnapshot>
+    {
+        public:
+            virtual void write_header() override;
+
+            virtual void write(int time_step, const SystemSnapshot& message) override;
+
+            virtual void flush() override {writer_.flush();}
+
+            explicit BinarySystemSnapshotSink(std::ostream& destination)
+                : DataSink<SystemSnapshot>{destination}, writer_{destination}
             {}
+
+        private:
+            ColumnarWriter writer_;
     };
+
+    std::unique_ptr<DataSink<SystemSnapshot>> make_snapshot_sink(
+        std::ostream& destination, LogFormat format
+    );
 } // namespace output
 
 
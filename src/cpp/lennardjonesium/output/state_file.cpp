@@ -0,0 +1,99 @@
+/**
+ * state_file.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <optional>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include <lennardjonesium/tools/binary_stream.hpp>
+#include <lennardjonesium/tools/system_parameters.hpp>
+#include <lennardjonesium/physics/system_state.hpp>
+#include <lennardjonesium/output/state_file.hpp>
+
+namespace output
+{
+    namespace
+    {
+        // Identifies the file type and format version
+        constexpr std::array<char, 8> state_file_magic{'L', 'J', 'S', 'T', 'A', 'T', 'E', '1'};
+    }
+
+    std::optional<StateFile> read_state_file(const std::filesystem::path& state_path)
+    {
+        std::ifstream source{state_path, std::ios::binary};
+
+        if (!source) {return std::nullopt;}
+
+        tools::BinaryReader reader{source};
+
+        std::array<char, 8> magic{};
+        reader >> magic;
+
+        if (!reader.good() || magic != state_file_magic) {return std::nullopt;}
+
+        StateFile state_file;
+
+        reader
+            >> state_file.system_parameters.temperature
+            >> state_file.system_parameters.density
+            >> state_file.system_parameters.particle_count
+            >> state_file.system_state;
+
+        if (!reader.good()
+            || state_file.system_state.particle_count()
+                != state_file.system_parameters.particle_count) [[unlikely]]
+        {
+            return std::nullopt;
+        }
+
+        return state_file;
+    }
+
+    bool write_state_file(const std::filesystem::path& state_path, const StateFile& state_file)
+    {
+        auto temporary_path = state_path;
+        temporary_path += ".tmp";
+
+        {
+            std::ofstream destination{temporary_path, std::ios::binary | std::ios::trunc};
+            tools::BinaryWriter writer{destination};
+
+            writer
+                << state_file_magic
+                << state_file.system_parameters.temperature
+                << state_file.system_parameters.density
+                << state_file.system_parameters.particle_count
+                << state_file.system_state;
+
+            destination.close();
+
+            if (!destination) {return false;}
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary_path, state_path, error);
+
+        return !error;
+    }
+} // namespace output
@@ -0,0 +1,57 @@
+/**
+ * state_file.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_STATE_FILE_HPP
+#define LJ_STATE_FILE_HPP
+
+#include <optional>
+#include <filesystem>
+
+#include <lennardjonesium/tools/system_parameters.hpp>
+#include <lennardjonesium/physics/system_state.hpp>
+
+namespace output
+{
+    struct StateFile
+    {
+        /**
+         * A StateFile holds a SystemState together with the SystemParameters it was obtained at.
+         * It is written at the end of a completed simulation, so that another simulation at a
+         * nearby temperature and density can start from it instead of from a crystal lattice.
+         * 
+         * The file is binary (see tools::BinaryWriter), and is only meant to be read back on the
+         * same kind of machine that wrote it.
+         */
+
+        tools::SystemParameters system_parameters;
+        physics::SystemState system_state;
+    };
+
+    // Read a state file; returns std::nullopt if the file is missing or not a valid state file
+    std::optional<StateFile> read_state_file(const std::filesystem::path& state_path);
+
+    // Write a state file atomically (via a temporary file); returns false on failure
+    bool write_state_file(const std::filesystem::path& state_path, const StateFile& state_file);
+} // namespace output
+
+
+#endif
@@ -0,0 +1,377 @@
+/**
+ * trajectory.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <bit>
+#include <cassert>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+
+#include <Eigen/Dense>
+
+#include <lennardjonesium/tools/bounding_box.hpp>
+#include <lennardjonesium/tools/binary_stream.hpp>
+#include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/trajectory_codec.hpp>
+#include <lennardjonesium/output/trajectory.hpp>
+
+namespace output
+{
+    // Values are written in memory order, which is only the advertised format on little-endian
+    // machines
+    static_assert(std::endian::native == std::endian::little, "Trajectories are little-endian");
+
+    namespace
+    {
+        // Size of the frame fields before the coordinates
+        constexpr std::uint64_t frame_preamble_size =
+            sizeof(std::uint64_t) + sizeof(std::int64_t) + sizeof(double);
+
+        // Size of the index fields after the frame offsets
+        constexpr std::uint64_t index_trailer_size =
+            sizeof(std::uint64_t) + TrajectorySink::index_magic.size();
+    }
+
+    TrajectorySink::TrajectorySink(
+        std::ostream& destination,
+        int particle_count,
+        TrajectoryFormat format,
+        std::optional<TrajectoryIndex> existing_frames
+    )
+        : detail::SinkCommon{destination},
+          particle_count_{static_cast<std::uint64_t>(particle_count)},
+          format_{format},
+          end_offset_{header_size}
+    {
+        if (existing_frames)
+        {
+            frame_offsets_ = std::move(existing_frames->frame_offsets);
+            end_offset_ = existing_frames->end_offset;
+        }
+    }
+
+    TrajectorySink::TrajectorySink(
+        std::ostream& destination,
+        int particle_count,
+        const tools::BoundingBox& bounding_box,
+        TrajectoryCompression compression,
+        std::optional<TrajectoryIndex> existing_frames
+    )
+        : TrajectorySink(
+            destination, particle_count, TrajectoryFormat::compressed, std::move(existing_frames)
+          )
+    {
+        assert(compression.keyframe_interval > 0 && "Keyframe interval must be positive");
+
+        encoder_.emplace(bounding_box, compression);
+        keyframe_interval_ = compression.keyframe_interval;
+    }
+
+    void TrajectorySink::write_header()
+    {
+        tools::BinaryWriter writer{destination_};
+
+        writer << magic << particle_count_ << static_cast<std::uint64_t>(format_)
+            << std::uint64_t{0};
+    }
+
+    void TrajectorySink::write(int time_step, const TrajectoryFrame& message)
+    {
+        assert(
+            static_cast<std::uint64_t>(message.positions.cols()) == particle_count_
+            && "Trajectory frame has the wrong number of particles"
+        );
+
+        switch (format_)
+        {
+            case TrajectoryFormat::compressed:
+                write_compressed_frame_(time_step, message);
+                break;
+
+            case TrajectoryFormat::float32:
+                write_frame_<float>(time_step, message);
+                break;
+
+            case TrajectoryFormat::float64:
+            default:
+                write_frame_<double>(time_step, message);
+                break;
+        }
+    }
+
+    template<class T>
+    void TrajectorySink::write_frame_(int time_step, const TrajectoryFrame& frame)
+    {
+        std::uint64_t frame_size = frame_preamble_size + 6 * particle_count_ * sizeof(T);
+
+        // Gather the x, y, z coordinates (leaving out the unused fourth row), converted to the
+        // stored precision, so that the frame can be written all at once
+        std::vector<T> values;
+        values.reserve(6 * particle_count_);
+
+        for (const auto* matrix : {&frame.positions, &frame.velocities})
+        {
+            for (Eigen::Index i = 0; i < matrix->cols(); ++i)
+            {
+                for (Eigen::Index k = 0; k < 3; ++k)
+                {
+                    values.push_back(static_cast<T>((*matrix)(k, i)));
+                }
+            }
+        }
+
+        tools::BinaryWriter writer{destination_};
+        writer << frame_size << static_cast<std::int64_t>(time_step) << frame.time;
+
+        destination_.write(
+            reinterpret_cast<const char*>(values.data()),
+            static_cast<std::streamsize>(values.size() * sizeof(T))
+        );
+
+        frame_offsets_.push_back(end_offset_);
+        end_offset_ += frame_size;
+    }
+
+    void TrajectorySink::write_compressed_frame_(int time_step, const TrajectoryFrame& frame)
+    {
+        assert(encoder_ && "Compressed trajectories need a TrajectoryEncoder");
+
+        auto body = encoder_->encode(frame, frames_since_keyframe_ == 0);
+        frames_since_keyframe_ = (frames_since_keyframe_ + 1) % keyframe_interval_;
+
+        std::uint64_t frame_size = frame_preamble_size + body.size();
+
+        tools::BinaryWriter writer{destination_};
+        writer << frame_size << static_cast<std::int64_t>(time_step) << frame.time;
+
+        destination_.write(
+            reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size())
+        );
+
+        frame_offsets_.push_back(end_offset_);
+        end_offset_ += frame_size;
+    }
+
+    void TrajectorySink::write_index()
+    {
+        tools::BinaryWriter writer{destination_};
+
+        for (auto offset : frame_offsets_) {writer << offset;}
+        writer << static_cast<std::uint64_t>(frame_offsets_.size()) << index_magic;
+
+        flush();
+    }
+
+    std::optional<TrajectoryIndex> read_trajectory_index(
+        const std::filesystem::path& trajectory_path
+    )
+    {
+        std::error_code error;
+        auto file_size = std::filesystem::file_size(trajectory_path, error);
+        if (error) {return std::nullopt;}
+
+        std::ifstream source{trajectory_path, std::ios::binary};
+        tools::BinaryReader reader{source};
+
+        std::array<char, 8> magic{};
+        reader >> magic;
+
+        if (!reader.good() || magic != TrajectorySink::magic) {return std::nullopt;}
+
+        TrajectoryIndex index{.frame_offsets = {}, .end_offset = TrajectorySink::header_size};
+
+        // First look for the index at the end of the file
+        if (file_size >= TrajectorySink::header_size + index_trailer_size)
+        {
+            std::uint64_t frame_count{};
+            std::array<char, 8> trailer_magic{};
+
+            source.seekg(static_cast<std::streamoff>(file_size - index_trailer_size));
+            reader >> frame_count >> trailer_magic;
+
+            auto index_size = frame_count * sizeof(std::uint64_t) + index_trailer_size;
+
+            if (reader.good() && trailer_magic == TrajectorySink::index_magic
+                && index_size <= file_size - TrajectorySink::header_size)
+            {
+                index.end_offset = file_size - index_size;
+                index.frame_offsets.resize(frame_count);
+
+                source.seekg(static_cast<std::streamoff>(index.end_offset));
+                for (auto& offset : index.frame_offsets) {reader >> offset;}
+
+                if (reader.good()) {return index;}
+            }
+
+            source.clear();
+            index.frame_offsets.clear();
+            index.end_offset = TrajectorySink::header_size;
+        }
+
+        // Otherwise follow the frame sizes, stopping at the first incomplete frame
+        while (index.end_offset + sizeof(std::uint64_t) <= file_size)
+        {
+            std::uint64_t frame_size{};
+
+            source.seekg(static_cast<std::streamoff>(index.end_offset));
+            reader >> frame_size;
+
+            if (!reader.good() || frame_size < frame_preamble_size
+                || frame_size > file_size - index.end_offset)
+            {
+                break;
+            }
+
+            index.frame_offsets.push_back(index.end_offset);
+            index.end_offset += frame_size;
+        }
+
+        return index;
+    }
+
+    TrajectoryReader::TrajectoryReader(const std::filesystem::path& trajectory_path)
+        : source_{trajectory_path, std::ios::binary}
+    {
+        auto index = read_trajectory_index(trajectory_path);
+        if (!index) {return;}
+
+        tools::BinaryReader reader{source_};
+
+        std::array<char, 8> magic{};
+        std::uint64_t format{};
+        reader >> magic >> particle_count_ >> format;
+
+        if (!reader.good() || format > static_cast<std::uint64_t>(TrajectoryFormat::compressed))
+        {
+            return;
+        }
+
+        format_ = static_cast<TrajectoryFormat>(format);
+
+        if (format_ == TrajectoryFormat::compressed)
+        {
+            decoder_.emplace(static_cast<int>(particle_count_));
+        }
+
+        index_ = std::move(*index);
+        good_ = true;
+    }
+
+    TrajectoryReader::Frame TrajectoryReader::frame(std::size_t i)
+    {
+        assert(good_ && i < frame_count() && "No such trajectory frame");
+
+        if (format_ == TrajectoryFormat::compressed)
+        {
+            // Start from the keyframe at or before frame i, or continue from the last frame read
+            std::size_t first = i;
+            while (!is_keyframe_(first) && !(last_decoded_ && *last_decoded_ + 1 == first))
+            {
+                assert(first > 0 && "Compressed trajectory does not begin with a keyframe");
+                --first;
+            }
+
+            Frame result{};
+            for (auto j = first; j <= i; ++j) {result = decode_frame_(j);}
+            return result;
+        }
+
+        source_.clear();
+        source_.seekg(static_cast<std::streamoff>(index_.frame_offsets[i]));
+
+        tools::BinaryReader reader{source_};
+
+        std::uint64_t frame_size{};
+        std::int64_t time_step{};
+
+        Frame result{};
+        reader >> frame_size >> time_step >> result.frame.time;
+        result.time_step = static_cast<int>(time_step);
+
+        for (auto* matrix : {&result.frame.positions, &result.frame.velocities})
+        {
+            if (format_ == TrajectoryFormat::float32) {read_frame_data_<float>(*matrix);}
+            else {read_frame_data_<double>(*matrix);}
+        }
+
+        return result;
+    }
+
+    bool TrajectoryReader::is_keyframe_(std::size_t i)
+    {
+        std::uint8_t flag{};
+
+        source_.clear();
+        source_.seekg(static_cast<std::streamoff>(index_.frame_offsets[i] + frame_preamble_size));
+        source_.read(reinterpret_cast<char*>(&flag), 1);
+
+        return TrajectoryDecoder::is_keyframe(&flag);
+    }
+
+    TrajectoryReader::Frame TrajectoryReader::decode_frame_(std::size_t i)
+    {
+        source_.clear();
+        source_.seekg(static_cast<std::streamoff>(index_.frame_offsets[i]));
+
+        tools::BinaryReader reader{source_};
+
+        std::uint64_t frame_size{};
+        std::int64_t time_step{};
+
+        Frame result{};
+        reader >> frame_size >> time_step >> result.frame.time;
+        result.time_step = static_cast<int>(time_step);
+
+        std::vector<std::uint8_t> body(frame_size - frame_preamble_size);
+        source_.read(reinterpret_cast<char*>(body.data()), static_cast<std::streamsize>(body.size()));
+
+        decoder_->decode(body.data(), body.size(), result.frame);
+        last_decoded_ = i;
+
+        return result;
+    }
+
+    template<class T>
+    void TrajectoryReader::read_frame_data_(Eigen::Matrix4Xd& matrix)
+    {
+        std::vector<T> values(3 * particle_count_);
+
+        source_.read(
+            reinterpret_cast<char*>(values.data()),
+            static_cast<std::streamsize>(values.size() * sizeof(T))
+        );
+
+        matrix = Eigen::Matrix4Xd::Zero(4, static_cast<Eigen::Index>(particle_count_));
+
+        for (std::uint64_t i = 0; i < particle_count_; ++i)
+        {
+            for (std::uint64_t k = 0; k < 3; ++k)
+            {
+                matrix(k, i) = static_cast<double>(values[3 * i + k]);
+            }
+        }
+    }
+} // namespace output
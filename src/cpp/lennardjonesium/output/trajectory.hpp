@@ -0,0 +1,180 @@
+/**
+ * trajectory.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_TRAJECTORY_HPP
+#define LJ_TRAJECTORY_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+
+#include <lennardjonesium/tools/bounding_box.hpp>
+#include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/sinks.hpp>
+#include <lennardjonesium/output/trajectory_codec.hpp>
+
+namespace output
+{
+    /**
+     * A trajectory file records TrajectoryFrames in binary, all little-endian:
+     * 
+     *  Header (32 bytes):
+     *      the magic string "LJTRAJ01", then uint64 particle count, uint64 format code (see
+     *      TrajectoryFormat), and uint64 zero (reserved)
+     * 
+     *  Frames, each consisting of:
+     *      uint64 size of the frame in bytes (including this field), int64 time step, float64
+     *      time, then the x, y, z coordinates of every particle's position, followed by those of
+     *      every velocity, as float64 or float32 according to the format (in the compressed
+     *      format, the coordinates are instead coded as described in trajectory_codec.hpp)
+     * 
+     *  Index (written when the simulation finishes):
+     *      uint64 offset of each frame from the start of the file, then uint64 number of frames,
+     *      then the magic string "LJTRIDX1"
+     * 
+     * The index allows random access to the frames.  If a run is interrupted before the index is
+     * written, the frames can still be found by following their sizes from the header on.
+     */
+
+    enum class TrajectoryFormat : std::uint64_t {float64 = 0, float32 = 1, compressed = 2};
+
+    struct TrajectoryIndex
+    {
+        std::vector<std::uint64_t> frame_offsets;
+
+        // The end of the last frame, where the index itself begins (or more frames may follow)
+        std::uint64_t end_offset;
+    };
+
+    class TrajectorySink
+        : public detail::SinkCommon, public detail::MessageSink<TrajectoryFrame>
+    {
+        /**
+         * TrajectorySink writes TrajectoryFrames to a trajectory file.  When appending to an
+         * existing file (e.g. after resuming from a checkpoint), it must be given the index of the
+         * frames already present, so that the final index covers the whole file.
+         */
+
+        public:
+            inline static constexpr std::array<char, 8> magic{'L','J','T','R','A','J','0','1'};
+            inline static constexpr std::array<char, 8> index_magic{'L','J','T','R','I','D','X','1'};
+            inline static constexpr std::uint64_t header_size = 32;
+
+            virtual void write_header() override;
+
+            virtual void write(int time_step, const TrajectoryFrame& message) override;
+
+            // Write the index of all frames; nothing may be written afterward
+            void write_index();
+
+            TrajectorySink(
+                std::ostream& destination,
+                int particle_count,
+                TrajectoryFormat format,
+                std::optional<TrajectoryIndex> existing_frames = std::nullopt
+            );
+
+            // The compressed format also needs the box, to fit the position grid to it.  When
+            // appending to an existing file, the first new frame is a keyframe.
+            TrajectorySink(
+                std::ostream& destination,
+                int particle_count,
+                const tools::BoundingBox& bounding_box,
+                TrajectoryCompression compression,
+                std::optional<TrajectoryIndex> existing_frames = std::nullopt
+            );
+
+        private:
+            std::uint64_t particle_count_;
+            TrajectoryFormat format_;
+            std::vector<std::uint64_t> frame_offsets_;
+            std::uint64_t end_offset_;
+
+            // Only used for the compressed format
+            std::optional<TrajectoryEncoder> encoder_;
+            int keyframe_interval_{1};
+            int frames_since_keyframe_{0};
+
+            void write_compressed_frame_(int time_step, const TrajectoryFrame& frame);
+
+            template<class T>
+            void write_frame_(int time_step, const TrajectoryFrame& frame);
+    };
+
+    class TrajectoryReader
+    {
+        /**
+         * TrajectoryReader provides random access to the frames of a trajectory file.  It uses
+         * the index if there is one, and otherwise finds the complete frames by scanning.
+         * 
+         * In the compressed format, reading a frame means decoding from the keyframe before it,
+         * unless the frames are read in order, in which case each is decoded only once.
+         */
+
+        public:
+            struct Frame
+            {
+                int time_step;
+                TrajectoryFrame frame;
+            };
+
+            explicit TrajectoryReader(const std::filesystem::path& trajectory_path);
+
+            // Whether the file could be opened and has a valid header
+            bool good() const {return good_;}
+
+            int particle_count() const {return static_cast<int>(particle_count_);}
+            TrajectoryFormat format() const {return format_;}
+            const TrajectoryIndex& index() const {return index_;}
+            std::size_t frame_count() const {return index_.frame_offsets.size();}
+
+            Frame frame(std::size_t i);
+
+        private:
+            std::ifstream source_;
+            bool good_{false};
+            std::uint64_t particle_count_{};
+            TrajectoryFormat format_{};
+            TrajectoryIndex index_{};
+
+            // Only used for the compressed format
+            std::optional<TrajectoryDecoder> decoder_;
+            std::optional<std::size_t> last_decoded_;
+
+            bool is_keyframe_(std::size_t i);
+            Frame decode_frame_(std::size_t i);
+
+            template<class T>
+            void read_frame_data_(Eigen::Matrix4Xd& matrix);
+    };
+
+    // Find the frames of a trajectory file; returns std::nullopt if it is not a trajectory file
+    std::optional<TrajectoryIndex> read_trajectory_index(
+        const std::filesystem::path& trajectory_path
+    );
+} // namespace output
+
+
+#endif
@@ -0,0 +1,269 @@
+/**
+ * trajectory_codec.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <bit>
+#include <cmath>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <vector>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+#include <lennardjonesium/tools/bounding_box.hpp>
+#include <lennardjonesium/tools/bit_stream.hpp>
+#include <lennardjonesium/output/log_message.hpp>
+#include <lennardjonesium/output/trajectory_codec.hpp>
+
+namespace output
+{
+    static_assert(std::endian::native == std::endian::little, "Trajectories are little-endian");
+
+    namespace
+    {
+        // Size of the fixed fields at the start of a compressed frame body
+        constexpr std::size_t body_header_size = 3 + 3 * sizeof(double)
+            + 3 * sizeof(std::uint32_t) + sizeof(double);
+
+        template<class T>
+        void append(std::vector<std::uint8_t>& bytes, T value)
+        {
+            auto first = reinterpret_cast<const std::uint8_t*>(&value);
+            bytes.insert(bytes.end(), first, first + sizeof(T));
+        }
+
+        template<class T>
+        T extract(const std::uint8_t*& body)
+        {
+            T value;
+            std::memcpy(&value, body, sizeof(T));
+            body += sizeof(T);
+            return value;
+        }
+
+        std::int64_t positive_modulo(std::int64_t value, std::int64_t modulus)
+        {
+            auto remainder = value % modulus;
+            return remainder < 0 ? remainder + modulus : remainder;
+        }
+
+        // Choose the Rice parameter which gives the shortest code for the given values
+        int choose_rice_parameter(std::span<const std::uint64_t> values)
+        {
+            if (values.empty()) {return 0;}
+
+            auto mean = std::accumulate(values.begin(), values.end(), std::uint64_t{0})
+                / values.size();
+
+            // The optimum is near log2 of the mean, so we only compare its neighbours
+            int guess = std::max(static_cast<int>(std::bit_width(mean)) - 1, 0);
+
+            int best_k = guess;
+            std::uint64_t best_length = UINT64_MAX;
+
+            for (int k = std::max(guess - 1, 0); k <= std::min(guess + 1, 63); ++k)
+            {
+                std::uint64_t length = 0;
+                for (auto value : values) {length += tools::rice_length(value, k);}
+
+                if (length < best_length)
+                {
+                    best_length = length;
+                    best_k = k;
+                }
+            }
+
+            return best_k;
+        }
+    }
+
+    TrajectoryEncoder::TrajectoryEncoder(
+        const tools::BoundingBox& bounding_box, TrajectoryCompression compression
+    )
+        : box_{bounding_box.array().head<3>()},
+          velocity_quantum_{compression.velocity_precision}
+    {
+        assert(compression.position_precision > 0.0 && "Position precision must be positive");
+        assert(compression.velocity_precision > 0.0 && "Velocity precision must be positive");
+
+        for (int k = 0; k < 3; ++k)
+        {
+            cells_[k] = static_cast<std::uint32_t>(
+                std::max(std::ceil(box_[k] / compression.position_precision), 1.0)
+            );
+        }
+    }
+
+    std::vector<std::uint8_t> TrajectoryEncoder::encode(const TrajectoryFrame& frame, bool keyframe)
+    {
+        auto particle_count = static_cast<std::size_t>(frame.positions.cols());
+        auto position_count = 3 * particle_count;
+
+        // A frame can only be coded relative to a previous frame of the same size
+        keyframe = keyframe || previous_.size() != 2 * position_count;
+
+        // Quantize
+        std::vector<std::int64_t> quantized(2 * position_count);
+
+        for (std::size_t i = 0; i < particle_count; ++i)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                auto cells = static_cast<std::int64_t>(cells_[k]);
+                auto quantum = box_[k] / cells_[k];
+
+                auto position = frame.positions(k, i);
+                auto velocity = frame.velocities(k, i);
+
+                quantized[3 * i + k] = positive_modulo(
+                    static_cast<std::int64_t>(std::floor(position / quantum + 0.5)), cells
+                );
+
+                quantized[position_count + 3 * i + k] =
+                    static_cast<std::int64_t>(std::llround(velocity / velocity_quantum_));
+            }
+        }
+
+        // Map to unsigned values to be coded, using differences from the previous frame
+        std::vector<std::uint64_t> values(2 * position_count);
+
+        for (std::size_t j = 0; j < position_count; ++j)
+        {
+            auto cells = static_cast<std::int64_t>(cells_[j % 3]);
+
+            if (keyframe)
+            {
+                values[j] = static_cast<std::uint64_t>(quantized[j]);
+            }
+            else
+            {
+                // Take the difference the short way around the box
+                auto difference = quantized[j] - previous_[j];
+                if (2 * difference >= cells) {difference -= cells;}
+                else if (2 * difference < -cells) {difference += cells;}
+
+                values[j] = tools::zigzag(difference);
+            }
+        }
+
+        for (std::size_t j = position_count; j < 2 * position_count; ++j)
+        {
+            values[j] = tools::zigzag(keyframe ? quantized[j] : quantized[j] - previous_[j]);
+        }
+
+        previous_ = std::move(quantized);
+
+        // Rice code the values
+        std::span<const std::uint64_t> all_values{values};
+        auto position_values = all_values.first(position_count);
+        auto velocity_values = all_values.last(position_count);
+
+        int position_k = choose_rice_parameter(position_values);
+        int velocity_k = choose_rice_parameter(velocity_values);
+
+        tools::BitWriter bits;
+        for (auto value : position_values) {bits.write_rice(value, position_k);}
+        for (auto value : velocity_values) {bits.write_rice(value, velocity_k);}
+
+        // Assemble the body
+        std::vector<std::uint8_t> body;
+        body.reserve(body_header_size);
+
+        append(body, static_cast<std::uint8_t>(keyframe));
+        append(body, static_cast<std::uint8_t>(position_k));
+        append(body, static_cast<std::uint8_t>(velocity_k));
+        for (int k = 0; k < 3; ++k) {append(body, box_[k]);}
+        for (int k = 0; k < 3; ++k) {append(body, cells_[k]);}
+        append(body, velocity_quantum_);
+
+        auto coded = bits.finish();
+        body.insert(body.end(), coded.begin(), coded.end());
+
+        return body;
+    }
+
+    void TrajectoryDecoder::decode(
+        const std::uint8_t* body, std::size_t size, TrajectoryFrame& frame
+    )
+    {
+        assert(size >= body_header_size && "Compressed trajectory frame is too short");
+
+        auto particle_count = static_cast<std::size_t>(particle_count_);
+        auto position_count = 3 * particle_count;
+
+        const std::uint8_t* field = body;
+        bool keyframe = extract<std::uint8_t>(field) != 0;
+        int position_k = extract<std::uint8_t>(field);
+        int velocity_k = extract<std::uint8_t>(field);
+
+        std::array<double, 3> box;
+        std::array<std::int64_t, 3> cells;
+        for (auto& side : box) {side = extract<double>(field);}
+        for (auto& count : cells) {count = extract<std::uint32_t>(field);}
+        auto velocity_quantum = extract<double>(field);
+
+        assert(
+            (keyframe || previous_.size() == 2 * position_count)
+            && "Compressed trajectory frames must be decoded in order from a keyframe"
+        );
+
+        previous_.resize(2 * position_count);
+
+        tools::BitReader bits{field, size - body_header_size};
+
+        for (std::size_t j = 0; j < position_count; ++j)
+        {
+            auto value = bits.read_rice(position_k);
+            auto axis_cells = cells[j % 3];
+
+            previous_[j] = keyframe
+                ? static_cast<std::int64_t>(value)
+                : positive_modulo(previous_[j] + tools::unzigzag(value), axis_cells);
+        }
+
+        for (std::size_t j = position_count; j < 2 * position_count; ++j)
+        {
+            auto difference = tools::unzigzag(bits.read_rice(velocity_k));
+            previous_[j] = keyframe ? difference : previous_[j] + difference;
+        }
+
+        frame.positions = Eigen::Matrix4Xd::Zero(4, static_cast<Eigen::Index>(particle_count));
+        frame.velocities = Eigen::Matrix4Xd::Zero(4, static_cast<Eigen::Index>(particle_count));
+
+        for (std::size_t i = 0; i < particle_count; ++i)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                frame.positions(k, i) = static_cast<double>(previous_[3 * i + k])
+                    * (box[k] / static_cast<double>(cells[k]));
+
+                frame.velocities(k, i) = static_cast<double>(previous_[position_count + 3 * i + k])
+                    * velocity_quantum;
+            }
+        }
+    }
+} // namespace output
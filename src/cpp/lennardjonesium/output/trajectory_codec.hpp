@@ -0,0 +1,110 @@
+/**
+ * trajectory_codec.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_TRAJECTORY_CODEC_HPP
+#define LJ_TRAJECTORY_CODEC_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <lennardjonesium/tools/bounding_box.hpp>
+#include <lennardjonesium/output/log_message.hpp>
+
+namespace output
+{
+    struct TrajectoryCompression
+    {
+        /**
+         * Settings for the compressed trajectory format.  The precisions are the largest spacing
+         * of the grids that positions and velocities are rounded to, so the error in any
+         * coordinate is at most half of the precision.  The position grid is fitted to the
+         * BoundingBox (a whole number of cells along each side), so that it respects the periodic
+         * boundary conditions.  Every keyframe_interval frames there is a keyframe, which can be
+         * decoded without any of the frames before it.
+         */
+
+        double position_precision = 1.0e-3;
+        double velocity_precision = 1.0e-3;
+        int keyframe_interval = 100;
+    };
+
+    /**
+     * The compressed format works like the XTC format used by other molecular dynamics codes:
+     * 
+     *  1. Positions and velocities are quantized to integers on the grids described above.
+     * 
+     *  2. In keyframes, the integers are stored directly.  In the other frames, only their
+     *      differences from the previous frame are stored; for positions, the differences are
+     *      taken around the periodic box, so a particle crossing the boundary is a small change.
+     * 
+     *  3. The integers are Rice coded (see tools::BitWriter), with the Rice parameter chosen
+     *      separately for positions and velocities in each frame.
+     * 
+     * The body of a compressed frame (after the common frame fields) is, all little-endian:
+     * 
+     *  uint8 keyframe flag, uint8 Rice parameter for positions, uint8 Rice parameter for
+     *  velocities, float64 box side lengths x, y, z, uint32 number of grid cells along x, y, z,
+     *  float64 velocity grid spacing, and then the Rice coded bits (to the end of the frame)
+     * 
+     * The position grid spacing along each axis is the side length divided by the number of
+     * cells.  The values are coded in the same order as in the uncompressed formats.
+     */
+
+    class TrajectoryEncoder
+    {
+        public:
+            TrajectoryEncoder(const tools::BoundingBox& bounding_box, TrajectoryCompression);
+
+            // Encode the body of a frame.  Other than keyframes, frames are coded relative to the
+            // frame encoded before them.
+            std::vector<std::uint8_t> encode(const TrajectoryFrame& frame, bool keyframe);
+
+        private:
+            Eigen::Array3d box_;
+            std::array<std::uint32_t, 3> cells_;
+            double velocity_quantum_;
+
+            std::vector<std::int64_t> previous_;
+    };
+
+    class TrajectoryDecoder
+    {
+        public:
+            explicit TrajectoryDecoder(int particle_count) : particle_count_{particle_count} {}
+
+            static bool is_keyframe(const std::uint8_t* body) {return body[0] != 0;}
+
+            // Decode the body of a frame.  Other than keyframes, frames must be decoded in order.
+            void decode(const std::uint8_t* body, std::size_t size, TrajectoryFrame& frame);
+
+        private:
+            int particle_count_;
+            std::vector<std::int64_t> previous_;
+    };
+} // namespace output
+
+
+#endif
@@ -20,15 +20,35 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+#include <array>
+#include <algorithm>
+
 #include <Eigen/Dense>
 
 #include <lennardjonesium/tools/system_parameters.hpp>
 #include <lennardjonesium/tools/moving_sample.hpp>
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/measurements.hpp>
 #include <lennardjonesium/physics/analyzers.hpp>
 
 namespace physics
 {
+    namespace
+    {
+        using Result = ThermodynamicMeasurement::Result;
+
+        // The quantities of a ThermodynamicMeasurement, for treating them all alike
+        constexpr std::array<double Result::*, 7> thermodynamic_quantities{
+            &Result::time,
+            &Result::kinetic_energy,
+            &Result::potential_energy,
+            &Result::total_energy,
+            &Result::virial,
+            &Result::temperature,
+            &Result::mean_square_displacement
+        };
+    }
+
     void ThermodynamicAnalyzer::collect(const ThermodynamicMeasurement& measurement)
     {
         temperature_sample_.push_back(measurement.result().temperature);
@@ -157,5 +177,71 @@ namespace physics
             diffusion_coefficient
         };
     }
-} // namespace physics
 
+    void ThermodynamicAnalyzer::save(tools::BinaryWriter& writer) const
+    {
+        temperature_sample_.save(writer);
+        total_energy_sample_.save(writer);
+        virial_sample_.save(writer);
+        msd_vs_time_sample_.save(writer);
+    }
+
+    void ThermodynamicAnalyzer::restore(tools::BinaryReader& reader)
+    {
+        temperature_sample_.restore(reader);
+        total_energy_sample_.restore(reader);
+        virial_sample_.restore(reader);
+        msd_vs_time_sample_.restore(reader);
+    }
+
+    void ThermodynamicBlockAnalyzer::collect(const ThermodynamicMeasurement& measurement)
+    {
+        const auto& sample = measurement.result();
+        auto n = ++block_.sample_count;
+
+        for (auto quantity : thermodynamic_quantities)
+        {
+            double value = sample.*quantity;
+
+            if (n == 1)
+            {
+                block_.minimum.*quantity = value;
+                block_.maximum.*quantity = value;
+            }
+            else
+            {
+                block_.minimum.*quantity = std::min(block_.minimum.*quantity, value);
+                block_.maximum.*quantity = std::max(block_.maximum.*quantity, value);
+            }
+
+            double delta = value - block_.mean.*quantity;
+            block_.mean.*quantity += delta / n;
+            sum_of_squares_.*quantity += delta * (value - block_.mean.*quantity);
+        }
+    }
+
+    ThermodynamicBlockAnalyzer::result_type ThermodynamicBlockAnalyzer::result()
+    {
+        auto block = block_;
+
+        if (block.sample_count > 1)
+        {
+            for (auto quantity : thermodynamic_quantities)
+            {
+                block.variance.*quantity = sum_of_squares_.*quantity / (block.sample_count - 1);
+            }
+        }
+
+        return block;
+    }
+
+    void ThermodynamicBlockAnalyzer::save(tools::BinaryWriter& writer) const
+    {
+        writer << block_ << sum_of_squares_;
+    }
+
+    void ThermodynamicBlockAnalyzer::restore(tools::BinaryReader& reader)
+    {
+        reader >> block_ >> sum_of_squares_;
+    }
+} // namespace physics
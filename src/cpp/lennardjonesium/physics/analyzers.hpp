@@ -27,6 +27,7 @@
 
 #include <lennardjonesium/tools/system_parameters.hpp>
 #include <lennardjonesium/tools/moving_sample.hpp>
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/measurements.hpp>
 #include <lennardjonesium/physics/observation.hpp>
 
@@ -59,6 +60,10 @@ namespace physics
             virtual result_type result() = 0;
             virtual int sample_size() = 0;
 
+            // Write and read back the accumulated samples, so that a run can be checkpointed
+            virtual void save(tools::BinaryWriter& writer) const = 0;
+            virtual void restore(tools::BinaryReader& reader) = 0;
+
             virtual ~Analyzer() = default;
     };
 
@@ -79,6 +84,12 @@ namespace physics
             
             virtual int sample_size() override {return sample_size_;}
 
+            virtual void save(tools::BinaryWriter& writer) const override
+                {temperature_sample_.save(writer);}
+
+            virtual void restore(tools::BinaryReader& reader) override
+                {temperature_sample_.restore(reader);}
+
             TemperatureAnalyzer
                 (tools::SystemParameters system_parameters, int sample_size)
                 : temperature_sample_{sample_size},
@@ -104,6 +115,8 @@ namespace physics
             virtual void collect(const ThermodynamicMeasurement& measurement) override;
             virtual result_type result() override;
             virtual int sample_size() override {return sample_size_;}
+            virtual void save(tools::BinaryWriter& writer) const override;
+            virtual void restore(tools::BinaryReader& reader) override;
 
             ThermodynamicAnalyzer
                 (tools::SystemParameters system_parameters, int sample_size)
@@ -123,6 +136,45 @@ namespace physics
             tools::SystemParameters system_parameters_;
             int sample_size_;
     };
+
+    struct ThermodynamicBlock
+    {
+        /**
+         * Statistics of each thermodynamic quantity over a block of consecutive time steps.  The
+         * variance is the sample variance, which is zero for a block of a single time step.
+         */
+
+        int sample_count{};
+        ThermodynamicMeasurement::Result mean;
+        ThermodynamicMeasurement::Result minimum;
+        ThermodynamicMeasurement::Result maximum;
+        ThermodynamicMeasurement::Result variance;
+    };
+
+    class ThermodynamicBlockAnalyzer : public Analyzer<ThermodynamicBlock>
+    {
+        /**
+         * ThermodynamicBlockAnalyzer accumulates the statistics of all the measurements collected
+         * since it was last cleared, so that a block of time steps can be logged as a single
+         * ThermodynamicBlock.  The mean and variance are updated one sample at a time (Welford's
+         * algorithm), so no samples are kept.
+         */
+
+        public:
+            virtual void collect(const ThermodynamicMeasurement& measurement) override;
+            virtual result_type result() override;
+            virtual int sample_size() override {return block_.sample_count;}
+            virtual void save(tools::BinaryWriter& writer) const override;
+            virtual void restore(tools::BinaryReader& reader) override;
+
+            // Start a new block
+            void clear() {block_ = {}; sum_of_squares_ = {};}
+
+        private:
+            // The variance field is only filled in by result()
+            ThermodynamicBlock block_;
+            ThermodynamicMeasurement::Result sum_of_squares_;
+    };
 } // namespace physics
 
 #endif
@@ -0,0 +1,90 @@
+/**
+ * observation_statistics.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <lennardjonesium/physics/observation.hpp>
+#include <lennardjonesium/physics/observation_statistics.hpp>
+
+namespace physics
+{
+    namespace
+    {
+        // Treat the Observation fields as a vector, so that we can do arithmetic on all at once
+        using observation_vector = Eigen::Vector<double, 6>;
+
+        observation_vector to_vector(const Observation& o)
+        {
+            return {
+                o.temperature, o.density, o.total_energy, o.pressure, o.specific_heat,
+                o.diffusion_coefficient
+            };
+        }
+
+        Observation from_vector(const observation_vector& v)
+        {
+            return {
+                .temperature = v[0],
+                .density = v[1],
+                .total_energy = v[2],
+                .pressure = v[3],
+                .specific_heat = v[4],
+                .diffusion_coefficient = v[5]
+            };
+        }
+    }
+
+    ObservationStatistics combine_observations(const std::vector<Observation>& observations)
+    {
+        assert(!observations.empty() && "Cannot combine zero observations");
+
+        auto n = static_cast<double>(observations.size());
+
+        observation_vector mean = observation_vector::Zero();
+        for (const auto& o : observations) {mean += to_vector(o);}
+        mean /= n;
+
+        observation_vector standard_error = observation_vector::Zero();
+
+        if (observations.size() > 1)
+        {
+            observation_vector sum_of_squares = observation_vector::Zero();
+            for (const auto& o : observations)
+            {
+                sum_of_squares += (to_vector(o) - mean).array().square().matrix();
+            }
+
+            // Sample variance (with Bessel's correction), then the variance of the mean
+            standard_error = (sum_of_squares / ((n - 1.0) * n)).array().sqrt().matrix();
+        }
+
+        return {
+            .mean = from_vector(mean),
+            .standard_error = from_vector(standard_error),
+            .replica_count = static_cast<int>(observations.size())
+        };
+    }
+} // namespace physics
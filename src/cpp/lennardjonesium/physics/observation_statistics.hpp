@@ -0,0 +1,52 @@
+/**
+ * observation_statistics.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_OBSERVATION_STATISTICS_HPP
+#define LJ_OBSERVATION_STATISTICS_HPP
+
+#include <vector>
+
+#include <lennardjonesium/physics/observation.hpp>
+
+namespace physics
+{
+    struct ObservationStatistics
+    {
+        /**
+         * ObservationStatistics combines corresponding Observations from several independent
+         * replicas of the same state point.  Since the replicas are statistically independent,
+         * the standard error of the mean is simply the sample standard deviation divided by the
+         * square root of the number of replicas.  With fewer than two replicas there is no
+         * estimate of the error, and the standard errors are set to zero.  (We do not use NaN,
+         * since the library is compiled with -ffast-math.)
+         */
+
+        Observation mean;
+        Observation standard_error;
+        int replica_count;
+    };
+
+    ObservationStatistics combine_observations(const std::vector<Observation>& observations);
+} // namespace physics
+
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <cassert>
 
+#include <lennardjonesium/tools/binary_stream.hpp>
 #include <lennardjonesium/physics/system_state.hpp>
 
 namespace physics
@@ -53,4 +54,28 @@ namespace physics
 
         return state;
     }
+
+    tools::BinaryWriter& operator<< (tools::BinaryWriter& writer, const SystemState& state)
+    {
+        return writer
+            << state.positions
+            << state.velocities
+            << state.displacements
+            << state.forces
+            << state.potential_energy
+            << state.virial
+            << state.time;
+    }
+
+    tools::BinaryReader& operator>> (tools::BinaryReader& reader, SystemState& state)
+    {
+        return reader
+            >> state.positions
+            >> state.velocities
+            >> state.displacements
+            >> state.forces
+            >> state.potential_energy
+            >> state.virial
+            >> state.time;
+    }
 } // namespace physics
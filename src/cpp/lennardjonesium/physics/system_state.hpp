@@ -30,6 +30,8 @@
 
 #include <Eigen/Dense>
 
+#include <lennardjonesium/tools/binary_stream.hpp>
+
 namespace physics
 {
     struct SystemState
@@ -116,6 +118,14 @@ namespace physics
     // Clears the displacements so that the main experiment can start from the current positions
     SystemState& clear_displacements(SystemState&);
 
+    /**
+     * A SystemState can be written to and read back from a binary stream in full (including the
+     * time and displacements), for use in checkpoints and cached states.  The state read back is
+     * bit-for-bit identical to the one written.
+     */
+    tools::BinaryWriter& operator<< (tools::BinaryWriter&, const SystemState&);
+    tools::BinaryReader& operator>> (tools::BinaryReader&, SystemState&);
+
     /**
      * We define a few basic Properties.  These just give a uniform syntax for accessing information
      * about the SystemState.
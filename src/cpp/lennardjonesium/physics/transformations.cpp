@@ -34,7 +34,8 @@ namespace physics
 {
     SystemState::Operator set_momentum(const Eigen::Ref<const Eigen::Vector4d>& momentum)
     {
-        return [&momentum](SystemState& state) -> SystemState&
+        // Capture by value, since the argument may be a temporary (e.g. from zero_momentum())
+        return [momentum = Eigen::Vector4d{momentum}](SystemState& state) -> SystemState&
         {
             assert(state.particle_count() > 0 && "Cannot set momentum of empty state");
 
@@ -56,7 +57,11 @@ namespace physics
         const Eigen::Ref<const Eigen::Vector4d>& center
     )
     {
-        return [&angular_momentum, &center](SystemState& state) -> SystemState&
+        // Capture by value, since the arguments may be temporaries
+        return [
+            angular_momentum = Eigen::Vector4d{angular_momentum},
+            center = Eigen::Vector4d{center}
+        ](SystemState& state) -> SystemState&
         {
             assert(state.particle_count() > 0 && "Cannot set angular momentum of empty state");
 
@@ -115,4 +120,31 @@ namespace physics
             return state;
         };
     }
+
+    SystemState::Operator zero_velocities()
+    {
+        return [](SystemState& state) -> SystemState&
+        {
+            state.velocities.setZero();
+            return state;
+        };
+    }
+
+    SystemState::Operator mix_velocities_with_forces(double mixing)
+    {
+        return [mixing](SystemState& state) -> SystemState&
+        {
+            double force_norm = state.forces.norm();
+
+            // At a stationary point there is no direction to steer toward
+            if (force_norm == 0.0) {return state;}
+
+            double speed = state.velocities.norm();
+
+            state.velocities = (1.0 - mixing) * state.velocities
+                + (mixing * speed / force_norm) * state.forces;
+
+            return state;
+        };
+    }
 } // namespace physics
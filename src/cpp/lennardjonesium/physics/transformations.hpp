@@ -46,6 +46,20 @@ namespace physics
 
     SystemState::Operator set_temperature(double temperature);
 
+    // Bring every particle to rest, leaving positions and forces untouched
+    SystemState::Operator zero_velocities();
+
+    /**
+     * Mix a fraction of the (normalized) force direction into the velocities, keeping the overall
+     * speed fixed.  This is the velocity-steering step of the FIRE minimization algorithm:
+     * 
+     *      velocities = (1 - mixing) * velocities + mixing * |velocities| * forces / |forces|
+     * 
+     * where the norms are taken over the whole system.  If the forces vanish, the state is left
+     * unchanged.
+     */
+    SystemState::Operator mix_velocities_with_forces(double mixing);
+
     inline SystemState::Operator zero_momentum() {return set_momentum(Eigen::Vector4d::Zero());}
     
     inline SystemState::Operator zero_angular_momentum(
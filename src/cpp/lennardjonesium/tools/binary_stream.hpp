@@ -0,0 +1,152 @@
+/**
+ * binary_stream.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_BINARY_STREAM_HPP
+#define LJ_BINARY_STREAM_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+namespace tools
+{
+    /**
+     * BinaryWriter and BinaryReader are thin wrappers around std::ostream/std::istream which
+     * write and read values in their raw in-memory representation.  They are used for checkpoint
+     * files and cached states, which only need to be read back on the same kind of machine that
+     * wrote them, so we do not bother converting byte order.  (Callers that care should write a
+     * header that can be checked on reading.)
+     * 
+     * The following kinds of values are supported:
+     * 
+     *  1. Trivially copyable types (int, double, plain structs, etc.), written byte for byte.
+     * 
+     *  2. std::string, written as a length followed by the characters.
+     * 
+     *  3. Dynamically- or statically-sized Eigen matrices, written as rows and columns followed
+     *      by the coefficients in storage order.
+     * 
+     * Errors are reported through the state of the underlying stream, which can be queried with
+     * good().
+     */
+
+    class BinaryWriter
+    {
+        public:
+            explicit BinaryWriter(std::ostream& destination) : destination_{destination} {}
+
+            template<class T> requires std::is_trivially_copyable_v<T>
+            BinaryWriter& operator<< (const T& value)
+            {
+                destination_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+                return *this;
+            }
+
+            BinaryWriter& operator<< (const std::string& value)
+            {
+                *this << static_cast<std::uint64_t>(value.size());
+                destination_.write(value.data(), value.size());
+                return *this;
+            }
+
+            template<class Derived>
+            BinaryWriter& operator<< (const Eigen::PlainObjectBase<Derived>& value)
+            {
+                using Scalar = typename Derived::Scalar;
+
+                *this << static_cast<std::int64_t>(value.rows())
+                    << static_cast<std::int64_t>(value.cols());
+
+                destination_.write(
+                    reinterpret_cast<const char*>(value.data()), value.size() * sizeof(Scalar)
+                );
+
+                return *this;
+            }
+
+            bool good() const {return destination_.good();}
+
+        private:
+            std::ostream& destination_;
+    };
+
+    class BinaryReader
+    {
+        public:
+            explicit BinaryReader(std::istream& source) : source_{source} {}
+
+            template<class T> requires std::is_trivially_copyable_v<T>
+            BinaryReader& operator>> (T& value)
+            {
+                source_.read(reinterpret_cast<char*>(&value), sizeof(T));
+                return *this;
+            }
+
+            BinaryReader& operator>> (std::string& value)
+            {
+                std::uint64_t size{};
+                *this >> size;
+
+                if (!good()) {return *this;}
+
+                value.resize(size);
+                source_.read(value.data(), size);
+                return *this;
+            }
+
+            template<class Derived>
+            BinaryReader& operator>> (Eigen::PlainObjectBase<Derived>& value)
+            {
+                using Scalar = typename Derived::Scalar;
+
+                std::int64_t rows{}, cols{};
+                *this >> rows >> cols;
+
+                // Refuse sizes that the matrix type cannot represent, rather than asserting
+                if (!good()
+                    || (Derived::RowsAtCompileTime != Eigen::Dynamic
+                        && rows != Derived::RowsAtCompileTime)
+                    || (Derived::ColsAtCompileTime != Eigen::Dynamic
+                        && cols != Derived::ColsAtCompileTime)
+                    || rows < 0 || cols < 0) [[unlikely]]
+                {
+                    source_.setstate(std::ios::failbit);
+                    return *this;
+                }
+
+                value.resize(rows, cols);
+                source_.read(reinterpret_cast<char*>(value.data()), value.size() * sizeof(Scalar));
+                return *this;
+            }
+
+            bool good() const {return source_.good();}
+
+        private:
+            std::istream& source_;
+    };
+} // namespace tools
+
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * bit_stream.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_BIT_STREAM_HPP
+#define LJ_BIT_STREAM_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tools
+{
+    /**
+     * BitWriter and BitReader write and read a sequence of bits packed into bytes, least
+     * significant bit first.  They also provide Rice coding, which is a simple entropy code for
+     * unsigned integers that are mostly small:  the value u is written as the quotient u >> k in
+     * unary (that many 1 bits, then a 0 bit), followed by the low k bits of u.  Values whose
+     * quotient would be rice_escape or more are written as rice_escape 1 bits followed by all 64
+     * bits of the value, so that a poorly chosen k can never blow up the output.
+     * 
+     * Signed integers should first be mapped to unsigned ones with zigzag(), which interleaves
+     * them as 0, -1, 1, -2, 2, ... so that small magnitudes become small values.
+     */
+
+    inline constexpr int rice_escape = 32;
+
+    inline constexpr std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    inline constexpr std::int64_t unzigzag(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // The number of bits needed to Rice code the value with parameter k
+    inline constexpr std::uint64_t rice_length(std::uint64_t value, int k)
+    {
+        auto quotient = value >> k;
+        return quotient < rice_escape ? quotient + 1 + k : rice_escape + 64;
+    }
+
+    class BitWriter
+    {
+        public:
+            // Append the low count bits of value (count may be up to 64)
+            void write(std::uint64_t value, int count)
+            {
+                assert(0 <= count && count <= 64 && "Cannot write more than 64 bits at once");
+
+                while (count > 0)
+                {
+                    int take = std::min(count, 64 - pending_count_);
+                    auto bits = take == 64 ? value : value & ((std::uint64_t{1} << take) - 1);
+
+                    pending_ |= bits << pending_count_;
+                    pending_count_ += take;
+                    value = take == 64 ? 0 : value >> take;
+                    count -= take;
+
+                    if (pending_count_ == 64) {write_pending_(8);}
+                }
+            }
+
+            void write_rice(std::uint64_t value, int k)
+            {
+                auto quotient = value >> k;
+
+                if (quotient < rice_escape)
+                {
+                    write((std::uint64_t{1} << quotient) - 1, static_cast<int>(quotient) + 1);
+                    write(value, k);
+                }
+                else
+                {
+                    write((std::uint64_t{1} << rice_escape) - 1, rice_escape);
+                    write(value, 64);
+                }
+            }
+
+            // Write out any partial byte, and return the bytes
+            std::vector<std::uint8_t> finish()
+            {
+                write_pending_((pending_count_ + 7) / 8);
+                return std::move(bytes_);
+            }
+
+        private:
+            std::vector<std::uint8_t> bytes_;
+            std::uint64_t pending_{0};
+            int pending_count_{0};
+
+            void write_pending_(int byte_count)
+            {
+                for (int i = 0; i < byte_count; ++i)
+                {
+                    bytes_.push_back(static_cast<std::uint8_t>(pending_ >> (8 * i)));
+                }
+
+                pending_ = 0;
+                pending_count_ = 0;
+            }
+    };
+
+    class BitReader
+    {
+        public:
+            BitReader(const std::uint8_t* data, std::size_t size) : data_{data}, size_{size} {}
+
+            // Read count bits (up to 64); bits past the end of the data read as 0
+            std::uint64_t read(int count)
+            {
+                assert(0 <= count && count <= 64 && "Cannot read more than 64 bits at once");
+
+                if (count > 32)
+                {
+                    auto low = read(32);
+                    return low | (read(count - 32) << 32);
+                }
+
+                refill_();
+
+                auto mask = (std::uint64_t{1} << count) - 1;
+                auto value = available_ & mask;
+                consume_(count);
+                return value;
+            }
+
+            std::uint64_t read_rice(int k)
+            {
+                refill_();
+
+                // The unary part is at most rice_escape bits, which are all available after refill
+                auto quotient = std::min(std::countr_one(available_), rice_escape);
+
+                if (quotient == rice_escape)
+                {
+                    consume_(rice_escape);
+                    return read(64);
+                }
+
+                consume_(quotient + 1);
+                return (static_cast<std::uint64_t>(quotient) << k) | read(k);
+            }
+
+        private:
+            const std::uint8_t* data_;
+            std::size_t size_;
+            std::size_t position_{0};
+
+            std::uint64_t available_{0};
+            int available_count_{0};
+
+            // Make at least 57 bits available
+            void refill_()
+            {
+                while (available_count_ <= 56)
+                {
+                    std::uint64_t byte = position_ < size_ ? data_[position_] : 0;
+                    ++position_;
+
+                    available_ |= byte << available_count_;
+                    available_count_ += 8;
+                }
+            }
+
+            void consume_(int count)
+            {
+                available_ = count == 64 ? 0 : available_ >> count;
+                available_count_ -= count;
+            }
+    };
+} // namespace tools
+
+
+#endif
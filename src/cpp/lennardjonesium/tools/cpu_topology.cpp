@@ -0,0 +1,233 @@
+/**
+ * cpu_topology.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include <span>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <ranges>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <lennardjonesium/tools/cpu_topology.hpp>
+
+namespace fs = std::filesystem;
+
+namespace tools
+{
+    namespace
+    {
+        // The CPUs this process may run on (empty if this is unknown)
+        std::vector<int> allowed_cpus()
+        {
+            std::vector<int> cpus;
+
+#ifdef __linux__
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+
+            if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+            {
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if (CPU_ISSET(cpu, &cpu_set)) {cpus.push_back(cpu);}
+                }
+            }
+#endif
+
+            return cpus;
+        }
+
+        std::string read_line(const fs::path& path)
+        {
+            std::ifstream fin{path};
+            std::string line;
+            std::getline(fin, line);
+            return line;
+        }
+
+        // The index of a directory entry such as node3 or cpu12, or -1 if it has another name
+        int entry_index(const fs::path& path, const std::string& prefix)
+        {
+            auto name = path.filename().string();
+
+            if (!name.starts_with(prefix) || name.size() == prefix.size()) {return -1;}
+
+            auto digits = name.substr(prefix.size());
+            if (!std::ranges::all_of(digits, [](char c) {return c >= '0' && c <= '9';}))
+            {
+                return -1;
+            }
+
+            return std::stoi(digits);
+        }
+
+        // CPUs grouped by the given key, e.g. the NUMA node or the physical package
+        using Grouping = std::map<int, std::vector<int>>;
+
+        Grouping numa_nodes()
+        {
+            Grouping nodes;
+            std::error_code error;
+
+            for (const auto& entry : fs::directory_iterator{"/sys/devices/system/node", error})
+            {
+                int node = entry_index(entry.path(), "node");
+                if (node < 0) {continue;}
+
+                nodes[node] = parse_cpu_list(read_line(entry.path() / "cpulist"));
+            }
+
+            return nodes;
+        }
+
+        Grouping packages()
+        {
+            Grouping packages;
+            std::error_code error;
+
+            for (const auto& entry : fs::directory_iterator{"/sys/devices/system/cpu", error})
+            {
+                int cpu = entry_index(entry.path(), "cpu");
+                if (cpu < 0) {continue;}
+
+                auto package = read_line(entry.path() / "topology" / "physical_package_id");
+                if (package.empty()) {continue;}
+
+                packages[std::stoi(package)].push_back(cpu);
+            }
+
+            return packages;
+        }
+    }
+
+    std::vector<int> parse_cpu_list(const std::string& cpu_list)
+    {
+        std::vector<int> cpus;
+        std::istringstream input{cpu_list};
+        std::string range;
+
+        while (std::getline(input, range, ','))
+        {
+            if (range.empty()) {continue;}
+
+            auto dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+
+            for (int cpu = first; cpu <= last; ++cpu) {cpus.push_back(cpu);}
+        }
+
+        return cpus;
+    }
+
+    CpuTopology::CpuTopology(std::vector<std::vector<int>> nodes)
+    {
+        for (auto& node : nodes)
+        {
+            if (!node.empty()) {nodes_.push_back(std::move(node));}
+        }
+    }
+
+    CpuTopology CpuTopology::detect()
+    {
+        auto allowed = allowed_cpus();
+
+        auto grouping = numa_nodes();
+        if (grouping.empty()) {grouping = packages();}
+
+        std::vector<std::vector<int>> nodes;
+
+        for (const auto& group : grouping)
+        {
+            std::vector<int> node;
+
+            for (int cpu : group.second)
+            {
+                if (allowed.empty() || std::ranges::find(allowed, cpu) != allowed.end())
+                {
+                    node.push_back(cpu);
+                }
+            }
+
+            nodes.push_back(std::move(node));
+        }
+
+        CpuTopology topology{std::move(nodes)};
+
+        if (topology.node_count() == 0)
+        {
+            return CpuTopology{std::vector<std::vector<int>>{allowed}};
+        }
+
+        return topology;
+    }
+
+    int CpuTopology::cpu_count() const
+    {
+        int count = 0;
+        for (const auto& node : nodes_) {count += static_cast<int>(node.size());}
+        return count;
+    }
+
+    std::vector<int> CpuTopology::spread_order() const
+    {
+        std::vector<int> cpus;
+
+        for (std::size_t i = 0; static_cast<int>(cpus.size()) < cpu_count(); ++i)
+        {
+            for (const auto& node : nodes_)
+            {
+                if (i < node.size()) {cpus.push_back(node[i]);}
+            }
+        }
+
+        return cpus;
+    }
+
+    bool pin_this_thread(std::span<const int> cpus)
+    {
+#ifdef __linux__
+        if (cpus.empty()) {return false;}
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+
+        for (int cpu : cpus)
+        {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {CPU_SET(cpu, &cpu_set);}
+        }
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+        static_cast<void>(cpus);
+        return false;
+#endif
+    }
+} // namespace tools
@@ -0,0 +1,72 @@
+/**
+ * cpu_topology.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_CPU_TOPOLOGY_HPP
+#define LJ_CPU_TOPOLOGY_HPP
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tools
+{
+    class CpuTopology
+    {
+        /**
+         * CpuTopology describes which CPUs belong to which NUMA node, so that threads can be
+         * pinned near the memory they use.
+         * 
+         * detect() reads the NUMA nodes from /sys/devices/system/node, or failing that, groups
+         * the CPUs by socket (physical package).  Only the CPUs which this process is allowed to
+         * run on are counted, and nodes with no such CPUs are left out.  Where none of this
+         * information is available, all CPUs are put in a single node.
+         */
+
+        public:
+            explicit CpuTopology(std::vector<std::vector<int>> nodes);
+
+            static CpuTopology detect();
+
+            int node_count() const {return static_cast<int>(nodes_.size());}
+            int cpu_count() const;
+
+            // The CPUs of the given node
+            const std::vector<int>& node(int index) const {return nodes_.at(index);}
+
+            // All CPUs, taking one from each node in turn, so that consecutive entries are spread
+            // across the nodes
+            std::vector<int> spread_order() const;
+
+        private:
+            std::vector<std::vector<int>> nodes_;
+    };
+
+    // Restrict the calling thread to the given CPUs.  Returns false if that is not supported on
+    // this platform, or the CPUs are not available.
+    bool pin_this_thread(std::span<const int> cpus);
+
+    // Parse a Linux CPU list such as "0-3,8,10-11"
+    std::vector<int> parse_cpu_list(const std::string& cpu_list);
+} // namespace tools
+
+
+#endif
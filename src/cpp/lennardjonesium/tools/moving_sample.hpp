@@ -24,6 +24,7 @@
 #define LJ_MOVING_SAMPLE_HPP
 
 #include <cassert>
+#include <cstdint>
 #include <memory>
 #include <numeric>
 
@@ -31,6 +32,8 @@
 
 #include <Eigen/Dense>
 
+#include <lennardjonesium/tools/binary_stream.hpp>
+
 namespace detail
 {
     template<class T, class Alloc = std::allocator<T>>
@@ -48,6 +51,28 @@ namespace detail
             bool empty() const {return buffer_.empty();}
 
             bool full() const {return buffer_.full();}
+
+            // Write the current sample (oldest value first), e.g. for a checkpoint
+            void save(tools::BinaryWriter& writer) const
+            {
+                writer << static_cast<std::uint64_t>(buffer_.size());
+                for (const T& value : buffer_) {writer << value;}
+            }
+
+            // Replace the current sample with one written by save()
+            void restore(tools::BinaryReader& reader)
+            {
+                std::uint64_t count{};
+                reader >> count;
+
+                buffer_.clear();
+                for (std::uint64_t i = 0; i < count && reader.good(); ++i)
+                {
+                    T value;
+                    reader >> value;
+                    buffer_.push_back(value);
+                }
+            }
         
         protected:
             explicit MovingSampleBase(int size) : buffer_(size) {}
@@ -0,0 +1,71 @@
+/**
+ * object_pool.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_OBJECT_POOL_HPP
+#define LJ_OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <utility>
+
+#include <lennardjonesium/tools/spsc_ring.hpp>
+
+namespace tools
+{
+    template<class T>
+    class ObjectPool
+    {
+        /**
+         * ObjectPool recycles objects which own expensive resources (such as Eigen matrices, whose
+         * storage is on the heap) so that they can be handed back and forth between two threads
+         * without allocating new ones each time.  One thread acquire()s objects, fills them, and
+         * sends them to the other thread by some other means; the other thread recycle()s them
+         * when it is done.  Objects that were never recycled are simply default-constructed.
+         * 
+         * The recycled objects are passed back through an SpscRing, so there must be only one
+         * thread calling acquire() and one thread calling recycle().  If more than capacity
+         * objects are waiting to be reused, the oldest ones are destroyed.
+         * 
+         * NOTE: An acquired object is in whatever state it was left in when it was recycled, so
+         * the caller should overwrite all of it.  For Eigen matrices, assigning a matrix of the
+         * same size reuses the existing storage.
+         */
+
+        public:
+            explicit ObjectPool(std::size_t capacity)
+                : free_list_{capacity, BackpressurePolicy::drop_oldest}
+            {}
+
+            T acquire()
+            {
+                if (auto object = free_list_.try_get()) {return std::move(object.value());}
+                return T{};
+            }
+
+            void recycle(T object) {free_list_.put(std::move(object));}
+
+        private:
+            SpscRing<T> free_list_;
+    };
+} // namespace tools
+
+
+#endif
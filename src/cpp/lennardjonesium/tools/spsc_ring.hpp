@@ -0,0 +1,351 @@
+/**
+ * spsc_ring.hpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LJ_SPSC_RING_HPP
+#define LJ_SPSC_RING_HPP
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace tools
+{
+    // What SpscRing::put() does when the ring is full
+    enum class BackpressurePolicy
+    {
+        block,          // Sleep until the consumer makes room
+        drop_oldest,    // Discard the oldest message still in the ring
+        spin            // Busy-wait (yielding the processor) until the consumer makes room
+    };
+
+    template<class T>
+    class SpscRing
+    {
+        /**
+         * SpscRing is a bounded, lock-free queue for passing messages from exactly one producer
+         * thread to exactly one consumer thread.  It has the same put()/get()/close() interface
+         * as MessageBuffer, but put() never takes a lock: in the common case where the ring is
+         * neither full nor being waited on, it costs a few atomic loads and stores.
+         * 
+         * Each slot carries a sequence number which says whose turn it is to use the slot, as in
+         * Vyukov's bounded queue.  The consumer claims a slot by advancing the head with a
+         * compare-and-swap; this lets the producer also claim (and discard) the oldest slot when
+         * using BackpressurePolicy::drop_oldest, without ever touching a slot that the consumer
+         * is still reading.
+         * 
+         * When it has to wait, the consumer sleeps on a counter of produced messages using
+         * std::atomic::wait(), which only costs a system call if someone is actually asleep.
+         * The producer does the same under BackpressurePolicy::block.
+         * 
+         * drain() lets the consumer take everything that is currently available in one call,
+         * waking a blocked producer only once per batch.
+         * 
+         * NOTE: As with MessageBuffer, close() should be called after the producer is finished.
+         * Messages put() after close() are discarded.
+         */
+
+        public:
+            // The capacity is rounded up to a power of 2
+            explicit SpscRing(
+                std::size_t capacity, BackpressurePolicy policy = BackpressurePolicy::block
+            );
+
+            void put(T);
+            std::optional<T> get();
+
+            // Take a message if one is available, without waiting
+            std::optional<T> try_get();
+
+            // Wait until there is at least one message (or the ring is closed), then pass up to
+            // max_count messages to the callback.  Returns the number of messages passed, which
+            // is 0 only if the ring is closed and empty.
+            template<class Callback>
+            std::size_t drain(
+                Callback&& callback,
+                std::size_t max_count = std::numeric_limits<std::size_t>::max()
+            );
+
+            // The same as drain(), but returns 0 immediately if there are no messages
+            template<class Callback>
+            std::size_t try_drain(
+                Callback&& callback,
+                std::size_t max_count = std::numeric_limits<std::size_t>::max()
+            );
+
+            void close();
+
+            bool closed() const {return closed_.load(std::memory_order_acquire);}
+
+            std::size_t capacity() const {return mask_ + 1;}
+            BackpressurePolicy policy() const {return policy_;}
+
+            // The number of messages discarded under BackpressurePolicy::drop_oldest
+            std::uint64_t dropped() const {return dropped_.load(std::memory_order_relaxed);}
+
+        private:
+            struct Slot
+            {
+                std::atomic<std::uint64_t> sequence;
+                std::optional<T> value;
+            };
+
+            // Keep the indices written by each side on separate cache lines
+            static constexpr std::size_t cache_line_size_ = 64;
+
+            bool try_push_(T& message);
+
+            // Let a waiting producer know there is room
+            void notify_consumed_();
+
+            // Claim the oldest slot, if there is one.  On success, index holds its position.
+            bool try_claim_(std::uint64_t& index);
+            void release_(std::uint64_t index);
+
+            std::unique_ptr<Slot[]> slots_;
+            std::uint64_t mask_;
+            BackpressurePolicy policy_;
+
+            alignas(cache_line_size_) std::atomic<std::uint64_t> head_ = 0;
+            std::atomic<std::uint32_t> consumed_ = 0;
+
+            alignas(cache_line_size_) std::uint64_t tail_ = 0;
+            std::atomic<std::uint32_t> produced_ = 0;
+            std::atomic<std::uint64_t> dropped_ = 0;
+            std::atomic<bool> closed_ = false;
+    };
+
+    template<class T>
+    SpscRing<T>::SpscRing(std::size_t capacity, BackpressurePolicy policy)
+        : slots_{std::make_unique<Slot[]>(std::bit_ceil(capacity))},
+          mask_{std::bit_ceil(capacity) - 1},
+          policy_{policy}
+    {
+        assert(capacity > 0 && "SpscRing must have a positive capacity");
+
+        // A slot at position i is free for the producer when its sequence is i, and holds a
+        // message for the consumer when its sequence is i + 1
+        for (std::uint64_t i = 0; i <= mask_; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template<class T>
+    bool SpscRing<T>::try_push_(T& message)
+    {
+        auto& slot = slots_[tail_ & mask_];
+
+        if (slot.sequence.load(std::memory_order_acquire) != tail_) {return false;}
+
+        slot.value.emplace(std::move(message));
+        slot.sequence.store(tail_ + 1, std::memory_order_release);
+        ++tail_;
+
+        return true;
+    }
+
+    template<class T>
+    bool SpscRing<T>::try_claim_(std::uint64_t& index)
+    {
+        index = head_.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            auto sequence = slots_[index & mask_].sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::int64_t>(sequence - (index + 1));
+
+            if (difference < 0)
+            {
+                // The slot has not been filled yet, so the ring is empty
+                return false;
+            }
+            else if (difference > 0)
+            {
+                // Someone else claimed this slot since we read the head
+                index = head_.load(std::memory_order_relaxed);
+            }
+            else if (head_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+    }
+
+    template<class T>
+    void SpscRing<T>::release_(std::uint64_t index)
+    {
+        auto& slot = slots_[index & mask_];
+        slot.value.reset();
+        slot.sequence.store(index + mask_ + 1, std::memory_order_release);
+    }
+
+    template<class T>
+    void SpscRing<T>::notify_consumed_()
+    {
+        consumed_.fetch_add(1, std::memory_order_release);
+        consumed_.notify_one();
+    }
+
+    template<class T>
+    void SpscRing<T>::put(T message)
+    {
+        if (closed_.load(std::memory_order_relaxed)) {return;}
+
+        while (!try_push_(message))
+        {
+            switch (policy_)
+            {
+                case BackpressurePolicy::block:
+                {
+                    // Read the counter before trying again, so that a wakeup cannot be missed
+                    auto consumed = consumed_.load(std::memory_order_acquire);
+                    if (try_push_(message)) {break;}
+                    consumed_.wait(consumed, std::memory_order_acquire);
+                    continue;
+                }
+
+                case BackpressurePolicy::drop_oldest:
+                {
+                    // If the consumer is in the middle of reading the oldest slot, there may be
+                    // nothing to claim; then we simply try again.
+                    std::uint64_t index;
+                    if (try_claim_(index))
+                    {
+                        release_(index);
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    continue;
+                }
+
+                case BackpressurePolicy::spin:
+                    std::this_thread::yield();
+                    continue;
+            }
+
+            break;
+        }
+
+        produced_.fetch_add(1, std::memory_order_release);
+        produced_.notify_one();
+    }
+
+    template<class T>
+    std::optional<T> SpscRing<T>::get()
+    {
+        std::optional<T> message;
+
+        drain([&message](T&& value) {message.emplace(std::move(value));}, 1);
+
+        return message;
+    }
+
+    template<class T>
+    std::optional<T> SpscRing<T>::try_get()
+    {
+        std::uint64_t index;
+
+        if (!try_claim_(index)) {return std::nullopt;}
+
+        std::optional<T> message{std::move(slots_[index & mask_].value)};
+        release_(index);
+        notify_consumed_();
+
+        return message;
+    }
+
+    template<class T>
+    template<class Callback>
+    std::size_t SpscRing<T>::drain(Callback&& callback, std::size_t max_count)
+    {
+        std::size_t count = 0;
+        std::uint64_t index;
+
+        // Wait for the first message
+        while (true)
+        {
+            // Read the counter before trying, so that a wakeup cannot be missed
+            auto produced = produced_.load(std::memory_order_acquire);
+
+            if (try_claim_(index)) {break;}
+
+            if (closed_.load(std::memory_order_acquire))
+            {
+                // Anything put() before close() is visible now
+                if (try_claim_(index)) {break;}
+                return 0;
+            }
+
+            produced_.wait(produced, std::memory_order_acquire);
+        }
+
+        // Take whatever else is available without waiting
+        do
+        {
+            callback(std::move(*slots_[index & mask_].value));
+            release_(index);
+            ++count;
+        } while (count < max_count && try_claim_(index));
+
+        notify_consumed_();
+
+        return count;
+    }
+
+    template<class T>
+    template<class Callback>
+    std::size_t SpscRing<T>::try_drain(Callback&& callback, std::size_t max_count)
+    {
+        std::size_t count = 0;
+        std::uint64_t index;
+
+        while (count < max_count && try_claim_(index))
+        {
+            callback(std::move(*slots_[index & mask_].value));
+            release_(index);
+            ++count;
+        }
+
+        if (count > 0) {notify_consumed_();}
+
+        return count;
+    }
+
+    template<class T>
+    void SpscRing<T>::close()
+    {
+        closed_.store(true, std::memory_order_release);
+
+        // Wake the consumer, if it is waiting
+        produced_.fetch_add(1, std::memory_order_release);
+        produced_.notify_all();
+    }
+} // namespace tools
+
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * lj_spool.cpp
+ * 
+ * Copyright (c) 2021-2022 Benjamin E. Niehoff
+ * 
+ * This file is part of Lennard-Jonesium.
+ * 
+ * Lennard-Jonesium is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * Lennard-Jonesium is distributed in the hope that it will
+ * be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public
+ * License along with Lennard-Jonesium.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+/**
+ * lj_spool runs the simulations whose configs are dropped into a spool directory, for as long as
+ * it is left running (see api::SpoolDaemon):
+ * 
+ *      lj_spool <spool directory> [thread count] [affinity]
+ * 
+ * SIGINT or SIGTERM stop it, once the jobs it has already taken have finished.  SIGUSR1 makes the
+ * running simulations write checkpoints, if they have checkpoint files.
+ */
+
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <iostream>
+#include <exception>
+
+#include <lennardjonesium/api/simulation.hpp>
+#include <lennardjonesium/api/simulation_pool.hpp>
+#include <lennardjonesium/api/spool_daemon.hpp>
+
+namespace
+{
+    api::SpoolDaemon* running_daemon = nullptr;
+
+    extern "C" void stop_daemon(int)
+    {
+        if (running_daemon) {running_daemon->stop();}
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <spool directory> [thread count] [affinity]\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        api::SpoolDaemon::Parameters parameters{.spool_directory = argv[1]};
+
+        if (argc > 2) {parameters.thread_count = std::stoi(argv[2]);}
+        if (argc > 3) {parameters.affinity = api::SimulationPool::parse_affinity(argv[3]);}
+
+        api::SpoolDaemon daemon{parameters};
+
+        running_daemon = &daemon;
+        std::signal(SIGINT, stop_daemon);
+        std::signal(SIGTERM, stop_daemon);
+        api::Simulation::checkpoint_on_signal();
+
+        daemon.run(std::cout);
+
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        running_daemon = nullptr;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << argv[0] << ": " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
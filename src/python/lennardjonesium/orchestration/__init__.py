@@ -2,3 +2,5 @@ from lennardjonesium.orchestration.run import run
 from lennardjonesium.orchestration.sweep_configuration import SweepConfiguration
 from lennardjonesium.orchestration.sweep_result import SweepResult
 from lennardjonesium.orchestration.run_sweep import run_sweep
+from lennardjonesium.orchestration.result_cache import ResultCache
+from lennardjonesium.orchestration.work_queue import WorkQueue
@@ -0,0 +1,237 @@
+"""
+result_cache.py
+
+Copyright (c) 2021-2022 Benjamin E. Niehoff
+
+This file is part of Lennard-Jonesium.
+
+Lennard-Jonesium is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public
+License as published by the Free Software Foundation, either
+version 3 of the License, or (at your option) any later version.
+
+Lennard-Jonesium is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public
+License along with Lennard-Jonesium.  If not, see
+<https://www.gnu.org/licenses/>.
+"""
+
+
+import os
+import json
+import shutil
+import hashlib
+import pathlib
+import dataclasses
+from importlib import metadata
+from typing import Union, Optional
+
+from lennardjonesium.simulation import Configuration
+
+
+# Settings which do not affect the contents of the output files: the file names (the files are
+# stored by their role, not by name), and the way the files are written
+_IGNORED_SETTINGS = {
+    'system': ['thread_count', 'checkpoint_interval'],
+    'filepaths': [
+        'event_log', 'thermodynamic_log', 'observation_log', 'snapshot_log', 'final_state',
+        'initial_state', 'checkpoint', 'state_cache_megabytes', 'file_backend'
+    ]
+}
+
+# Settings of which only matters whether they are given at all
+_OPTIONAL_SETTINGS = {'filepaths': ['trajectory', 'state_cache']}
+
+
+def library_version() -> str:
+    """
+    The version of the installed lennardjonesium package, which is part of every cache key, so
+    that a new version of the library never reuses results of an older one.
+    """
+    try:
+        return metadata.version('lennardjonesium')
+    except metadata.PackageNotFoundError:
+        return 'unknown'
+
+
+class ResultCache:
+    """
+    ResultCache stores the output files of finished simulations in a directory, keyed by a hash of
+    everything that determines them: the run Configuration (apart from file names, see key()), the
+    key of the simulation whose final state it starts from (for warm starts), and the library
+    version.  When a sweep is run again, the points which are already in the cache have their files
+    restored instead of being re-run, so only the new points cost anything.
+
+    Each entry is a directory named by its key, which holds the files (named by their role, e.g.
+    'observation_log') and a manifest with their sizes and SHA-256 digests.  An entry is checked
+    against its manifest whenever it is restored, and removed if it fails the check.  Restored files
+    are hard links into the cache where possible, so a restored file must not be rewritten in place
+    (run_sweep() removes the old files of any point it runs); if it is, the check catches it.
+
+    Entries are written to a temporary directory and renamed into place, so that an interrupted
+    store never leaves a partial entry, and several sweeps can share the same cache.
+    """
+
+    manifest_name = 'manifest.json'
+
+    def __init__(self, directory: Union[str, pathlib.Path]):
+        self.directory = pathlib.Path(directory)
+        self.directory.mkdir(parents=True, exist_ok=True)
+
+    @staticmethod
+    def key(run_cfg: Configuration, previous_key: Optional[str] = None) -> str:
+        """
+        The cache key of a run: the SHA-256 digest of a canonical description of its Configuration
+        and the library version.  If the run starts from the final state of another run, then
+        previous_key must be the key of that run, which stands in for the state itself.
+        """
+        description = dataclasses.asdict(run_cfg)
+
+        for section, names in _IGNORED_SETTINGS.items():
+            for name in names:
+                del description[section][name]
+
+        for section, names in _OPTIONAL_SETTINGS.items():
+            for name in names:
+                description[section][name] = bool(description[section][name])
+
+        description['previous_key'] = previous_key
+        description['library_version'] = library_version()
+
+        canonical = json.dumps(description, sort_keys=True, separators=(',', ':'))
+        return hashlib.sha256(canonical.encode('utf-8')).hexdigest()
+
+    @staticmethod
+    def files(run_cfg: Configuration) -> dict[str, pathlib.Path]:
+        """
+        The output files of a run, by role, including those of its replicas (named as in
+        api::Simulation).  Checkpoints are not results, so they are not included.
+        """
+        filepaths = run_cfg.filepaths
+        logs = {
+            'event_log': filepaths.event_log,
+            'thermodynamic_log': filepaths.thermodynamic_log,
+            'observation_log': filepaths.observation_log,
+            'snapshot_log': filepaths.snapshot_log,
+            'trajectory': filepaths.trajectory,
+            'final_state': filepaths.final_state
+        }
+
+        files = {role: pathlib.Path(path) for role, path in logs.items() if path}
+
+        if run_cfg.system.replica_count > 1:
+            for replica in range(run_cfg.system.replica_count):
+                for role, path in logs.items():
+                    # Replica 0 writes the main files, except for its observations
+                    if not path or role == 'final_state' or (
+                        replica == 0 and role != 'observation_log'
+                    ):
+                        continue
+
+                    path = pathlib.Path(path)
+                    files[f'{role}.replica{replica}'] = path.with_name(
+                        f'{path.stem}.replica{replica}{path.suffix}'
+                    )
+
+        return files
+
+    def restore(self, key: str, files: dict[str, pathlib.Path]) -> bool:
+        """
+        Restores the files of the entry with the given key to the given paths (by role), and
+        returns True; or returns False if there is no valid entry.
+        """
+        entry = self.directory / key
+        manifest = self._verified_manifest(entry)
+
+        if manifest is None or not set(manifest['files']) <= set(files):
+            return False
+
+        for role, path in files.items():
+            path.parent.mkdir(parents=True, exist_ok=True)
+            path.unlink(missing_ok=True)
+
+            if role not in manifest['files']:
+                continue
+
+            try:
+                os.link(entry / role, path)
+            except OSError:
+                shutil.copyfile(entry / role, path)
+
+        return True
+
+    def store(self, key: str, files: dict[str, pathlib.Path]):
+        """
+        Stores copies of the given files (by role) under the given key.  Files which do not exist
+        (e.g. the final state of a run which aborted) are left out of the entry, and restored as
+        missing.
+        """
+        entry = self.directory / key
+
+        if entry.is_dir():
+            return
+
+        temporary = self.directory / f'.{key}.{os.getpid()}.tmp'
+        shutil.rmtree(temporary, ignore_errors=True)
+        temporary.mkdir()
+
+        manifest = {'key': key, 'library_version': library_version(), 'files': {}}
+
+        for role, path in files.items():
+            if not path.is_file():
+                continue
+
+            shutil.copyfile(path, temporary / role)
+            manifest['files'][role] = {
+                'size': (temporary / role).stat().st_size,
+                'sha256': _file_digest(temporary / role)
+            }
+
+        with open(temporary / ResultCache.manifest_name, 'w') as manifest_file:
+            json.dump(manifest, manifest_file, indent=4)
+
+        try:
+            temporary.rename(entry)
+        except OSError:
+            # Another sweep stored the same entry first
+            shutil.rmtree(temporary, ignore_errors=True)
+
+    def _verified_manifest(self, entry: pathlib.Path) -> Optional[dict]:
+        """
+        Reads the manifest of an entry and checks every file against it.  An entry which fails the
+        check is removed.
+        """
+        try:
+            with open(entry / ResultCache.manifest_name) as manifest_file:
+                manifest = json.load(manifest_file)
+
+            for role, expected in manifest['files'].items():
+                path = entry / role
+
+                if (path.stat().st_size != expected['size']
+                        or _file_digest(path) != expected['sha256']):
+                    raise ValueError(f'{path} does not match the manifest')
+        except FileNotFoundError:
+            if not entry.is_dir():
+                return None
+            shutil.rmtree(entry, ignore_errors=True)
+            return None
+        except (OSError, ValueError, KeyError):
+            shutil.rmtree(entry, ignore_errors=True)
+            return None
+
+        return manifest
+
+
+def _file_digest(path: pathlib.Path) -> str:
+    digest = hashlib.sha256()
+
+    with open(path, 'rb') as f:
+        for block in iter(lambda: f.read(1 << 20), b''):
+            digest.update(block)
+
+    return digest.hexdigest()
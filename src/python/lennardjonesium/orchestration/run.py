@@ -112,6 +112,14 @@ def _preamble(cfg: Configuration):
     Prints information about the simulation to be run from the given Configuration object
     """
 
+    phase_names = [cfg.equilibration.name, cfg.observation.name]
+    if cfg.minimization.enabled:
+        phase_names.insert(0, cfg.minimization.name)
+    
+    phase_list = '\n        '.join(
+        f'Phase {index}: {name}' for index, name in enumerate(phase_names, start=1)
+    )
+
     preamble = f"""\
         ==================== Lennard-Jones Simulation ====================
 
@@ -121,9 +129,8 @@ def _preamble(cfg: Configuration):
         Time Step: {cfg.system.time_delta}
         Random Seed: {cfg.system.random_seed}
 
-        Simulation will run in 2 phases:
-        Phase 1: {cfg.equilibration.name}
-        Phase 2: {cfg.observation.name}
+        Simulation will run in {len(phase_names)} phases:
+        {phase_list}
 
         Results to be output to the following files:
         Events: {cfg.filepaths.event_log}
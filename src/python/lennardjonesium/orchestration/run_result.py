@@ -26,6 +26,7 @@ from typing import Optional
 import pathlib
 
 from lennardjonesium.simulation import Configuration
+from lennardjonesium.tools.log_file import open_log
 
 
 class SimulationStatus(Enum):
@@ -50,6 +51,9 @@ class RunResult:
 
     simulation_status: Optional[SimulationStatus] = None
 
+    minimization_started: Optional[int] = None
+    minimization_completed: Optional[int] = None
+
     equilibration_started: Optional[int] = None
     equilibration_completed: Optional[int] = None
     equilibration_time_steps: Optional[int] = None
@@ -73,8 +77,12 @@ class RunResult:
         # Parse the contents of the event file and fill in information about the run
         self.temperature_adjustments = []
         self.observations_recorded = []
+
+        # The optional minimization phase is recognized by its name
+        self._minimization_name = cfg.minimization.name if cfg.minimization.enabled else None
         
-        with open(event_log_path, 'r') as event_log_file:
+        # The log may have been compressed (e.g. before transferring the results)
+        with open_log(event_log_path) as event_log_file:
             self._parse(event_log_file.readlines())
 
     def _parse(self, lines: list[str]):
@@ -91,15 +99,30 @@ class RunResult:
 
             # Look for phase started
             if rest.startswith('Phase started'):
-                if self.equilibration_started is None:
+                if rest.rstrip('\n') == f'Phase started: {self._minimization_name}':
+                    self.minimization_started = time_step
+                elif self.equilibration_started is None:
                     self.equilibration_started = time_step
                 else:
                     self.observation_started = time_step
                 continue
 
+            # Look for phases skipped (because an equilibrated state was loaded from a cache)
+            if rest.startswith('Phase skipped'):
+                if rest.rstrip('\n') == f'Phase skipped: {self._minimization_name}':
+                    self.minimization_started = time_step
+                    self.minimization_completed = time_step
+                else:
+                    self.equilibration_started = time_step
+                    self.equilibration_completed = time_step
+                    self.equilibration_time_steps = 0
+                continue
+
             # Look for phase complete
             if rest.startswith('Phase complete'):
-                if self.equilibration_completed is None:
+                if rest.rstrip('\n') == f'Phase complete: {self._minimization_name}':
+                    self.minimization_completed = time_step
+                elif self.equilibration_completed is None:
                     self.equilibration_completed = time_step
                     self.equilibration_time_steps = time_step - self.equilibration_started
                 else:
@@ -23,15 +23,19 @@ License along with Lennard-Jonesium.  If not, see
 
 import os
 import pathlib
-from typing import Union, Optional
+from typing import Union, Optional, List
 from types import FunctionType, BuiltinFunctionType
 from copy import deepcopy
 import time
 import textwrap
+import threading
 
 from lennardjonesium.simulation import Configuration, Simulation, SimulationPool
 from lennardjonesium.orchestration.sweep_configuration import SweepConfiguration
 from lennardjonesium.orchestration.sweep_result import SweepResult
+from lennardjonesium.orchestration.result_cache import ResultCache
+from lennardjonesium.orchestration.work_queue import WorkQueue
+from lennardjonesium.orchestration.run_result import RunResult
 
 
 def run_sweep(
@@ -42,7 +46,12 @@ def run_sweep(
     random_seed: Union[None, int, FunctionType, BuiltinFunctionType] = None,
     chunk_count: int = 1,
     chunk_index: int = 0,
-    sweep_config_object: Optional[SweepConfiguration] = None
+    sweep_config_object: Optional[SweepConfiguration] = None,
+    warm_start: Optional[str] = None,
+    state_cache: Union[None, str, pathlib.Path] = None,
+    result_cache: Union[None, str, pathlib.Path] = None,
+    work_queue: Union[None, str, pathlib.Path] = None,
+    heartbeat_timeout: float = 60.0
 ) -> SweepResult:
     """
     Wrapper function for running many simulations over a range of parameter space.
@@ -62,12 +71,13 @@ def run_sweep(
     
     :param polling_interval: If echo_status is enabled, controls how often (in seconds) we poll
         the SimulationPool object in order to check on the status of the jobs and update the
-        console printout.
+        console printout.  The printout is also updated as soon as any job completes.
     
     :param thread_count: The number of threads to use for running simulations in the sweep.
         A single simulation runs in its own thread (and uses a second thread for file IO), but if
         there are additional cores available, then multiple simulations can be run in parallel,
-        up to the number given by thread_count.
+        up to the number given by thread_count.  A simulation with replicas can use several of
+        these threads at once (see system.thread_count in the SweepConfiguration).
     
     :param random_seed: Can be None, an int, or a function which takes 0 arguments.
         If None, then use the pre-existing random seed from the individual run config file, if
@@ -87,12 +97,47 @@ def run_sweep(
         will be used in preference over the sweep_config_file, and the sweep_config_file will be
         overwritten with the data provided by the sweep_config_object.
     
+    :param warm_start: Can be None, 'temperature', or 'density'.
+        If None, every simulation starts from a fresh lattice.
+        If 'temperature', the simulations at each density form a chain from the highest temperature
+            to the lowest, and each one starts from the final state of the one before it (with the
+            velocities rescaled to the new temperature).
+        If 'density', the simulations at each temperature form a chain from the lowest density to
+            the highest, and each one starts from the final state of the one before it (with the
+            positions and box rescaled to the new density).
+        Each chain runs on a single thread, so this is most useful when there are at least as many
+        chains as threads.  A simulation whose predecessor did not complete starts from a lattice.
+    
+    :param state_cache: An optional directory for caching equilibrated states.  Simulations whose
+        parameters match a cached entry (from this or any earlier sweep) skip equilibration and
+        start observing from the cached state; the others add their equilibrated state to the
+        cache.  The directory can be shared between sweeps.
+    
+    :param result_cache: An optional directory for caching the output files of simulations (see
+        ResultCache).  Simulations whose configuration (and random seed, and warm start) match a
+        cached entry are not run; their output files are restored from the cache instead.  The
+        others add their output files to the cache when they finish.  This makes it cheap to re-run
+        a sweep after extending its range.  The directory can be shared between sweeps.
+    
+    :param work_queue: An optional directory on a file system shared by several nodes, for running
+        the sweep on all of them at once (see WorkQueue).  Call run_sweep() with the same arguments
+        on every node; the first one puts the chains of the sweep into the queue, and then each
+        node takes chains from it whenever one of its threads is free, until the sweep is done.
+        This replaces chunk_count and chunk_index, which must be left at their defaults.  The
+        returned SweepResult covers the whole sweep.
+    
+    :param heartbeat_timeout: In distributed mode, the number of seconds after which the chains
+        claimed by a node which has stopped responding are run again by another node.
+    
     We will always output a config file with the random seed actually used, which will overwrite
     the original config file.
     """
 
     sweep_config_filepath = pathlib.Path(sweep_config_file).resolve()
 
+    if work_queue is not None and (chunk_count, chunk_index) != (1, 0):
+        raise ValueError('chunk_count and chunk_index cannot be combined with work_queue')
+
     if not sweep_config_filepath.is_file() and sweep_config_object is None:
         raise ValueError(
             'sweep_config_object must be given if sweep_config_file is not an existing file'
@@ -105,21 +150,45 @@ def run_sweep(
         sweep_config_filepath.parent.mkdir(parents=True, exist_ok=True)
         sweep_cfg.write(sweep_config_filepath)
     
+    # The cache directory must be resolved before changing the working directory
+    if state_cache is not None:
+        state_cache = pathlib.Path(state_cache).resolve()
+
+    if result_cache is not None:
+        result_cache = ResultCache(pathlib.Path(result_cache).resolve())
+
+    if work_queue is not None:
+        work_queue = WorkQueue(pathlib.Path(work_queue).resolve(), heartbeat_timeout)
+
     # Change working directory to the directory where the sweep config file is located
     cwd = os.getcwd()
     os.chdir(sweep_config_filepath.parent)
 
+    if work_queue is not None:
+        try:
+            _run_distributed(
+                sweep_cfg, work_queue, echo_status, polling_interval, thread_count, random_seed,
+                warm_start, state_cache, result_cache
+            )
+        finally:
+            os.chdir(cwd)
+
+        return SweepResult(sweep_config_filepath)
+
     # Get the simulations and push them onto a SimulationPool to run them
-    simulations = _create_simulations(sweep_cfg, random_seed, chunk_count, chunk_index)
+    chains, pending_results, restored_count = _create_simulations(
+        sweep_cfg, random_seed, chunk_count, chunk_index, warm_start, state_cache, result_cache
+    )
     pool = SimulationPool(thread_count)
-    job_count = len(simulations)
+    job_count = sum(len(chain) for chain in chains)
 
-    if echo_status: _preamble(sweep_cfg, job_count, thread_count, chunk_count, chunk_index)
+    if echo_status:
+        _preamble(sweep_cfg, job_count, thread_count, chunk_count, chunk_index, restored_count)
 
     start_time = time.perf_counter()
 
-    for simulation in simulations:
-        pool.push(simulation)
+    for chain in chains:
+        pool.push_chain(chain)
     
     if echo_status: _report_pool_status(pool, job_count, start_time, polling_interval)
     
@@ -128,6 +197,8 @@ def run_sweep(
 
     end_time = time.perf_counter()
 
+    _store_results(result_cache, pending_results)
+
     # Restore working directory
     os.chdir(cwd)
 
@@ -139,12 +210,111 @@ def run_sweep(
     return sweep_result
 
 
+def _run_distributed(
+    sweep_cfg: SweepConfiguration,
+    work_queue: WorkQueue,
+    echo_status: bool,
+    polling_interval: float,
+    thread_count: int,
+    random_seed: Union[None, int, FunctionType, BuiltinFunctionType] = None,
+    warm_start: Optional[str] = None,
+    state_cache: Optional[pathlib.Path] = None,
+    result_cache: Optional[ResultCache] = None
+):
+    """
+    Runs chains from the work queue on thread_count threads, until every chain in the queue is
+    done (including those claimed by other nodes, which may have to be run again here if their
+    node dies).  Each chain is a job, named by its index in the sweep.
+
+    Precondition: Our working directory is the same directory that contains the sweep config file.
+    """
+    chains = _chain_points(sweep_cfg, 1, 0, warm_start)
+    work_queue.populate((f'{index:06d}', chain) for index, chain in enumerate(chains))
+
+    if echo_status:
+        _preamble(sweep_cfg, sum(len(chain) for chain in chains), thread_count, 1, 0)
+
+    # An exception in any worker stops them all, and is raised again once they have stopped
+    errors = []
+    stop = threading.Event()
+
+    def worker(slot: int):
+        while not stop.is_set() and not work_queue.finished():
+            job = work_queue.claim(f'.{slot}')
+
+            # The remaining chains are running elsewhere, but we may have to take over some of them
+            if job is None:
+                stop.wait(work_queue.heartbeat_timeout / 4)
+                continue
+
+            try:
+                chain, pending_results, _ = _create_chain(
+                    sweep_cfg, job.data, random_seed, state_cache, result_cache
+                )
+
+                # The GIL is released while each Simulation runs
+                for simulation in chain:
+                    simulation.run(echo=False)
+
+                _store_results(result_cache, pending_results)
+            except Exception as error:
+                work_queue.release(job)
+                errors.append(error)
+                stop.set()
+            else:
+                work_queue.complete(job)
+
+    start_time = time.perf_counter()
+
+    with work_queue:
+        workers = [threading.Thread(target=worker, args=(slot,)) for slot in range(thread_count)]
+
+        for thread in workers:
+            thread.start()
+
+        while any(thread.is_alive() for thread in workers):
+            if echo_status:
+                pending, claimed, done = work_queue.counts()
+                print(
+                    'Chains pending: {}, Running: {}, Done: {}, Elapsed time: {:.2f} seconds     '
+                    .format(pending, claimed, done, time.perf_counter() - start_time),
+                    flush=True,
+                    end='\r'
+                )
+
+            time.sleep(polling_interval)
+
+        for thread in workers:
+            thread.join()
+
+    if errors:
+        raise errors[0]
+
+    if echo_status:
+        print()
+        print('End simulation sweep', flush=True)
+
+
+def _store_results(
+    result_cache: Optional[ResultCache],
+    pending_results: list[tuple[str, dict, pathlib.Path]]
+):
+    """
+    Stores the output of every simulation which ran to the end of a phase (i.e., did not fail for
+    reasons outside the simulation, such as a full disk) in the result cache.
+    """
+    for key, files, run_config_file in pending_results:
+        if RunResult(run_config_file).simulation_status is not None:
+            result_cache.store(key, files)
+
+
 def _preamble(
     sweep_cfg: SweepConfiguration,
     job_count: int,
     thread_count: int,
     chunk_count: int,
-    chunk_index: int
+    chunk_index: int,
+    restored_count: int = 0
 ):
     """
     Prints information about the sweep before running it
@@ -159,7 +329,7 @@ def _preamble(
         Time Step: {time_step}
 
         Chunk {chunk_number} of {chunk_count} (index {chunk_index})
-        Running {job_count} jobs over {thread_count} threads
+        Running {job_count} jobs over {thread_count} threads ({restored_count} restored from cache)
 
         Begin simulation sweep...""".format(
             temp_start=sweep_cfg.system.temperature_start,
@@ -174,7 +344,8 @@ def _preamble(
             chunk_count=chunk_count,
             chunk_index=chunk_index,
             job_count=job_count,
-            thread_count=thread_count
+            thread_count=thread_count,
+            restored_count=restored_count
         )
 
     print(textwrap.dedent(preamble), flush=True)
@@ -220,31 +391,72 @@ def _report_pool_status(
     """
     while True:
         status = pool.status()
+        progress = pool.progress()
         elapsed_time = time.perf_counter() - start_time
+
+        # Total throughput of the running jobs, and a rough prediction of the sweep's completion
+        steps_per_second = sum(entry.steps_per_second for entry in progress)
+        remaining = _predict_remaining_time(status, progress)
+        remaining_text = f'{remaining:.0f} seconds' if remaining is not None else 'unknown'
+
         print(
-            'Jobs queued: {}, Running: {}, Completed: {}, Elapsed time: {:.2f} seconds     '.format(
-                status.waiting, status.running, status.completed, elapsed_time
+            'Jobs queued: {}, Running: {}, Completed: {}, Elapsed time: {:.2f} seconds, '
+            'Throughput: {:.0f} steps/sec, Remaining: {}     '.format(
+                status.waiting, status.running, status.completed, elapsed_time,
+                steps_per_second, remaining_text
             ),
             flush=True,
             end='\r'
         )
         if status.completed == job_count:
             break
-        time.sleep(polling_interval)
+        # Refresh as soon as a job completes, or after polling_interval at the latest
+        pool.wait_for_completion(polling_interval)
     
     # We need one final newline so that the next print statement will not overwrite the above
     # output
     print()
 
 
+def _predict_remaining_time(
+    status: SimulationPool.Status,
+    progress: List[SimulationPool.JobProgress]
+) -> Optional[float]:
+    """
+    Predicts the time until the sweep finishes: the running jobs finish according to their own
+    ETAs, and the waiting jobs are completed at the same rate as the jobs so far.  Returns None
+    until there is anything to go on.
+    """
+    running_eta = max(
+        (entry.eta_seconds for entry in progress if entry.eta_seconds is not None), default=0.0
+    )
+
+    if status.waiting == 0:
+        return running_eta
+
+    if status.completed == 0:
+        return None
+
+    return running_eta + status.waiting * status.makespan / status.completed
+
+
 def _create_simulations(
     sweep_cfg: SweepConfiguration,
     random_seed: Union[None, int, FunctionType, BuiltinFunctionType] = None,
     chunk_count: int = 1,
     chunk_index: int = 0,
-) -> list[Simulation]:
+    warm_start: Optional[str] = None,
+    state_cache: Optional[pathlib.Path] = None,
+    result_cache: Optional[ResultCache] = None
+) -> tuple[list[list[Simulation]], list[tuple[str, dict, pathlib.Path]], int]:
     """
-    Creates a list of Simulation objects for each (temperature, density) pair in the sweep.
+    Creates Simulation objects for each (temperature, density) pair in the sweep, grouped into
+    chains which must be run in order (see the warm_start parameter of run_sweep()).  Without warm
+    starts, every chain contains a single Simulation.
+
+    If a result_cache is given, then the simulations at the start of each chain whose results are
+    in the cache are restored rather than created.  Also returns the (key, files, run config file)
+    of each created Simulation, for storing its results afterwards, and the number restored.
 
     Precondition: Our working directory is the same directory that contains the sweep config file,
         so that relative directories from this location make sense.
@@ -252,9 +464,41 @@ def _create_simulations(
     Postcondition: All of the individual simulation directories will be created, and the individual
         run config files will be written (which allows simulations to be easily re-run)
     """
-    simulations = []
+    chains = []
+    pending_results = []
+    restored_count = 0
+
+    for chain_points in _chain_points(sweep_cfg, chunk_count, chunk_index, warm_start):
+        chain, chain_results, chain_restored = _create_chain(
+            sweep_cfg, chain_points, random_seed, state_cache, result_cache
+        )
+
+        if chain:
+            chains.append(chain)
 
-    for temperature, density in sweep_cfg.sweep_range(chunk_count, chunk_index):
+        pending_results.extend(chain_results)
+        restored_count += chain_restored
+    
+    return chains, pending_results, restored_count
+
+
+def _create_chain(
+    sweep_cfg: SweepConfiguration,
+    chain_points: list[tuple[float, float]],
+    random_seed: Union[None, int, FunctionType, BuiltinFunctionType] = None,
+    state_cache: Optional[pathlib.Path] = None,
+    result_cache: Optional[ResultCache] = None
+) -> tuple[list[Simulation], list[tuple[str, dict, pathlib.Path]], int]:
+    """
+    Creates the Simulations of a single chain, as described in _create_simulations().
+    """
+    chain = []
+    pending_results = []
+    restored_count = 0
+    previous_dir = None
+    previous_key = None
+
+    for temperature, density in chain_points:
         # Get the directory where the individual simulation will be run
         simulation_dir = sweep_cfg.simulation_dir(temperature, density)
         run_config_file = simulation_dir / sweep_cfg.templates.run_config_file
@@ -262,6 +506,16 @@ def _create_simulations(
         # Create run configuration object (introduces default random seed)
         run_cfg = _create_run_configuration(sweep_cfg, temperature, density)
 
+        # Start from the final state of the previous simulation in the chain (the path is
+        # relative to the simulation directory, like the other paths in the run config)
+        if previous_dir is not None:
+            run_cfg.filepaths.initial_state = os.path.relpath(
+                previous_dir / sweep_cfg.filenames.final_state, simulation_dir
+            )
+        
+        if state_cache is not None:
+            run_cfg.filepaths.state_cache = str(state_cache)
+
         # Determine whether random seed should be updated
         if random_seed is None and run_config_file.is_file():
             existing_cfg = Configuration.from_file(run_config_file)
@@ -279,10 +533,57 @@ def _create_simulations(
         # the Simulation object, we must prepend the simulation_dir to the output filepaths
         _prepend_simulation_dir(simulation_dir, run_cfg)
 
-        # Now create a Simulation and append it to the list
-        simulations.append(Simulation(run_cfg))
+        if result_cache is not None:
+            key = ResultCache.key(run_cfg, previous_key)
+            files = ResultCache.files(run_cfg)
+            previous_key = key
+
+            # Once a simulation in the chain has to run, the rest must run after it
+            if not chain and result_cache.restore(key, files):
+                restored_count += 1
+                previous_dir = simulation_dir
+                continue
+
+            # The old files may be hard links into the cache, which must not be overwritten
+            for path in files.values():
+                path.unlink(missing_ok=True)
+
+            pending_results.append((key, files, run_config_file))
+
+        # Now create a Simulation and append it to the chain
+        chain.append(Simulation(run_cfg))
+        previous_dir = simulation_dir
+
+    return chain, pending_results, restored_count
+
+
+def _chain_points(
+    sweep_cfg: SweepConfiguration,
+    chunk_count: int = 1,
+    chunk_index: int = 0,
+    warm_start: Optional[str] = None
+) -> list[list[tuple[float, float]]]:
+    """
+    Groups the (temperature, density) pairs of the sweep chunk into chains for warm starts.
+    """
+    points = list(sweep_cfg.sweep_range(chunk_count, chunk_index))
+
+    if warm_start is None:
+        return [[point] for point in points]
+    elif warm_start == 'temperature':
+        # Cool down from the fluid at each density
+        key, order, reverse = (lambda p: p[1]), (lambda p: p[0]), True
+    elif warm_start == 'density':
+        # Compress gradually at each temperature
+        key, order, reverse = (lambda p: p[0]), (lambda p: p[1]), False
+    else:
+        raise ValueError("warm_start must be None, 'temperature', or 'density'")
+    
+    groups = {}
+    for point in points:
+        groups.setdefault(key(point), []).append(point)
     
-    return simulations
+    return [sorted(group, key=order, reverse=reverse) for group in groups.values()]
 
 
 def _prepend_simulation_dir(simulation_dir: pathlib.Path, run_cfg: Configuration):
@@ -293,6 +594,13 @@ def _prepend_simulation_dir(simulation_dir: pathlib.Path, run_cfg: Configuration
     run_cfg.filepaths.thermodynamic_log = str(simulation_dir / run_cfg.filepaths.thermodynamic_log)
     run_cfg.filepaths.observation_log = str(simulation_dir / run_cfg.filepaths.observation_log)
     run_cfg.filepaths.snapshot_log = str(simulation_dir / run_cfg.filepaths.snapshot_log)
+    run_cfg.filepaths.final_state = str(simulation_dir / run_cfg.filepaths.final_state)
+
+    if run_cfg.filepaths.initial_state:
+        run_cfg.filepaths.initial_state = str(simulation_dir / run_cfg.filepaths.initial_state)
+
+    if run_cfg.filepaths.trajectory:
+        run_cfg.filepaths.trajectory = str(simulation_dir / run_cfg.filepaths.trajectory)
 
 
 def _create_run_configuration(
@@ -310,6 +618,20 @@ def _create_run_configuration(
     run_cfg.system.particle_count = sweep_cfg.system.particle_count
     run_cfg.system.cutoff_distance = sweep_cfg.system.cutoff_distance
     run_cfg.system.time_delta = sweep_cfg.system.time_delta
+    run_cfg.system.replica_count = sweep_cfg.system.replica_count
+    run_cfg.system.thread_count = sweep_cfg.system.thread_count
+    run_cfg.system.snapshot_interval = sweep_cfg.system.snapshot_interval
+
+    run_cfg.minimization.enabled = sweep_cfg.minimization.enabled
+    run_cfg.minimization.name = (sweep_cfg.templates.phase_name.format(
+        temperature=temperature, density=density, name=sweep_cfg.minimization.name
+    ))
+    run_cfg.minimization.energy_tolerance = sweep_cfg.minimization.energy_tolerance
+    run_cfg.minimization.check_interval = sweep_cfg.minimization.check_interval
+    run_cfg.minimization.mixing = sweep_cfg.minimization.mixing
+    run_cfg.minimization.mixing_decay = sweep_cfg.minimization.mixing_decay
+    run_cfg.minimization.delay = sweep_cfg.minimization.delay
+    run_cfg.minimization.timeout = sweep_cfg.minimization.timeout
 
     run_cfg.equilibration.name = (sweep_cfg.templates.phase_name.format(
         temperature=temperature, density=density, name=sweep_cfg.equilibration.name
@@ -332,5 +654,7 @@ def _create_run_configuration(
     run_cfg.filepaths.thermodynamic_log = sweep_cfg.filenames.thermodynamic_log
     run_cfg.filepaths.observation_log = sweep_cfg.filenames.observation_log
     run_cfg.filepaths.snapshot_log = sweep_cfg.filenames.snapshot_log
+    run_cfg.filepaths.final_state = sweep_cfg.filenames.final_state
+    run_cfg.filepaths.trajectory = sweep_cfg.filenames.trajectory
 
     return run_cfg
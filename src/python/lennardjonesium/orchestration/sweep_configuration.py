@@ -55,6 +55,9 @@ class SweepConfiguration(INIParsable, DictParsable):
         particle_count: int = 100
         cutoff_distance: float = 2.5
         time_delta: float = 0.005
+        replica_count: int = 1
+        thread_count: int = 0
+        snapshot_interval: int = 0
     
     @dataclass
     class _Templates:
@@ -67,6 +70,17 @@ class SweepConfiguration(INIParsable, DictParsable):
         run_config_file: str = 'run.ini'
         phase_name: str = '(T={temperature:f}, d={density:f}) {name}'
     
+    @dataclass
+    class _Minimization:
+        enabled: bool = False
+        name: str = 'Minimization Phase'
+        energy_tolerance: float = 1.0e-6
+        check_interval: int = 20
+        mixing: float = 0.1
+        mixing_decay: float = 0.99
+        delay: int = 5
+        timeout: int = 2000
+    
     @dataclass
     class _Equilibration:
         name: str = 'Equilibration Phase'
@@ -95,10 +109,13 @@ class SweepConfiguration(INIParsable, DictParsable):
         thermodynamic_log: str = 'thermodynamics.csv'
         observation_log: str = 'observations.csv'
         snapshot_log: str = 'snapshots.csv'
+        final_state: str = 'final_state.bin'
+        trajectory: str = ''
     
     # Since these are mutable, they need to be specified with a default factory
     system: _System = field(default_factory=_System)
     templates: _Templates = field(default_factory=_Templates)
+    minimization: _Minimization = field(default_factory=_Minimization)
     equilibration: _Equilibration = field(default_factory=_Equilibration)
     observation: _Observation = field(default_factory=_Observation)
     filenames: _Filenames = field(default_factory=_Filenames)
@@ -0,0 +1,249 @@
+"""
+work_queue.py
+
+Copyright (c) 2021-2022 Benjamin E. Niehoff
+
+This file is part of Lennard-Jonesium.
+
+Lennard-Jonesium is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public
+License as published by the Free Software Foundation, either
+version 3 of the License, or (at your option) any later version.
+
+Lennard-Jonesium is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public
+License along with Lennard-Jonesium.  If not, see
+<https://www.gnu.org/licenses/>.
+"""
+
+
+
+import os
+import json
+import time
+import fcntl
+import socket
+import pathlib
+import threading
+from dataclasses import dataclass
+from typing import Union, Optional, Iterable
+
+
+@dataclass
+class Job:
+    """
+    A job claimed from a WorkQueue.  The data is whatever was put into the queue for it.
+    """
+    name: str
+    data: object
+    claim_path: pathlib.Path
+
+
+class WorkQueue:
+    """
+    WorkQueue is a queue of jobs kept in a directory on a shared file system, so that workers on
+    any number of nodes can take jobs from it as they become free, with no server to coordinate
+    them.  Each job is a JSON file, and moves through three subdirectories:
+
+        pending/    jobs waiting for a worker
+        claimed/    jobs being run, renamed to '<job>@<worker>'
+        done/       finished jobs
+
+    A worker claims a job by renaming it from pending/ into claimed/.  Only one rename of the same
+    file can succeed, so each job is claimed by exactly one worker (this needs only atomic rename,
+    which NFS and the usual cluster file systems provide).
+
+    While a worker runs a job, it touches the claim file every heartbeat_timeout / 4 seconds.  A
+    claim which has not been touched for heartbeat_timeout seconds belongs to a worker that died,
+    and any worker may rename it back into pending/ to be run again.  The timeout must be much
+    longer than any difference between the clocks of the nodes and the file server.  A job is
+    touched just before it is claimed, so a fresh claim never looks stale, and a stale claim is
+    checked again after it has been set aside, so a claim touched in the meantime is left alone.
+    """
+
+    def __init__(
+        self,
+        directory: Union[str, pathlib.Path],
+        heartbeat_timeout: float = 60.0,
+        worker_name: Optional[str] = None
+    ):
+        self.directory = pathlib.Path(directory)
+        self.heartbeat_timeout = heartbeat_timeout
+        self.worker_name = worker_name or f'{socket.gethostname()}-{os.getpid()}'
+
+        self.pending_dir = self.directory / 'pending'
+        self.claimed_dir = self.directory / 'claimed'
+        self.done_dir = self.directory / 'done'
+
+        for subdirectory in (self.pending_dir, self.claimed_dir, self.done_dir):
+            subdirectory.mkdir(parents=True, exist_ok=True)
+
+        self._claims = set()
+        self._claims_lock = threading.Lock()
+        self._stop_heartbeat = threading.Event()
+        self._heartbeat_thread = None
+
+    def populate(self, jobs: Iterable[tuple[str, object]]) -> bool:
+        """
+        Puts the given (name, data) jobs into the queue, unless it has been populated before.
+        Several workers may call this at the same time; the first one populates the queue, under
+        an flock(), and the rest return False.
+        """
+        with open(self.directory / 'lock', 'a') as lock_file:
+            fcntl.flock(lock_file, fcntl.LOCK_EX)
+
+            try:
+                if (self.directory / 'populated').exists():
+                    return False
+
+                for name, data in jobs:
+                    temporary = self.directory / f'.{name}.tmp'
+
+                    with open(temporary, 'w') as job_file:
+                        json.dump(data, job_file)
+
+                    temporary.rename(self.pending_dir / name)
+
+                (self.directory / 'populated').touch()
+                return True
+            finally:
+                fcntl.flock(lock_file, fcntl.LOCK_UN)
+
+    def claim(self, worker_suffix: str = '') -> Optional[Job]:
+        """
+        Claims a pending job, reclaiming stale jobs first if there are none.  Returns None if no
+        job could be claimed.  The claim is kept alive by the heartbeat until complete() is called.
+        """
+        for attempt in range(2):
+            for pending in sorted(self.pending_dir.iterdir()):
+                claim_path = self.claimed_dir / f'{pending.name}@{self.worker_name}{worker_suffix}'
+
+                # The rename keeps the modification time of the pending file, so touch it first,
+                # or else a job which has waited a long time would look stale as soon as we claim it
+                try:
+                    os.utime(pending)
+                    pending.rename(claim_path)
+                except FileNotFoundError:
+                    # Another worker got there first
+                    continue
+
+                with self._claims_lock:
+                    self._claims.add(claim_path)
+
+                try:
+                    with open(claim_path) as job_file:
+                        return Job(pending.name, json.load(job_file), claim_path)
+                except FileNotFoundError:
+                    # Reclaimed already, so another worker will run it
+                    with self._claims_lock:
+                        self._claims.discard(claim_path)
+
+            if attempt == 0 and not self.reclaim_stale():
+                break
+
+        return None
+
+    def complete(self, job: Job):
+        """
+        Marks a claimed job as done.  If the job was reclaimed in the meantime (because our
+        heartbeat was late), then the other worker will finish it, and this does nothing.
+        """
+        with self._claims_lock:
+            self._claims.discard(job.claim_path)
+
+        try:
+            job.claim_path.rename(self.done_dir / job.name)
+        except FileNotFoundError:
+            pass
+
+    def release(self, job: Job):
+        """
+        Returns a claimed job to the pending queue without running it, e.g. after an error.
+        """
+        with self._claims_lock:
+            self._claims.discard(job.claim_path)
+
+        try:
+            job.claim_path.rename(self.pending_dir / job.name)
+        except FileNotFoundError:
+            pass
+
+    def reclaim_stale(self) -> int:
+        """
+        Returns the claimed jobs whose heartbeats have stopped to the pending queue, and returns how
+        many there were.
+        """
+        reclaimed = 0
+        now = time.time()
+
+        for claim_path in self.claimed_dir.iterdir():
+            # Set the claim aside under a name of our own before checking it again, since its owner
+            # may have touched it (or claimed the job afresh) since we looked.  If we die meanwhile,
+            # the renamed claim is itself stale, and is reclaimed by someone else.
+            private_path = claim_path.with_name(f'{claim_path.name}.reclaim-{self.worker_name}')
+
+            try:
+                if now - claim_path.stat().st_mtime < self.heartbeat_timeout:
+                    continue
+
+                claim_path.rename(private_path)
+            except FileNotFoundError:
+                # Completed, or reclaimed by another worker
+                continue
+
+            try:
+                if time.time() - private_path.stat().st_mtime < self.heartbeat_timeout:
+                    private_path.rename(claim_path)
+                    continue
+
+                private_path.rename(self.pending_dir / claim_path.name.rpartition('@')[0])
+                reclaimed += 1
+            except FileNotFoundError:
+                continue
+
+        return reclaimed
+
+    def counts(self) -> tuple[int, int, int]:
+        """
+        The numbers of pending, claimed, and done jobs.
+        """
+        return tuple(
+            sum(1 for _ in directory.iterdir())
+            for directory in (self.pending_dir, self.claimed_dir, self.done_dir)
+        )
+
+    def finished(self) -> bool:
+        """
+        Whether the queue has been populated and every job in it is done.
+        """
+        pending, claimed, _ = self.counts()
+        return (self.directory / 'populated').exists() and pending == 0 and claimed == 0
+
+    def __enter__(self):
+        self._stop_heartbeat.clear()
+        self._heartbeat_thread = threading.Thread(target=self._heartbeat, daemon=True)
+        self._heartbeat_thread.start()
+        return self
+
+    def __exit__(self, *exception_info):
+        self._stop_heartbeat.set()
+        self._heartbeat_thread.join()
+
+    def _heartbeat(self):
+        """
+        Touches our claim files until the queue is exited.
+        """
+        while not self._stop_heartbeat.wait(self.heartbeat_timeout / 4):
+            with self._claims_lock:
+                claims = list(self._claims)
+
+            for claim_path in claims:
+                try:
+                    os.utime(claim_path)
+                except FileNotFoundError:
+                    # Reclaimed by another worker, which will run the job again
+                    pass
@@ -46,6 +46,33 @@ cdef extern from "<lennardjonesium/api/configuration.hpp>" namespace "api" nogil
             
             # Time step size
             double time_delta
+
+            # Checkpoint interval
+            int checkpoint_interval
+
+            # Trajectory frame interval
+            int snapshot_interval
+            double trajectory_position_precision
+            double trajectory_velocity_precision
+            int trajectory_keyframe_interval
+
+            # Number of independent replicas
+            int replica_count
+            int thread_count
+        
+        cppclass _Minimization "api::Configuration::Minimization":
+            _Minimization() except +
+
+            bint enabled
+            string name
+            double energy_tolerance
+            int check_interval
+            double mixing
+            double mixing_decay
+            int delay
+            int timeout
+            int thermodynamic_log_interval
+            bint thermodynamic_log_aggregate
         
         cppclass _Equilibration "api::Configuration::Equilibration":
             _Equilibration() except +
@@ -56,6 +83,8 @@ cdef extern from "<lennardjonesium/api/configuration.hpp>" namespace "api" nogil
             int adjustment_interval
             int steady_state_time
             int timeout
+            int thermodynamic_log_interval
+            bint thermodynamic_log_aggregate
         
         cppclass _Observation "api::Configuration::Observation":
             _Observation() except +
@@ -65,6 +94,8 @@ cdef extern from "<lennardjonesium/api/configuration.hpp>" namespace "api" nogil
             int sample_size
             int observation_interval
             int observation_count
+            int thermodynamic_log_interval
+            bint thermodynamic_log_aggregate
         
         cppclass _Filepaths "api::Configuration::Filepaths":
             _Filepaths() except +
@@ -73,9 +104,21 @@ cdef extern from "<lennardjonesium/api/configuration.hpp>" namespace "api" nogil
             string thermodynamic_log
             string observation_log
             string snapshot_log
+            string thermodynamic_log_format
+            string observation_log_format
+            string file_backend
+            string log_compression
+            string trajectory
+            string trajectory_format
+            string checkpoint
+            string initial_state
+            string final_state
+            string state_cache
+            int state_cache_megabytes
         
         # Now declare the actual member variables
         _System system
+        _Minimization minimization
         _Equilibration equilibration
         _Observation observation
         _Filepaths filepaths
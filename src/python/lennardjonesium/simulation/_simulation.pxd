@@ -24,10 +24,41 @@ License along with Lennard-Jonesium.  If not, see
 from libcpp cimport bool
 from libcpp.memory cimport unique_ptr, shared_ptr
 from libcpp.string cimport string
+from libcpp.vector cimport vector
 
 from lennardjonesium.simulation._configuration cimport _Configuration
 
 
+# The particle data of a SystemState, which is stored in 4xN column-major Eigen matrices (the fourth
+# component of each column is unused)
+cdef extern from "<Eigen/Dense>" namespace "Eigen" nogil:
+    cdef cppclass _Matrix4Xd "Eigen::Matrix4Xd":
+        double* data()
+        Py_ssize_t cols()
+
+cdef extern from "<lennardjonesium/physics/system_state.hpp>" namespace "physics" nogil:
+    cdef cppclass _SystemState "physics::SystemState":
+        _SystemState(int) except +
+
+        _Matrix4Xd positions
+        _Matrix4Xd velocities
+        _Matrix4Xd forces
+        double potential_energy
+        double virial
+        double time
+
+        int particle_count()
+
+
+# Logs which are kept in memory rather than written to files
+cdef extern from "<lennardjonesium/output/memory_logs.hpp>" namespace "output" nogil:
+    cdef cppclass _MemoryLogs "output::MemoryLogs":
+        shared_ptr[vector[char]] event_log
+        shared_ptr[vector[char]] thermodynamic_log
+        shared_ptr[vector[char]] observation_log
+        shared_ptr[vector[char]] snapshot_log
+
+
 # Grab the declarations we need for the Simulation class
 cdef extern from "<lennardjonesium/api/simulation.hpp>" namespace "api" nogil:
     cdef cppclass _Simulation "api::Simulation":
@@ -42,7 +73,21 @@ cdef extern from "<lennardjonesium/api/simulation.hpp>" namespace "api" nogil:
             echo_chain_type Console()
 
         # Run synchronously
-        void run(echo_chain_type)
+        void run(echo_chain_type) except +
+        void resume(echo_chain_type) except +
+
+        # The logs of the last run, if they were kept in memory
+        _MemoryLogs memory_logs()
+
+        # The state at the end of the last run (null before the first run)
+        shared_ptr[const _SystemState] final_state()
+
+        # Start the next runs from the given state instead
+        void set_initial_state(shared_ptr[_SystemState]) except +
+
+        # Checkpoint all running simulations when the given signal is received
+        @staticmethod
+        void checkpoint_on_signal(int)
 
         # Calculate quantities based on particle separation, for plotting
         double potential(double)
@@ -55,7 +100,7 @@ cdef extern from "<lennardjonesium/api/simulation.hpp>" namespace "api" nogil:
 cdef extern from "<lennardjonesium/api/simulation_buffer.hpp>" namespace "api" nogil:
     cdef cppclass _SimulationBuffer "api::SimulationBuffer":
         void launch(_Simulation&)
-        void wait()
+        void wait() except +
         string read()
 
 
@@ -64,6 +109,25 @@ cdef extern from "<lennardjonesium/api/configuration.hpp>" namespace "api" nogil
     cdef unique_ptr[_Simulation] make_simulation(_Configuration) except +
 
 
+# A read-only view of one of the _MemoryLogs buffers, through the buffer protocol
+cdef class LogBuffer:
+    cdef shared_ptr[vector[char]] _buffer
+
+    @staticmethod
+    cdef LogBuffer wrap(shared_ptr[vector[char]])
+
+
+# A read-only view of one of the matrices of a shared _SystemState, as an (N, 3) array
+cdef class StateBuffer:
+    cdef shared_ptr[const _SystemState] _state
+    cdef double* _data
+    cdef Py_ssize_t _shape[2]
+    cdef Py_ssize_t _strides[2]
+
+    @staticmethod
+    cdef StateBuffer wrap(shared_ptr[const _SystemState], double*)
+
+
 # C++ declarations for Cython Simulation class
 cdef class Simulation:
     cdef _SimulationBuffer _cpp_simulation_buffer
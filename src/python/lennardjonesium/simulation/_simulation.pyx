@@ -22,21 +22,95 @@ License along with Lennard-Jonesium.  If not, see
 
 
 # cimports
-from libcpp.memory cimport unique_ptr, make_unique
+from cpython.buffer cimport PyBuffer_FillInfo, PyBUF_WRITABLE, PyBUF_STRIDES
+from libcpp.memory cimport unique_ptr, make_unique, shared_ptr, make_shared, const_pointer_cast
 from libcpp.utility cimport move
 from libcpp.string cimport string
+from libcpp.vector cimport vector
 
 from lennardjonesium.simulation._configuration cimport _Configuration
 from lennardjonesium.simulation._simulation cimport (
     _Simulation,
     _SimulationBuffer,
+    _MemoryLogs,
+    _SystemState,
     make_simulation
 )
 
 # imports
 import time
+import asyncio
+from typing import NamedTuple
 
 from lennardjonesium.simulation.configuration import Configuration
+from lennardjonesium.tools.columnar_log import columnar_array
+
+
+cdef class LogBuffer:
+    """
+    A log kept in memory by a Simulation (see Simulation.memory_logs()), exposed through the buffer
+    protocol as read-only bytes.  It shares ownership of the C++ buffer, so it stays valid when the
+    Simulation is run again or deleted.
+    """
+
+    @staticmethod
+    cdef LogBuffer wrap(shared_ptr[vector[char]] buffer):
+        cdef LogBuffer log_buffer = LogBuffer.__new__(LogBuffer)
+        log_buffer._buffer = buffer
+        return log_buffer
+
+    def __len__(self):
+        return self._buffer.get().size()
+
+    def __getbuffer__(self, Py_buffer* view, int flags):
+        PyBuffer_FillInfo(
+            view, self, self._buffer.get().data(), self._buffer.get().size(), 1, flags
+        )
+
+    def __releasebuffer__(self, Py_buffer* view):
+        pass
+
+
+cdef class StateBuffer:
+    """
+    The positions, velocities, or forces of a C++ SystemState, exposed through the buffer protocol
+    as a read-only (N, 3) array of float64.  The C++ storage has a fourth, unused component for
+    each particle, which the strides skip over.  It shares ownership of the SystemState, so it
+    stays valid for as long as it is in use.
+    """
+
+    @staticmethod
+    cdef StateBuffer wrap(shared_ptr[const _SystemState] state, double* data):
+        cdef StateBuffer state_buffer = StateBuffer.__new__(StateBuffer)
+        state_buffer._state = state
+        state_buffer._data = data
+        state_buffer._shape[0] = state.get().particle_count()
+        state_buffer._shape[1] = 3
+        state_buffer._strides[0] = 4 * sizeof(double)
+        state_buffer._strides[1] = sizeof(double)
+        return state_buffer
+
+    def __getbuffer__(self, Py_buffer* view, int flags):
+        if flags & PyBUF_WRITABLE:
+            raise BufferError('The state is read-only')
+
+        if (flags & PyBUF_STRIDES) != PyBUF_STRIDES:
+            raise BufferError('The state can only be viewed with strides')
+
+        view.buf = self._data
+        view.obj = self
+        view.len = self._shape[0] * self._shape[1] * sizeof(double)
+        view.readonly = 1
+        view.itemsize = sizeof(double)
+        view.format = 'd'
+        view.ndim = 2
+        view.shape = self._shape
+        view.strides = self._strides
+        view.suboffsets = NULL
+        view.internal = NULL
+
+    def __releasebuffer__(self, Py_buffer* view):
+        pass
 
 
 cdef class Simulation:
@@ -49,8 +123,31 @@ cdef class Simulation:
 
     Also provided are three methods potential(), virial(), and force(), which can be used to create
     plots of the functions which determine the physics.
+
+    If the file_backend in the Configuration is 'memory', no log files are written, and the logs of
+    the last run are returned by memory_logs() instead, as NumPy arrays which share the memory of
+    the C++ buffers.  Similarly, final_state() gives the particle data at the end of the last run,
+    and set_initial_state() starts the next run from given particle data.
     """
 
+    # The logs of a run which kept them in memory
+    MemoryLogs = NamedTuple('MemoryLogs', [
+        ('events', str),            # The text of the event log
+        ('thermodynamics', object), # Structured arrays with the same columns as the CSV logs
+        ('observations', object),
+        ('snapshot', object)        # One row per particle, without the ParticleID column
+    ])
+
+    # The particle data of a SystemState, as read-only (N, 3) arrays
+    SystemState = NamedTuple('SystemState', [
+        ('positions', object),
+        ('velocities', object),
+        ('forces', object),
+        ('time', float),
+        ('potential_energy', float),
+        ('virial', float)
+    ])
+
     def __cinit__(self, configuration: Configuration = None):
         if configuration is None:
             configuration = Configuration()
@@ -85,17 +182,134 @@ cdef class Simulation:
                 of around 100 characters, which causes whole blocks of text to appear at once, if
                 there is no delay.
         """
+        cdef string cpp_line
+
         if echo:
-            # We have to use the asynchronous API and Python's print() function
+            # We have to use the asynchronous API and Python's print() function.  The blocking
+            # calls release the GIL, so that other Python threads can run in the meantime.
             self._cpp_simulation_buffer.launch(self.cpp_simulation()[0])
-            line = str(self._cpp_simulation_buffer.read(), 'utf-8')
-            while line:
-                print(line, flush=True)
+
+            with nogil:
+                cpp_line = self._cpp_simulation_buffer.read()
+
+            while not cpp_line.empty():
+                print(str(cpp_line, 'utf-8'), flush=True)
                 time.sleep(delay)
-                line = str(self._cpp_simulation_buffer.read(), 'utf-8')
-            self._cpp_simulation_buffer.wait()
+
+                with nogil:
+                    cpp_line = self._cpp_simulation_buffer.read()
+
+            with nogil:
+                self._cpp_simulation_buffer.wait()
         else:
-            self.cpp_simulation().run(_Simulation._Echo.Silent())
+            with nogil:
+                self.cpp_simulation().run(_Simulation._Echo.Silent())
+
+    def resume(self):
+        """
+        Continues the simulation from the checkpoint file named in the Configuration, if it exists.
+        Otherwise this is the same as run(echo=False).  The log files are truncated to the point
+        where the checkpoint was taken, so the output matches an uninterrupted run.
+        """
+        with nogil:
+            self.cpp_simulation().resume(_Simulation._Echo.Silent())
+
+    async def run_async(self):
+        """
+        Runs the simulation silently in a worker thread, so that it can be awaited from asyncio
+        code without blocking the event loop.  The GIL is released while the simulation runs.
+        """
+        await asyncio.get_running_loop().run_in_executor(None, lambda: self.run(echo=False))
+
+    async def resume_async(self):
+        """
+        The same as resume(), but awaitable, in the same way as run_async().
+        """
+        await asyncio.get_running_loop().run_in_executor(None, self.resume)
+
+    def memory_logs(self):
+        """
+        Returns the logs of the last run as a MemoryLogs tuple, if the file_backend is 'memory'.
+        The arrays are views of the memory written by the simulation (nothing is copied or parsed),
+        so they remain valid after the simulation is run again.  Before the first run, or with
+        another file_backend, the arrays are None.  The logs of a run which is still in progress
+        (e.g. from run_async()) only become visible here once it has finished.
+
+        NumPy is only needed for this method.
+        """
+        cdef _MemoryLogs logs = self.cpp_simulation().memory_logs()
+
+        return Simulation.MemoryLogs(
+            events=bytes(LogBuffer.wrap(logs.event_log)).decode('utf-8'),
+            thermodynamics=columnar_array(LogBuffer.wrap(logs.thermodynamic_log)),
+            observations=columnar_array(LogBuffer.wrap(logs.observation_log)),
+            snapshot=columnar_array(LogBuffer.wrap(logs.snapshot_log))
+        )
+
+    def final_state(self):
+        """
+        Returns the state at the end of the last run as a SystemState tuple, or None before the
+        first run.  The arrays are read-only views of the C++ matrices, not copies, and they keep
+        the state alive, so they remain valid after the simulation is run again or deleted.  As with
+        memory_logs(), a run which is still in progress is not visible until it has finished.
+        """
+        import numpy as np
+
+        cdef shared_ptr[const _SystemState] state = self.cpp_simulation().final_state()
+
+        if state.get() == NULL:
+            return None
+
+        # The buffers are read-only, so it is safe to take the data pointers from a non-const state
+        cdef _SystemState* matrices = const_pointer_cast[_SystemState, const _SystemState](
+            state
+        ).get()
+
+        return Simulation.SystemState(
+            positions=np.asarray(StateBuffer.wrap(state, matrices.positions.data())),
+            velocities=np.asarray(StateBuffer.wrap(state, matrices.velocities.data())),
+            forces=np.asarray(StateBuffer.wrap(state, matrices.forces.data())),
+            time=matrices.time,
+            potential_energy=matrices.potential_energy,
+            virial=matrices.virial
+        )
+
+    def set_initial_state(self, positions, velocities=None):
+        """
+        Starts the following runs from the given (N, 3) array of positions, instead of from the
+        lattice or the initial_state file.  The velocities are rescaled to the temperature of the
+        simulation, or if they are not given, chosen as they would be for the lattice.  The arrays
+        are copied, since the C++ state has a different layout.  A final_state() can be passed
+        back in this way, e.g. final_state().positions.
+        """
+        import numpy as np
+
+        positions = np.asarray(positions, dtype=np.float64)
+
+        if positions.ndim != 2 or positions.shape[1] != 3:
+            raise ValueError('The positions must be an array of shape (N, 3)')
+
+        cdef int particle_count = positions.shape[0]
+        cdef shared_ptr[_SystemState] state = make_shared[_SystemState](particle_count)
+
+        # Each particle is a column of four components, so the matrices are (N, 4) arrays in C order
+        cdef double[:, ::1] target = (
+            <double[:particle_count, :4]> state.get().positions.data()
+        )
+        np.asarray(target)[:, :3] = positions
+
+        if velocities is not None:
+            target = <double[:particle_count, :4]> state.get().velocities.data()
+            np.asarray(target)[:, :3] = np.asarray(velocities, dtype=np.float64)
+
+        self.cpp_simulation().set_initial_state(state)
+
+    @staticmethod
+    def checkpoint_on_signal(int signal_number):
+        """
+        Makes every running simulation write its checkpoint when the given signal is received.
+        """
+        _Simulation.checkpoint_on_signal(signal_number)
 
     cpdef double potential(self, double separation):
         """
@@ -139,6 +353,31 @@ cdef _Configuration make_cpp_configuration(py_configuration: Configuration):
     cpp_configuration.system.random_seed = py_configuration.system.random_seed
     cpp_configuration.system.cutoff_distance = py_configuration.system.cutoff_distance
     cpp_configuration.system.time_delta = py_configuration.system.time_delta
+    cpp_configuration.system.checkpoint_interval = py_configuration.system.checkpoint_interval
+    cpp_configuration.system.snapshot_interval = py_configuration.system.snapshot_interval
+    cpp_configuration.system.trajectory_position_precision = \
+        py_configuration.system.trajectory_position_precision
+    cpp_configuration.system.trajectory_velocity_precision = \
+        py_configuration.system.trajectory_velocity_precision
+    cpp_configuration.system.trajectory_keyframe_interval = \
+        py_configuration.system.trajectory_keyframe_interval
+    cpp_configuration.system.replica_count = py_configuration.system.replica_count
+    cpp_configuration.system.thread_count = py_configuration.system.thread_count
+
+    # Minimization settings
+    cpp_configuration.minimization.enabled = py_configuration.minimization.enabled
+    cpp_configuration.minimization.name = bytes(py_configuration.minimization.name, 'utf-8')
+    cpp_configuration.minimization.energy_tolerance = \
+        py_configuration.minimization.energy_tolerance
+    cpp_configuration.minimization.check_interval = py_configuration.minimization.check_interval
+    cpp_configuration.minimization.mixing = py_configuration.minimization.mixing
+    cpp_configuration.minimization.mixing_decay = py_configuration.minimization.mixing_decay
+    cpp_configuration.minimization.delay = py_configuration.minimization.delay
+    cpp_configuration.minimization.timeout = py_configuration.minimization.timeout
+    cpp_configuration.minimization.thermodynamic_log_interval = \
+        py_configuration.minimization.thermodynamic_log_interval
+    cpp_configuration.minimization.thermodynamic_log_aggregate = \
+        py_configuration.minimization.thermodynamic_log_aggregate
 
     # Equilibration settings
     cpp_configuration.equilibration.name = bytes(py_configuration.equilibration.name, 'utf-8')
@@ -149,6 +388,10 @@ cdef _Configuration make_cpp_configuration(py_configuration: Configuration):
     cpp_configuration.equilibration.steady_state_time = \
         py_configuration.equilibration.steady_state_time
     cpp_configuration.equilibration.timeout = py_configuration.equilibration.timeout
+    cpp_configuration.equilibration.thermodynamic_log_interval = \
+        py_configuration.equilibration.thermodynamic_log_interval
+    cpp_configuration.equilibration.thermodynamic_log_aggregate = \
+        py_configuration.equilibration.thermodynamic_log_aggregate
 
     # Observation settings
     cpp_configuration.observation.name = bytes(py_configuration.observation.name, 'utf-8')
@@ -158,6 +401,10 @@ cdef _Configuration make_cpp_configuration(py_configuration: Configuration):
         py_configuration.observation.observation_interval
     cpp_configuration.observation.observation_count = \
         py_configuration.observation.observation_count
+    cpp_configuration.observation.thermodynamic_log_interval = \
+        py_configuration.observation.thermodynamic_log_interval
+    cpp_configuration.observation.thermodynamic_log_aggregate = \
+        py_configuration.observation.thermodynamic_log_aggregate
 
     # Output files
     cpp_configuration.filepaths.event_log = \
@@ -168,5 +415,27 @@ cdef _Configuration make_cpp_configuration(py_configuration: Configuration):
         bytes(py_configuration.filepaths.observation_log, 'utf-8')
     cpp_configuration.filepaths.snapshot_log = \
         bytes(py_configuration.filepaths.snapshot_log, 'utf-8')
+    cpp_configuration.filepaths.thermodynamic_log_format = \
+        bytes(py_configuration.filepaths.thermodynamic_log_format, 'utf-8')
+    cpp_configuration.filepaths.observation_log_format = \
+        bytes(py_configuration.filepaths.observation_log_format, 'utf-8')
+    cpp_configuration.filepaths.file_backend = \
+        bytes(py_configuration.filepaths.file_backend, 'utf-8')
+    cpp_configuration.filepaths.log_compression = \
+        bytes(py_configuration.filepaths.log_compression, 'utf-8')
+    cpp_configuration.filepaths.trajectory = \
+        bytes(py_configuration.filepaths.trajectory, 'utf-8')
+    cpp_configuration.filepaths.trajectory_format = \
+        bytes(py_configuration.filepaths.trajectory_format, 'utf-8')
+    cpp_configuration.filepaths.checkpoint = \
+        bytes(py_configuration.filepaths.checkpoint, 'utf-8')
+    cpp_configuration.filepaths.initial_state = \
+        bytes(py_configuration.filepaths.initial_state, 'utf-8')
+    cpp_configuration.filepaths.final_state = \
+        bytes(py_configuration.filepaths.final_state, 'utf-8')
+    cpp_configuration.filepaths.state_cache = \
+        bytes(py_configuration.filepaths.state_cache, 'utf-8')
+    cpp_configuration.filepaths.state_cache_megabytes = \
+        py_configuration.filepaths.state_cache_megabytes
     
     return cpp_configuration
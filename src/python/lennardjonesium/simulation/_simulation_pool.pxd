@@ -22,13 +22,49 @@ License along with Lennard-Jonesium.  If not, see
 
 
 from libcpp.memory cimport unique_ptr
+from libcpp.vector cimport vector
+from libcpp.string cimport string
 
 from lennardjonesium.simulation._simulation cimport _Simulation
 
 
+# Cython does not declare std::reference_wrapper, which is used for chains of Simulations
+cdef extern from "<functional>" namespace "std" nogil:
+    cdef cppclass reference_wrapper[T]:
+        reference_wrapper(T&)
+
+
+# The default number of log writer threads
+cdef extern from "<lennardjonesium/output/io_service.hpp>" namespace "output" nogil:
+    cdef cppclass _IOService "output::IOService":
+        @staticmethod
+        int default_thread_count()
+
+
+# The progress of a running simulation
+cdef extern from "<lennardjonesium/control/progress.hpp>" namespace "control" nogil:
+    cdef cppclass _Progress "control::Progress":
+        cppclass _Report "Report":
+            bint running
+            int phases_completed
+            int time_step
+            int expected_time_steps
+            double elapsed_seconds
+            double steps_per_second
+            double eta_seconds
+
+
 # Declarations for SimulationPool
 cdef extern from "<lennardjonesium/api/simulation_pool.hpp>" namespace "api" nogil:
     cdef cppclass _SimulationPool "api::SimulationPool":
+        enum class _Affinity "api::SimulationPool::Affinity":
+            pass
+
+        _SimulationPool(int, int, _Affinity) except +
+
+        @staticmethod
+        _Affinity parse_affinity(const string&) except +
+
         cppclass _Status "Status":
             _Status() except +
             int queued
@@ -36,12 +72,21 @@ cdef extern from "<lennardjonesium/api/simulation_pool.hpp>" namespace "api" nog
             int started
             int running
             int completed
+            double makespan
+            int cores_in_use
+
+        cppclass _JobProgress "JobProgress":
+            int job
+            _Progress._Report report
         
         void push(_Simulation&) except +
+        void push_chain(vector[reference_wrapper[_Simulation]]) except +
         void close() except +
         void wait() except +
 
         _Status status() except +
+        vector[_JobProgress] progress() except +
+        int completion_fd()
 
 
 # C++ declarations for SimulationPool
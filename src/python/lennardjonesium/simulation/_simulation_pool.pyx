@@ -24,20 +24,28 @@ License along with Lennard-Jonesium.  If not, see
 # cimports
 from libcpp.memory cimport unique_ptr, make_unique
 from libcpp.utility cimport move
+from libcpp.vector cimport vector
 
 from lennardjonesium.simulation._simulation cimport _Simulation, Simulation
-from lennardjonesium.simulation._simulation_pool cimport _SimulationPool
+from lennardjonesium.simulation._simulation_pool cimport (
+    _SimulationPool, _IOService, reference_wrapper
+)
 
 
 # imports
-from typing import NamedTuple
+import os
+import time
+import select
+import asyncio
+from typing import NamedTuple, Optional
 
 
 cdef class SimulationPool:
     """
     SimulationPool is a thread pool with a number of workers for running Simulations.  Simply push()
     the Simulation objects onto the queue, and they will run as soon as a worker is available.  The
-    status() method returns useful information about currently-running threads.
+    waiting jobs are started longest first, by their estimated running time.  The status() method
+    returns useful information about currently-running threads.
     """
 
     # The Status tuple contains the following entries:
@@ -47,11 +55,28 @@ cdef class SimulationPool:
         ('waiting', int),       # Number of jobs currently waiting for a worker
         ('started', int),       # Total number of jobs that have been picked up by workers
         ('running', int),       # Number of jobs currently running
-        ('completed', int)      # Number of jobs completed
+        ('completed', int),     # Number of jobs completed
+        ('makespan', float),    # Seconds from the first start to the latest completion
+        ('cores_in_use', int)   # Number of cores granted to the running jobs
     ])
 
-    def __cinit__(self, thread_count: int = 4):
+    # The JobProgress tuple describes one running Simulation:
+    JobProgress = NamedTuple('JobProgress', [
+        ('job', int),                   # Position of the Simulation in the order it was pushed
+        ('phases_completed', int),      # Number of SimulationPhases completed so far
+        ('time_step', int),             # Current time step
+        ('expected_time_steps', int),   # Largest number of time steps the schedule allows
+        ('elapsed_seconds', float),     # Time since the Simulation started
+        ('steps_per_second', float),    # Throughput since the Simulation started
+        ('eta_seconds', Optional[float])    # Upper bound on the time remaining, if known
+    ])
+
+    def __cinit__(self, thread_count: int = 4, affinity: str = 'node'):
         """
+        The thread_count is the number of cores the pool may use.  The affinity is one of 'none'
+        (threads are not pinned), 'node' (each worker is pinned to a NUMA node, spreading the jobs
+        across the sockets), or 'core' (each worker is pinned to a single CPU).
+
         NOTE: We do not do any checks as to whether the hardware has enough independent cores to
         run the jobs in parallel.  Apparently it's hard to do this in a platform-independent way.
         Therefore be judicious in terms of how many threads you wish to spawn.
@@ -60,9 +85,14 @@ cdef class SimulationPool:
             raise TypeError('Thread count must be an integer')
         
         cdef int cpp_thread_count = <int> thread_count
+        cdef _SimulationPool._Affinity cpp_affinity = (
+            _SimulationPool.parse_affinity(affinity.encode('utf-8'))
+        )
 
         self._cpp_simulation_pool = move[unique_ptr[_SimulationPool]](
-            make_unique[_SimulationPool](cpp_thread_count)
+            make_unique[_SimulationPool](
+                cpp_thread_count, _IOService.default_thread_count(), cpp_affinity
+            )
         )
     
     cdef _SimulationPool* cpp_simulation_pool(self):
@@ -76,6 +106,21 @@ cdef class SimulationPool:
 
         self.cpp_simulation_pool().push(_simulation.cpp_simulation()[0])
     
+    def push_chain(self, simulations):
+        """
+        Pushes a sequence of Simulations which must run one after another (for example, because
+        each one starts from the final state of the previous one).  The whole chain is run by a
+        single worker thread, while other jobs run in parallel.
+        """
+        cdef vector[reference_wrapper[_Simulation]] chain
+        cdef Simulation _simulation
+
+        for simulation in simulations:
+            _simulation = <Simulation?> simulation
+            chain.push_back(reference_wrapper[_Simulation](_simulation.cpp_simulation()[0]))
+
+        self.cpp_simulation_pool().push_chain(move(chain))
+    
     def close(self):
         """
         If no further jobs will be pushed, then you can call close() to allow the workers to be
@@ -89,9 +134,84 @@ cdef class SimulationPool:
     def wait(self):
         """
         Closes the queue to any further submissions, and also waits until all workers are finished
-        with all jobs currently in the queue.  This is a blocking call until all work is done.
+        with all jobs currently in the queue.  This is a blocking call until all work is done, but
+        it releases the GIL, so other Python threads can run in the meantime.
+        """
+        with nogil:
+            self.cpp_simulation_pool().wait()
+
+    def wait_for_completion(self, timeout: Optional[float] = None) -> bool:
+        """
+        Blocks until some job completes, or until the timeout (in seconds) has passed, and returns
+        whether a job completed.  The GIL is released while waiting.
+        """
+        cdef int fd = self.cpp_simulation_pool().completion_fd()
+
+        if fd < 0:
+            time.sleep(timeout if timeout is not None else 0.1)
+            return False
+
+        readable, _, _ = select.select([fd], [], [], timeout)
+
+        if readable:
+            try:
+                os.read(fd, 8)
+            except BlockingIOError:
+                pass
+
+        return bool(readable)
+
+    async def join(self):
+        """
+        Waits until every Simulation pushed so far has completed, without blocking the event loop,
+        and returns the final Status.  The pool is not closed, so more jobs can be pushed later.
+
+        The event loop is woken by the pool itself whenever a job completes (through its
+        completion file descriptor), so there is no polling.  Only one coroutine at a time should
+        join() a given pool.
         """
-        self.cpp_simulation_pool().wait()
+        cdef int fd = self.cpp_simulation_pool().completion_fd()
+
+        if fd < 0:
+            # No eventfd on this platform, so fall back to polling
+            while not self._all_completed():
+                await asyncio.sleep(0.1)
+            return self.status()
+
+        loop = asyncio.get_running_loop()
+        done = loop.create_future()
+
+        def on_completion():
+            try:
+                os.read(fd, 8)
+            except BlockingIOError:
+                pass
+
+            if self._all_completed() and not done.done():
+                done.set_result(self.status())
+
+        loop.add_reader(fd, on_completion)
+
+        try:
+            # In case everything completed before we started listening
+            on_completion()
+            return await done
+        finally:
+            loop.remove_reader(fd)
+
+    async def wait_async(self):
+        """
+        The same as wait(), but awaitable: closes the queue, waits for all jobs to complete with
+        join(), and then shuts down the workers.
+        """
+        self.close()
+        status = await self.join()
+        await asyncio.get_running_loop().run_in_executor(None, self.wait)
+        return status
+
+    def _all_completed(self):
+        status = self.status()
+        return status.completed >= status.queued
     
     def status(self):
         """
@@ -104,5 +224,29 @@ cdef class SimulationPool:
             waiting=_status.waiting,
             started=_status.started,
             running=_status.running,
-            completed=_status.completed
+            completed=_status.completed,
+            makespan=_status.makespan,
+            cores_in_use=_status.cores_in_use
+        )
+    
+    def progress(self):
+        """
+        Get the progress of each running Simulation, as a list of JobProgress tuples.  Like
+        status(), this does not hold up the workers, so it can be polled frequently.
+        """
+        cdef vector[_SimulationPool._JobProgress] _progress = (
+            self.cpp_simulation_pool().progress()
         )
+
+        return [
+            SimulationPool.JobProgress(
+                job=entry.job,
+                phases_completed=entry.report.phases_completed,
+                time_step=entry.report.time_step,
+                expected_time_steps=entry.report.expected_time_steps,
+                elapsed_seconds=entry.report.elapsed_seconds,
+                steps_per_second=entry.report.steps_per_second,
+                eta_seconds=(entry.report.eta_seconds if entry.report.eta_seconds >= 0 else None)
+            )
+            for entry in _progress
+        ]
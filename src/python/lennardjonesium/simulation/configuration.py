@@ -43,6 +43,26 @@ class Configuration(INIParsable, DictParsable):
         cutoff_distance: float = 2.5
         time_delta: float = 0.005
         random_seed: int = SeedGenerator.default_seed()
+        checkpoint_interval: int = 0
+        snapshot_interval: int = 0
+        trajectory_position_precision: float = 1.0e-3
+        trajectory_velocity_precision: float = 1.0e-3
+        trajectory_keyframe_interval: int = 100
+        replica_count: int = 1
+        thread_count: int = 0
+    
+    @dataclass
+    class _Minimization:
+        enabled: bool = False
+        name: str = 'Minimization Phase'
+        energy_tolerance: float = 1.0e-6
+        check_interval: int = 20
+        mixing: float = 0.1
+        mixing_decay: float = 0.99
+        delay: int = 5
+        timeout: int = 2000
+        thermodynamic_log_interval: int = 1
+        thermodynamic_log_aggregate: bool = False
     
     @dataclass
     class _Equilibration:
@@ -52,6 +72,8 @@ class Configuration(INIParsable, DictParsable):
         adjustment_interval: int = 200
         steady_state_time: int = 1000
         timeout: int = 5000
+        thermodynamic_log_interval: int = 1
+        thermodynamic_log_aggregate: bool = False
     
     @dataclass
     class _Observation:
@@ -60,6 +82,8 @@ class Configuration(INIParsable, DictParsable):
         sample_size: int = 50
         observation_interval: int = 200
         observation_count: int = 20
+        thermodynamic_log_interval: int = 1
+        thermodynamic_log_aggregate: bool = False
     
     @dataclass
     class _Filepaths:
@@ -67,9 +91,21 @@ class Configuration(INIParsable, DictParsable):
         thermodynamic_log: str = 'thermodynamics.csv'
         observation_log: str = 'observations.csv'
         snapshot_log: str = 'snapshots.csv'
+        thermodynamic_log_format: str = 'csv'
+        observation_log_format: str = 'csv'
+        file_backend: str = 'standard'
+        log_compression: str = 'none'
+        trajectory: str = ''
+        trajectory_format: str = 'float64'
+        checkpoint: str = ''
+        initial_state: str = ''
+        final_state: str = ''
+        state_cache: str = ''
+        state_cache_megabytes: int = 1024
     
     # Since these are mutable, they need to be specified with a default factory
     system: _System = field(default_factory=_System)
+    minimization: _Minimization = field(default_factory=_Minimization)
     equilibration: _Equilibration = field(default_factory=_Equilibration)
     observation: _Observation = field(default_factory=_Observation)
     filepaths: _Filepaths = field(default_factory=_Filepaths)
@@ -1,3 +1,8 @@
 from lennardjonesium.tools.ini_parsable import INIParsable
 from lennardjonesium.tools.dict_parsable import DictParsable
 from lennardjonesium.tools.linspace import linspace
+from lennardjonesium.tools.columnar_log import (
+    read_columnar_header, read_columnar_log, columnar_array
+)
+from lennardjonesium.tools.trajectory import read_trajectory_index, read_trajectory
+from lennardjonesium.tools.log_file import open_log
@@ -0,0 +1,104 @@
+"""
+columnar_log.py
+
+Copyright (c) 2021-2022 Benjamin E. Niehoff
+
+This file is part of Lennard-Jonesium.
+
+Lennard-Jonesium is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public
+License as published by the Free Software Foundation, either
+version 3 of the License, or (at your option) any later version.
+
+Lennard-Jonesium is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public
+License along with Lennard-Jonesium.  If not, see
+<https://www.gnu.org/licenses/>.
+"""
+
+
+import pathlib
+import struct
+from typing import Union
+
+_MAGIC = b'LJCOLS01'
+_PREAMBLE = struct.Struct('<8sQQQ')
+
+
+def read_columnar_header(path: Union[str, pathlib.Path]) -> tuple[int, list[tuple[str, str]]]:
+    """
+    Reads the header of a binary columnar log (written by the C++ ColumnarWriter), and returns
+    the offset of the first record together with the list of (name, type) fields, where the types
+    are in NumPy's notation (e.g. '<f8').
+    """
+    with open(path, 'rb') as f:
+        preamble = f.read(_PREAMBLE.size)
+        return _parse_header(preamble, lambda size: f.read(size), path)
+
+
+def _parse_header(preamble, read, name) -> tuple[int, list[tuple[str, str]]]:
+    # Shared by the file and buffer versions; read(size) returns the rest of the header
+    magic, data_offset, record_size, field_count = _PREAMBLE.unpack(preamble)
+
+    if magic != _MAGIC:
+        raise ValueError(f'{name} is not a columnar log')
+
+    description = bytes(read(data_offset - _PREAMBLE.size)).rstrip(b'\0').decode('ascii')
+    fields = [tuple(line.split(':')) for line in description.splitlines()]
+
+    if len(fields) != field_count:
+        raise ValueError(f'{name} has a corrupt header')
+
+    return data_offset, fields
+
+
+def read_columnar_log(path: Union[str, pathlib.Path]):
+    """
+    Maps a binary columnar log into memory as a NumPy structured array (read-only), without
+    parsing it.  The columns are the same as in the CSV version of the log, so that for example
+    `pandas.DataFrame(read_columnar_log('thermodynamics.bin'))` gives the same table as
+    `pandas.read_csv('thermodynamics.csv')`.
+
+    NumPy is only needed for this function, so it is imported here.  A partial record at the end
+    of the file (e.g. if the simulation is still running) is ignored.
+    """
+    import numpy as np
+
+    data_offset, fields = read_columnar_header(path)
+    dtype = np.dtype(fields)
+
+    record_count = (pathlib.Path(path).stat().st_size - data_offset) // dtype.itemsize
+
+    if record_count == 0:
+        return np.empty(0, dtype=dtype)
+
+    return np.memmap(path, dtype=dtype, mode='r', offset=data_offset, shape=(record_count,))
+
+
+def columnar_array(buffer):
+    """
+    Views a binary columnar log held in memory (any object supporting the buffer protocol, such as
+    the logs returned by Simulation.memory_logs()) as a NumPy structured array, without copying
+    it.  The array keeps the buffer alive.  An empty buffer gives None, since it has no header.
+    """
+    import numpy as np
+
+    view = memoryview(buffer).cast('B')
+
+    if len(view) == 0:
+        return None
+
+    data_offset, fields = _parse_header(
+        view[:_PREAMBLE.size],
+        lambda size: view[_PREAMBLE.size:_PREAMBLE.size + size],
+        'buffer'
+    )
+    dtype = np.dtype(fields)
+
+    record_count = (len(view) - data_offset) // dtype.itemsize
+
+    return np.frombuffer(view, dtype=dtype, count=record_count, offset=data_offset)
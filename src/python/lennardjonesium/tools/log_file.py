@@ -0,0 +1,64 @@
+"""
+log_file.py
+
+Copyright (c) 2021-2022 Benjamin E. Niehoff
+
+This file is part of Lennard-Jonesium.
+
+Lennard-Jonesium is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public
+License as published by the Free Software Foundation, either
+version 3 of the License, or (at your option) any later version.
+
+Lennard-Jonesium is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public
+License along with Lennard-Jonesium.  If not, see
+<https://www.gnu.org/licenses/>.
+"""
+
+
+
+import gzip
+import io
+import pathlib
+from typing import IO, Union
+
+_GZIP_MAGIC = b'\x1f\x8b'
+_ZSTD_MAGIC = b'\x28\xb5\x2f\xfd'
+
+
+def open_log(path: Union[str, pathlib.Path], mode: str = 'rt') -> IO:
+    """
+    Opens a log file for reading, decompressing it if it was written with log compression (see
+    `Configuration.filepaths.log_compression`).  The compression is recognized from the contents
+    of the file rather than its name, so a log keeps its name whether it is compressed or not.
+    The result can be passed to e.g. `pandas.read_csv()`.
+
+    Reading a zstd-compressed log requires the `zstandard` package, which is imported only when
+    it is needed.  Logs compressed with gzip can always be read.
+    """
+    if mode not in ('rt', 'rb'):
+        raise ValueError(f'Unsupported mode: {mode}')
+
+    with open(path, 'rb') as f:
+        magic = f.read(len(_ZSTD_MAGIC))
+
+    if magic.startswith(_GZIP_MAGIC):
+        return gzip.open(path, mode)
+
+    if magic.startswith(_ZSTD_MAGIC):
+        try:
+            import zstandard
+        except ImportError as e:
+            raise ImportError(
+                f'{path} is compressed with zstd; install the zstandard package to read it'
+            ) from e
+
+        reader = zstandard.ZstdDecompressor().stream_reader(open(path, 'rb'), closefd=True)
+        return reader if mode == 'rb' else io.TextIOWrapper(reader)
+
+    return open(path, mode)
@@ -0,0 +1,199 @@
+"""
+trajectory.py
+
+Copyright (c) 2021-2022 Benjamin E. Niehoff
+
+This file is part of Lennard-Jonesium.
+
+Lennard-Jonesium is free software: you can redistribute
+it and/or modify it under the terms of the GNU General Public
+License as published by the Free Software Foundation, either
+version 3 of the License, or (at your option) any later version.
+
+Lennard-Jonesium is distributed in the hope that it will
+be useful, but WITHOUT ANY WARRANTY; without even the implied
+warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public
+License along with Lennard-Jonesium.  If not, see
+<https://www.gnu.org/licenses/>.
+"""
+
+
+import pathlib
+import struct
+from typing import Union
+
+_MAGIC = b'LJTRAJ01'
+_INDEX_MAGIC = b'LJTRIDX1'
+_HEADER = struct.Struct('<8sQQQ')
+_TRAILER = struct.Struct('<Q8s')
+_FRAME_PREAMBLE = struct.Struct('<Qqd')
+
+_VALUE_TYPES = {0: '<f8', 1: '<f4'}
+_COMPRESSED = 2
+_COMPRESSED_HEADER = struct.Struct('<BBB3d3Id')
+_RICE_ESCAPE = 32
+
+
+def read_trajectory_index(path: Union[str, pathlib.Path]) -> tuple[int, int, list[int]]:
+    """
+    Reads the header and frame index of a trajectory file (written by the C++ TrajectorySink), and
+    returns (particle_count, format_code, frame_offsets).  If the file has no index (because the
+    run was interrupted), the complete frames are found by following their sizes.
+    """
+    path = pathlib.Path(path)
+    file_size = path.stat().st_size
+
+    with open(path, 'rb') as f:
+        magic, particle_count, format_code, _ = _HEADER.unpack(f.read(_HEADER.size))
+
+        if magic != _MAGIC:
+            raise ValueError(f'{path} is not a trajectory file')
+
+        if file_size >= _HEADER.size + _TRAILER.size:
+            f.seek(file_size - _TRAILER.size)
+            frame_count, index_magic = _TRAILER.unpack(f.read(_TRAILER.size))
+            index_size = 8 * frame_count + _TRAILER.size
+
+            if index_magic == _INDEX_MAGIC and index_size <= file_size - _HEADER.size:
+                f.seek(file_size - index_size)
+                offsets = struct.unpack(f'<{frame_count}Q', f.read(8 * frame_count))
+                return particle_count, format_code, list(offsets)
+
+        offsets = []
+        offset = _HEADER.size
+
+        while offset + 8 <= file_size:
+            f.seek(offset)
+            (frame_size,) = struct.unpack('<Q', f.read(8))
+
+            if frame_size < _FRAME_PREAMBLE.size or frame_size > file_size - offset:
+                break
+
+            offsets.append(offset)
+            offset += frame_size
+
+    return particle_count, format_code, offsets
+
+
+def _unzigzag(value: int) -> int:
+    return (value >> 1) ^ -(value & 1)
+
+
+def _decode_compressed_body(body: bytes, particle_count: int, previous: list[int]) -> tuple:
+    """
+    Decodes the body of a compressed frame (see trajectory_codec.hpp in the C++ library), given
+    the quantized values of the previous frame (unless it is a keyframe).  Returns the quantized
+    values of this frame, together with the grid spacings for positions (per axis) and velocities.
+    """
+    keyframe, position_k, velocity_k, *fields = _COMPRESSED_HEADER.unpack_from(body)
+    box, cells, velocity_quantum = fields[0:3], fields[3:6], fields[6]
+
+    # Bits are packed least significant first; spell them out in that order
+    bits = ''.join(f'{byte:08b}'[::-1] for byte in body[_COMPRESSED_HEADER.size:])
+    position = 0
+
+    def read(count: int) -> int:
+        nonlocal position
+        value = int(bits[position:position + count][::-1] or '0', 2)
+        position += count
+        return value
+
+    def read_rice(k: int) -> int:
+        nonlocal position
+        zero = bits.find('0', position, position + _RICE_ESCAPE)
+        if zero < 0:
+            position += _RICE_ESCAPE
+            return read(64)
+        quotient = zero - position
+        position = zero + 1
+        return (quotient << k) | read(k)
+
+    position_count = 3 * particle_count
+    values = []
+
+    for j in range(position_count):
+        value = read_rice(position_k)
+        if keyframe:
+            values.append(value)
+        else:
+            values.append((previous[j] + _unzigzag(value)) % cells[j % 3])
+
+    for j in range(position_count, 2 * position_count):
+        difference = _unzigzag(read_rice(velocity_k))
+        values.append(difference if keyframe else previous[j] + difference)
+
+    spacings = [side / count for side, count in zip(box, cells)]
+    return values, spacings, velocity_quantum
+
+
+def _read_compressed_trajectory(path, particle_count: int, offsets: list[int]):
+    import numpy as np
+
+    dtype = np.dtype([
+        ('time_step', '<i8'),
+        ('time', '<f8'),
+        ('positions', '<f8', (particle_count, 3)),
+        ('velocities', '<f8', (particle_count, 3)),
+    ])
+
+    frames = np.empty(len(offsets), dtype=dtype)
+    previous = None
+
+    with open(path, 'rb') as f:
+        for i, offset in enumerate(offsets):
+            f.seek(offset)
+            frame_size, time_step, time = _FRAME_PREAMBLE.unpack(f.read(_FRAME_PREAMBLE.size))
+            body = f.read(frame_size - _FRAME_PREAMBLE.size)
+
+            previous, spacings, velocity_quantum = _decode_compressed_body(
+                body, particle_count, previous
+            )
+
+            quantized = np.array(previous, dtype=np.float64).reshape(2, particle_count, 3)
+            frames[i]['time_step'] = time_step
+            frames[i]['time'] = time
+            frames[i]['positions'] = quantized[0] * np.array(spacings)
+            frames[i]['velocities'] = quantized[1] * velocity_quantum
+
+    return frames
+
+
+def read_trajectory(path: Union[str, pathlib.Path]):
+    """
+    Maps the frames of a trajectory file into memory as a NumPy structured array (read-only),
+    with fields 'time_step', 'time', 'positions', and 'velocities'; the last two have shape
+    (particle_count, 3) in each frame.
+
+    Compressed trajectories cannot be mapped, so they are decoded into an ordinary array with the
+    same fields.  (The decoder is pure Python, so this is much slower than reading the file from
+    C++ with TrajectoryReader.)
+
+    NumPy is only needed for this function, so it is imported here.
+    """
+    import numpy as np
+
+    particle_count, format_code, offsets = read_trajectory_index(path)
+
+    if format_code == _COMPRESSED:
+        return _read_compressed_trajectory(path, particle_count, offsets)
+
+    if format_code not in _VALUE_TYPES:
+        raise ValueError(f'{path} has an unsupported trajectory format ({format_code})')
+
+    value_type = _VALUE_TYPES[format_code]
+    dtype = np.dtype([
+        ('frame_size', '<u8'),
+        ('time_step', '<i8'),
+        ('time', '<f8'),
+        ('positions', value_type, (particle_count, 3)),
+        ('velocities', value_type, (particle_count, 3)),
+    ])
+
+    if not offsets:
+        return np.empty(0, dtype=dtype)
+
+    # Frames of these formats all have the same size, so they can be mapped as one array
+    return np.memmap(path, dtype=dtype, mode='r', offset=offsets[0], shape=(len(offsets),))
@@ -0,0 +1,102 @@
+/**
+ * Measure the throughput of the text Sinks, in lines per second.
+ *
+ * The Sinks write to a null device, so that only the formatting and buffering are measured, and
+ * not the file system.  Run the benchmarks executable directly; it is not part of ctest.
+ */
+
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <catch2/catch.hpp>
+#include <Eigen/Dense>
+
+#include <boost/iostreams/device/null.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <src/cpp/lennardjonesium/physics/measurements.hpp>
+#include <src/cpp/lennardjonesium/output/log_message.hpp>
+#include <src/cpp/lennardjonesium/output/sinks.hpp>
+
+namespace
+{
+    // Repeat write_lines() for a while, and report how many lines per second it achieved
+    template<class WriteLines>
+    void report_throughput(const char* name, int lines_per_call, WriteLines write_lines)
+    {
+        using clock = std::chrono::steady_clock;
+
+        auto start = clock::now();
+        long lines = 0;
+
+        while (clock::now() - start < std::chrono::milliseconds{500})
+        {
+            write_lines();
+            lines += lines_per_call;
+        }
+
+        std::chrono::duration<double> elapsed = clock::now() - start;
+
+        std::cout << name << ": " << static_cast<double>(lines) / elapsed.count()
+            << " lines/sec\n";
+    }
+}
+
+TEST_CASE("Throughput of the text Sinks")
+{
+    boost::iostreams::stream<boost::iostreams::null_sink> destination{
+        boost::iostreams::null_sink{}
+    };
+
+    // Values which need the full shortest round-trip representation
+    std::mt19937_64 generator{};
+    std::uniform_real_distribution<double> distribution{-1.0, 1.0};
+    auto value = [&]() {return distribution(generator);};
+
+    physics::ThermodynamicMeasurement::Result thermodynamic_result{
+        .time = value(),
+        .kinetic_energy = value(),
+        .potential_energy = value(),
+        .total_energy = value(),
+        .virial = value(),
+        .temperature = value(),
+        .mean_square_displacement = value()
+    };
+
+    constexpr int particle_count = 1000;
+
+    output::SystemSnapshot snapshot{
+        .positions = Eigen::Matrix4Xd::NullaryExpr(4, particle_count, value),
+        .velocities = Eigen::Matrix4Xd::NullaryExpr(4, particle_count, value),
+        .forces = Eigen::Matrix4Xd::NullaryExpr(4, particle_count, value)
+    };
+
+    output::ThermodynamicSink thermodynamic_sink{destination};
+    output::SystemSnapshotSink snapshot_sink{destination};
+
+    auto write_thermodynamics = [&]()
+    {
+        for (int time_step = 0; time_step < particle_count; ++time_step)
+        {
+            thermodynamic_sink.write(time_step, output::ThermodynamicData{thermodynamic_result});
+        }
+
+        thermodynamic_sink.flush();
+    };
+
+    auto write_snapshot = [&]()
+    {
+        snapshot_sink.write(0, snapshot);
+        snapshot_sink.flush();
+    };
+
+    report_throughput("ThermodynamicSink", particle_count, write_thermodynamics);
+    report_throughput("SystemSnapshotSink", particle_count, write_snapshot);
+
+    BENCHMARK("ThermodynamicSink, 1000 lines") {write_thermodynamics();};
+    BENCHMARK("SystemSnapshotSink, 1000 lines") {write_snapshot();};
+}
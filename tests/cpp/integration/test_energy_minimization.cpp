@@ -0,0 +1,104 @@
+/**
+ * Test the MinimizationPhase on a dense initial condition with real forces.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <memory>
+
+#include <catch2/catch.hpp>
+#include <Eigen/Dense>
+
+#include <src/cpp/lennardjonesium/tools/system_parameters.hpp>
+#include <src/cpp/lennardjonesium/physics/system_state.hpp>
+#include <src/cpp/lennardjonesium/physics/derived_properties.hpp>
+#include <src/cpp/lennardjonesium/physics/lennard_jones_force.hpp>
+#include <src/cpp/lennardjonesium/engine/initial_condition.hpp>
+#include <src/cpp/lennardjonesium/engine/integrator.hpp>
+#include <src/cpp/lennardjonesium/engine/integrator_builder.hpp>
+#include <src/cpp/lennardjonesium/output/logger.hpp>
+#include <src/cpp/lennardjonesium/control/simulation_phase.hpp>
+#include <src/cpp/lennardjonesium/control/simulation_controller.hpp>
+
+SCENARIO("Relaxing a dense initial condition")
+{
+    namespace fs = std::filesystem;
+
+    fs::path test_dir{"test_energy_minimization"};
+    fs::create_directory(test_dir);
+
+    // A dense system whose lattice is not completely filled, so that the forces do not cancel
+    tools::SystemParameters system_parameters{
+        .temperature {0.8},
+        .density {1.2},
+        .particle_count {100}
+    };
+
+    engine::InitialCondition initial_condition(system_parameters);
+
+    physics::LennardJonesForce short_range_force({.cutoff_distance = 2.5});
+
+    // Take one ordinary time step so that the initial forces and potential energy are computed
+    auto measurement_integrator = engine::Integrator::Builder{0.005}
+        .bounding_box(initial_condition.bounding_box())
+        .short_range_force(short_range_force)
+        .build();
+
+    physics::SystemState initial_state = initial_condition.system_state();
+    initial_state | (*measurement_integrator)(1);
+
+    GIVEN("A schedule consisting of only a MinimizationPhase")
+    {
+        std::ofstream event_log{test_dir / "events.log"};
+        std::ofstream thermodynamic_log{test_dir / "thermodynamics.csv"};
+        std::ofstream observation_log{test_dir / "observations.csv"};
+        std::ofstream snapshot_log{test_dir / "snapshots.csv"};
+
+        output::Logger logger{output::Logger::Streams{
+            .event_log = event_log,
+            .thermodynamic_log = thermodynamic_log,
+            .observation_log = observation_log,
+            .snapshot_log = snapshot_log
+        }};
+
+        control::SimulationController::Schedule schedule;
+        schedule.push(
+            std::make_unique<control::MinimizationPhase>(
+                "Minimization Phase", system_parameters
+            )
+        );
+
+        auto integrator = engine::Integrator::Builder{0.005}
+            .bounding_box(initial_condition.bounding_box())
+            .short_range_force(short_range_force)
+            .build();
+
+        control::SimulationController simulation(
+            std::move(integrator),
+            std::move(schedule),
+            logger
+        );
+
+        WHEN("I run the minimization")
+        {
+            physics::SystemState state = initial_condition.system_state();
+
+            state | simulation;
+
+            logger.close();
+
+            THEN("The potential energy has decreased")
+            {
+                REQUIRE(state.potential_energy < initial_state.potential_energy);
+            }
+
+            THEN("The thermal velocities have been restored")
+            {
+                REQUIRE(physics::temperature(state) > 0.5 * system_parameters.temperature);
+            }
+        }
+    }
+
+    fs::remove_all(test_dir);
+}
@@ -0,0 +1,90 @@
+/**
+ * Test reading a Configuration from an INI file
+ */
+
+#include <sstream>
+#include <string>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/api/configuration.hpp>
+
+SCENARIO("Reading a Configuration from an INI file")
+{
+    GIVEN("An INI file as written by the Python Configuration")
+    {
+        std::istringstream input{
+            "[system]\n"
+            "temperature = 0.6\n"
+            "Particle_Count = 200\n"
+            "random_seed = 4000000000\n"
+            "\n"
+            "# A comment\n"
+            "[minimization]\n"
+            "enabled = True\n"
+            "name: Relax\n"
+            "\n"
+            "[observation]\n"
+            "name = Ob Phase (T = 0.6)\n"
+            "tolerance = 1e-1\n"
+            "unknown_key = 5\n"
+            "\n"
+            "[unknown_section]\n"
+            "temperature = x\n"
+            "\n"
+            "[filepaths]\n"
+            "event_log = data/events.log\n"
+            "trajectory = \n"
+        };
+
+        WHEN("I parse it")
+        {
+            auto configuration = api::parse_configuration(input);
+
+            THEN("The given settings are read, and the rest keep their defaults")
+            {
+                REQUIRE(configuration.system.temperature == 0.6);
+                REQUIRE(configuration.system.particle_count == 200);
+                REQUIRE(configuration.system.random_seed == 4000000000u);
+                REQUIRE(configuration.system.density == api::Configuration{}.system.density);
+
+                REQUIRE(configuration.minimization.enabled);
+                REQUIRE(configuration.minimization.name == "Relax");
+
+                REQUIRE(configuration.observation.name == "Ob Phase (T = 0.6)");
+                REQUIRE(configuration.observation.tolerance == 0.1);
+
+                REQUIRE(configuration.filepaths.event_log == "data/events.log");
+                REQUIRE(configuration.filepaths.trajectory.empty());
+            }
+        }
+    }
+
+    GIVEN("INI files with errors")
+    {
+        THEN("An invalid number is rejected")
+        {
+            std::istringstream input{"[system]\nparticle_count = 2.5\n"};
+            REQUIRE_THROWS_AS(api::parse_configuration(input), std::invalid_argument);
+        }
+
+        THEN("An invalid boolean is rejected")
+        {
+            std::istringstream input{"[minimization]\nenabled = maybe\n"};
+            REQUIRE_THROWS_AS(api::parse_configuration(input), std::invalid_argument);
+        }
+
+        THEN("A setting outside of any section is rejected")
+        {
+            std::istringstream input{"temperature = 0.6\n"};
+            REQUIRE_THROWS_AS(api::parse_configuration(input), std::invalid_argument);
+        }
+
+        THEN("A line which is not a setting is rejected")
+        {
+            std::istringstream input{"[system]\ntemperature\n"};
+            REQUIRE_THROWS_AS(api::parse_configuration(input), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ * Test the CostModel used to schedule jobs in the SimulationPool
+ */
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/physics/lennard_jones_force.hpp>
+#include <src/cpp/lennardjonesium/control/simulation_phase.hpp>
+#include <src/cpp/lennardjonesium/api/simulation.hpp>
+#include <src/cpp/lennardjonesium/api/cost_model.hpp>
+
+SCENARIO("Estimating the running time of Simulations")
+{
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 100
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.5
+        },
+
+        .schedule_parameters = {
+            {
+                "Equilibration Phase",
+                control::EquilibrationPhase::Parameters{.timeout = 1000}
+            },
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .observation_interval = 100,
+                    .observation_count = 10
+                }
+            }
+        }
+    };
+
+    api::CostModel cost_model;
+
+    WHEN("I compute the features of a Simulation")
+    {
+        auto features = api::CostModel::features(parameters);
+
+        THEN("They count the maximum number of time steps for each particle")
+        {
+            REQUIRE(features.particle_steps == Approx(2000 * 100));
+        }
+
+        AND_WHEN("I double the particle count, density, or replicas")
+        {
+            auto larger = parameters;
+            larger.system_parameters.particle_count *= 2;
+
+            auto denser = parameters;
+            denser.system_parameters.density *= 2;
+
+            auto replicated = parameters;
+            replicated.replica_count = 2;
+
+            THEN("The estimated cost grows accordingly")
+            {
+                double cost = cost_model.estimate(features);
+
+                REQUIRE(
+                    cost_model.estimate(api::CostModel::features(larger)) == Approx(2 * cost)
+                );
+                REQUIRE(
+                    cost_model.estimate(api::CostModel::features(replicated)) == Approx(2 * cost)
+                );
+                REQUIRE(cost_model.estimate(api::CostModel::features(denser)) > cost);
+                REQUIRE(cost_model.estimate(api::CostModel::features(denser)) < 2 * cost);
+            }
+        }
+    }
+
+    WHEN("I observe jobs which take three times as long as the default estimate")
+    {
+        auto small = parameters;
+        small.system_parameters.particle_count = 1000;
+
+        auto large = parameters;
+        large.system_parameters.particle_count = 4000;
+        large.system_parameters.density = 1.0;
+
+        api::CostModel default_model;
+
+        for (auto& job : {small, large, small, large, small, large})
+        {
+            auto features = api::CostModel::features(job);
+            cost_model.observe(features, 3 * default_model.estimate(features));
+        }
+
+        THEN("The estimates are refitted to the observed running times")
+        {
+            auto features = api::CostModel::features(parameters);
+
+            REQUIRE(cost_model.observation_count() == 6);
+            REQUIRE(
+                cost_model.estimate(features)
+                    == Approx(3 * default_model.estimate(features)).epsilon(0.05)
+            );
+        }
+    }
+}
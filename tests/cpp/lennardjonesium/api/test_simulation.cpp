@@ -2,15 +2,29 @@
  * Test a complete run of a Simulation
  */
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
 #include <src/cpp/lennardjonesium/physics/lennard_jones_force.hpp>
+#include <src/cpp/lennardjonesium/output/trajectory.hpp>
+#include <src/cpp/lennardjonesium/output/async_file.hpp>
+#include <src/cpp/lennardjonesium/output/log_compression.hpp>
 #include <src/cpp/lennardjonesium/control/simulation_phase.hpp>
 #include <src/cpp/lennardjonesium/api/simulation.hpp>
+#include <src/cpp/lennardjonesium/api/simulation_buffer.hpp>
 
 namespace fs = std::filesystem;
 
@@ -31,6 +45,25 @@ inline int count_lines(fs::path file_path)
     return count;
 }
 
+inline std::string read_file(fs::path file_path)
+{
+    std::ifstream fin{file_path, std::ios::binary};
+    std::ostringstream contents;
+    contents << fin.rdbuf();
+    return contents.str();
+}
+
+inline std::string read_compressed_file(fs::path file_path)
+{
+    boost::iostreams::filtering_istream fin;
+    output::push_decompressor(fin, output::detect_compression(file_path));
+    fin.push(boost::iostreams::file_source{file_path.string(), std::ios::binary});
+
+    std::ostringstream contents;
+    contents << fin.rdbuf();
+    return contents.str();
+}
+
 SCENARIO("Running a simulation from a Simulation object")
 {
     // First set up the directory for writing simulation data files
@@ -112,6 +145,536 @@ SCENARIO("Running a simulation from a Simulation object")
         }
     }
 
+    WHEN("I start another simulation from the final state of the first")
+    {
+        simulation.run();
+        auto final_state = simulation.final_state();
+
+        auto next_parameters = parameters;
+        next_parameters.system_parameters.temperature = 0.9;
+        next_parameters.initial_state = final_state;
+        api::Simulation next_simulation{next_parameters};
+
+        next_simulation.run();
+
+        THEN("The final state is kept after the run")
+        {
+            REQUIRE(final_state != nullptr);
+            REQUIRE(final_state->particle_count() == parameters.system_parameters.particle_count);
+            REQUIRE(final_state->time > 0.0);
+        }
+
+        THEN("The next simulation continues from it, without changing it")
+        {
+            REQUIRE(next_simulation.final_state() != final_state);
+            REQUIRE(simulation.final_state() == final_state);
+            REQUIRE(
+                count_lines(next_parameters.observation_log_path) == observation_count + 1
+            );
+        }
+
+        THEN("A state with the wrong number of particles is rejected")
+        {
+            auto wrong_parameters = next_parameters;
+            wrong_parameters.system_parameters.particle_count = 60;
+
+            REQUIRE_THROWS_AS(api::Simulation{wrong_parameters}, std::invalid_argument);
+        }
+    }
+
+    WHEN("I run the simulation with its logs kept in memory")
+    {
+        // For comparison, write the same logs to files in the binary format
+        auto binary_parameters = parameters;
+        binary_parameters.thermodynamic_log_format = output::LogFormat::binary;
+        binary_parameters.observation_log_format = output::LogFormat::binary;
+        api::Simulation{binary_parameters}.run();
+
+        auto event_log = read_file(parameters.event_log_path);
+        auto thermodynamic_log = read_file(parameters.thermodynamic_log_path);
+        auto observation_log = read_file(parameters.observation_log_path);
+        fs::remove_all(test_dir);
+
+        auto memory_parameters = parameters;
+        memory_parameters.file_backend = output::FileBackend::memory;
+        api::Simulation memory_simulation{memory_parameters};
+
+        memory_simulation.run();
+        auto memory_logs = memory_simulation.memory_logs();
+
+        auto contents = [](const auto& buffer)
+        {
+            return std::string{buffer->begin(), buffer->end()};
+        };
+
+        THEN("The logs are the same as the binary log files")
+        {
+            REQUIRE(contents(memory_logs.event_log) == event_log);
+            REQUIRE(contents(memory_logs.thermodynamic_log) == thermodynamic_log);
+            REQUIRE(contents(memory_logs.observation_log) == observation_log);
+        }
+
+        THEN("The snapshot has one binary record per particle")
+        {
+            std::uint64_t data_offset = 0;
+            std::uint64_t record_size = 0;
+            std::memcpy(&data_offset, memory_logs.snapshot_log->data() + 8, 8);
+            std::memcpy(&record_size, memory_logs.snapshot_log->data() + 16, 8);
+
+            REQUIRE(record_size == 10 * 8);
+            REQUIRE(
+                memory_logs.snapshot_log->size()
+                == data_offset + record_size * parameters.system_parameters.particle_count
+            );
+        }
+
+        THEN("No log files are written")
+        {
+            REQUIRE_FALSE(fs::exists(parameters.event_log_path));
+            REQUIRE_FALSE(fs::exists(parameters.thermodynamic_log_path));
+            REQUIRE_FALSE(fs::exists(parameters.observation_log_path));
+            REQUIRE_FALSE(fs::exists(parameters.snapshot_log_path));
+        }
+
+        AND_WHEN("I run the simulation again")
+        {
+            memory_simulation.run();
+
+            THEN("The earlier logs are kept as they were")
+            {
+                REQUIRE(contents(memory_logs.observation_log) == observation_log);
+                REQUIRE(
+                    memory_simulation.memory_logs().observation_log != memory_logs.observation_log
+                );
+            }
+        }
+
+        AND_WHEN("I read the results while it runs again in another thread")
+        {
+            auto final_state = memory_simulation.final_state();
+            std::atomic<bool> finished = false;
+            bool only_complete_results = true;
+
+            {
+                std::jthread runner{
+                    [&]()
+                    {
+                        memory_simulation.run();
+                        finished = true;
+                    }
+                };
+
+                while (!finished)
+                {
+                    // Either the logs of the run before, or the whole logs of the new one, but
+                    // never a buffer which is still being written
+                    auto logs = memory_simulation.memory_logs();
+
+                    if (logs.observation_log != memory_logs.observation_log
+                        && contents(logs.observation_log) != observation_log)
+                    {
+                        only_complete_results = false;
+                    }
+                }
+            }
+
+            THEN("The new results only appear once the run has finished")
+            {
+                auto new_logs = memory_simulation.memory_logs();
+
+                REQUIRE(only_complete_results);
+                REQUIRE(contents(new_logs.observation_log) == observation_log);
+                REQUIRE(memory_simulation.final_state() != final_state);
+            }
+        }
+    }
+
+    WHEN("I run a simulation whose log directory does not exist")
+    {
+        auto missing_parameters = parameters;
+        missing_parameters.event_log_path = test_dir / "missing" / "events.log";
+
+        api::Simulation missing_simulation{missing_parameters};
+
+        THEN("The run throws, rather than writing nothing")
+        {
+            REQUIRE_THROWS_AS(missing_simulation.run(), fs::filesystem_error);
+        }
+
+        THEN("A SimulationBuffer passes the exception on from its thread")
+        {
+            api::SimulationBuffer buffer;
+            buffer.launch(missing_simulation);
+
+            while (!buffer.read().empty()) {}
+
+            REQUIRE_THROWS_AS(buffer.wait(), fs::filesystem_error);
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
+
+SCENARIO("Resuming a simulation from a checkpoint")
+{
+    fs::path test_dir{"test_simulation_checkpoint"};
+    fs::create_directory(test_dir);
+
+    // Use all three kinds of phase, so that every phase must save and restore its state
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 50
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.0
+        },
+
+        .time_delta = 0.005,
+
+        .schedule_parameters = {
+            {
+                "Minimization Phase",
+                control::MinimizationPhase::Parameters{.check_interval = 10, .timeout = 150}
+            },
+            {
+                "Equilibration Phase",
+                control::EquilibrationPhase::Parameters
+                {
+                    .tolerance = 0.2,
+                    .sample_size = 20,
+                    .adjustment_interval = 100,
+                    .steady_state_time = 200,
+                    .timeout = 3000
+                }
+            },
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .tolerance = 10.0,
+                    .sample_size = 20,
+                    .observation_interval = 100,
+                    .observation_count = 5
+                }
+            }
+        },
+
+        .event_log_path = test_dir / "events.log",
+        .thermodynamic_log_path = test_dir / "thermodynamics.csv",
+        .observation_log_path = test_dir / "observations.csv",
+        .snapshot_log_path = test_dir / "snapshots.csv",
+
+        .checkpoint_path = test_dir / "simulation.checkpoint",
+        .checkpoint_interval = 250
+    };
+
+    std::vector<fs::path> log_paths{
+        parameters.event_log_path,
+        parameters.thermodynamic_log_path,
+        parameters.observation_log_path,
+        parameters.snapshot_log_path
+    };
+
+    api::Simulation simulation{parameters};
+
+    GIVEN("The output of an uninterrupted run, which leaves behind its last checkpoint")
+    {
+        simulation.run();
+
+        std::vector<std::string> expected;
+        for (const auto& path : log_paths) {expected.push_back(read_file(path));}
+
+        REQUIRE(fs::exists(parameters.checkpoint_path));
+
+        WHEN("I resume the simulation from the checkpoint")
+        {
+            simulation.resume();
+
+            THEN("The log files are identical to those of the uninterrupted run")
+            {
+                for (std::size_t i = 0; i < log_paths.size(); ++i)
+                {
+                    REQUIRE(expected[i] == read_file(log_paths[i]));
+                }
+            }
+        }
+
+        WHEN("I run and resume the simulation with asynchronous file output")
+        {
+            std::vector<std::vector<std::string>> outputs;
+
+            for (auto backend : {output::FileBackend::async, output::FileBackend::direct})
+            {
+                auto async_parameters = parameters;
+                async_parameters.file_backend = backend;
+                api::Simulation async_simulation{async_parameters};
+
+                async_simulation.run();
+                async_simulation.resume();
+
+                outputs.emplace_back();
+                for (const auto& path : log_paths) {outputs.back().push_back(read_file(path));}
+            }
+
+            THEN("The log files are identical to those written synchronously")
+            {
+                for (const auto& output : outputs)
+                {
+                    REQUIRE(output == expected);
+                }
+            }
+        }
+
+        WHEN("I run the simulation again with compressed logs")
+        {
+            auto compression = GENERATE(output::LogCompression::gzip, output::LogCompression::zstd);
+
+            auto compressed_parameters = parameters;
+            compressed_parameters.log_compression = compression;
+            compressed_parameters.checkpoint_path.clear();
+            api::Simulation compressed_simulation{compressed_parameters};
+
+            compressed_simulation.run();
+
+            THEN("The text logs are compressed, and decompress to those of the first run")
+            {
+                // The event log is not compressed
+                for (std::size_t i = 1; i < log_paths.size(); ++i)
+                {
+                    REQUIRE(output::detect_compression(log_paths[i]) == compression);
+                    REQUIRE(fs::file_size(log_paths[i]) < expected[i].size());
+                    REQUIRE(read_compressed_file(log_paths[i]) == expected[i]);
+                }
+            }
+        }
+
+        WHEN("I ask for compressed logs together with checkpoints")
+        {
+            auto compressed_parameters = parameters;
+            compressed_parameters.log_compression = output::LogCompression::zstd;
+
+            THEN("The simulation is rejected")
+            {
+                REQUIRE_THROWS_AS(
+                    api::Simulation{compressed_parameters}, std::invalid_argument
+                );
+            }
+        }
+
+        WHEN("I resume a different simulation from the same checkpoint")
+        {
+            auto other_parameters = parameters;
+            other_parameters.random_seed += 1;
+            api::Simulation other_simulation{other_parameters};
+
+            THEN("The checkpoint is rejected")
+            {
+                REQUIRE_THROWS(other_simulation.resume());
+            }
+        }
+    }
+
+    WHEN("I resume a simulation which has no checkpoint")
+    {
+        fs::remove(parameters.checkpoint_path);
+        simulation.resume();
+
+        THEN("It runs from the beginning")
+        {
+            REQUIRE(count_lines(parameters.observation_log_path) == 5 + 1);
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
+
+SCENARIO("Running independent replicas of a simulation")
+{
+    fs::path test_dir{"test_simulation_replicas"};
+    fs::create_directory(test_dir);
+
+    int observation_count = 5;
+
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 50
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.0
+        },
+
+        .time_delta = 0.005,
+
+        .schedule_parameters = {
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .tolerance = 10.0,
+                    .sample_size = 25,
+                    .observation_interval = 100,
+                    .observation_count = observation_count
+                }
+            }
+        },
+
+        .event_log_path = test_dir / "events.log",
+        .thermodynamic_log_path = test_dir / "thermodynamics.csv",
+        .observation_log_path = test_dir / "observations.csv",
+        .snapshot_log_path = test_dir / "snapshots.csv",
+
+        .replica_count = 3
+    };
+
+    api::Simulation simulation{parameters};
+
+    WHEN("I run the simulation")
+    {
+        simulation.run();
+
+        THEN("Each replica writes its own observations")
+        {
+            REQUIRE(count_lines(test_dir / "observations.replica0.csv") == observation_count + 1);
+            REQUIRE(count_lines(test_dir / "observations.replica1.csv") == observation_count + 1);
+            REQUIRE(count_lines(test_dir / "observations.replica2.csv") == observation_count + 1);
+
+            REQUIRE(count_lines(test_dir / "events.replica1.log") == observation_count + 2);
+            REQUIRE(count_lines(test_dir / "thermodynamics.replica2.csv") > 1);
+        }
+
+        THEN("The replicas are not identical")
+        {
+            REQUIRE(
+                read_file(test_dir / "observations.replica1.csv")
+                != read_file(test_dir / "observations.replica2.csv")
+            );
+        }
+
+        THEN("The main observation log combines all replicas with error estimates")
+        {
+            std::ifstream fin{parameters.observation_log_path};
+            std::string header;
+            std::getline(fin, header);
+
+            REQUIRE(header.starts_with("TimeStep,Temperature,TemperatureError,"));
+            REQUIRE(header.ends_with(",Replicas"));
+
+            std::string row;
+            int rows = 0;
+
+            while (std::getline(fin, row))
+            {
+                REQUIRE(row.ends_with(",3"));
+                ++rows;
+            }
+
+            REQUIRE(rows == observation_count);
+        }
+    }
+
+    WHEN("I run the replicas on a team of fewer threads than replicas")
+    {
+        REQUIRE(simulation.requested_thread_count() == 3);
+
+        simulation.run();
+        auto all_threads = read_file(parameters.observation_log_path);
+
+        simulation.run(api::Simulation::Echo::Silent(), nullptr, 2);
+        auto two_threads = read_file(parameters.observation_log_path);
+
+        THEN("The combined observations are the same")
+        {
+            REQUIRE(two_threads == all_threads);
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
+
+SCENARIO("Recording the trajectory of a simulation")
+{
+    fs::path test_dir{"test_simulation_trajectory"};
+    fs::create_directory(test_dir);
+
+    int observation_interval = 100;
+    int observation_count = 5;
+    int snapshot_interval = 50;
+
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 50
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.0
+        },
+
+        .time_delta = 0.005,
+
+        .schedule_parameters = {
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .tolerance = 10.0,
+                    .sample_size = 25,
+                    .observation_interval = observation_interval,
+                    .observation_count = observation_count
+                }
+            }
+        },
+
+        .event_log_path = test_dir / "events.log",
+        .thermodynamic_log_path = test_dir / "thermodynamics.csv",
+        .observation_log_path = test_dir / "observations.csv",
+        .snapshot_log_path = test_dir / "snapshots.csv",
+
+        .trajectory_path = test_dir / "trajectory.bin",
+        .snapshot_interval = snapshot_interval
+    };
+
+    api::Simulation simulation{parameters};
+
+    WHEN("I run the simulation")
+    {
+        simulation.run();
+
+        output::TrajectoryReader reader{parameters.trajectory_path};
+
+        THEN("A frame is recorded at every snapshot interval")
+        {
+            int frame_count = observation_interval * observation_count / snapshot_interval;
+
+            REQUIRE(reader.good());
+            REQUIRE(reader.particle_count() == 50);
+            REQUIRE(reader.frame_count() == static_cast<std::size_t>(frame_count));
+
+            for (int i = 0; i < frame_count; ++i)
+            {
+                auto frame = reader.frame(i);
+                REQUIRE(frame.time_step == (i + 1) * snapshot_interval);
+                REQUIRE(frame.frame.time == Approx(frame.time_step * parameters.time_delta));
+            }
+        }
+    }
+
     // Clean up
     fs::remove_all(test_dir);
 }
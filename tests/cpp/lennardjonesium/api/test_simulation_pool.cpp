@@ -2,14 +2,24 @@
  * Test a complete run of a Simulation
  */
 
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <ranges>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <atomic>
+#include <exception>
 
 #include <catch2/catch.hpp>
 
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 #include <src/cpp/lennardjonesium/physics/lennard_jones_force.hpp>
 #include <src/cpp/lennardjonesium/control/simulation_phase.hpp>
 #include <src/cpp/lennardjonesium/api/simulation.hpp>
@@ -108,8 +118,40 @@ SCENARIO("Running a pool of simulations")
             simulation_pool.push(s);
         }
 
+        // Poll the progress of the running jobs while waiting
+        bool progress_in_range = true;
+
+        while (simulation_pool.status().completed < job_count)
+        {
+            for (const auto& [job, report] : simulation_pool.progress())
+            {
+                progress_in_range = progress_in_range
+                    && job >= 0 && job < job_count
+                    && report.time_step <= report.expected_time_steps;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
         simulation_pool.wait();
 
+#ifdef __linux__
+        THEN("The completion fd was signaled once for every job")
+        {
+            std::uint64_t completions = 0;
+            auto bytes = read(simulation_pool.completion_fd(), &completions, sizeof(completions));
+
+            REQUIRE(bytes == sizeof(completions));
+            REQUIRE(completions == static_cast<std::uint64_t>(job_count));
+        }
+#endif
+
+        THEN("The progress of each job stayed within its expected length")
+        {
+            REQUIRE(progress_in_range);
+            REQUIRE(simulation_pool.progress().empty());
+        }
+
         THEN("I get the expected output files")
         {
             int event_lines = observation_count + 2;
@@ -123,6 +165,241 @@ SCENARIO("Running a pool of simulations")
                 REQUIRE(observation_lines == count_lines(s.parameters().observation_log_path));
             }
         }
+
+        THEN("The Status reports the makespan of the batch")
+        {
+            auto status = simulation_pool.status();
+
+            REQUIRE(status.completed == job_count);
+            REQUIRE(status.makespan > 0.0);
+            REQUIRE(status.cores_in_use == 0);
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
+
+SCENARIO("Running chains of warm-started simulations")
+{
+    fs::path test_dir{"test_simulation_pool_chains"};
+    fs::create_directory(test_dir);
+
+    int chain_count = 3;
+    int chain_length = 3;
+
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 50
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.0
+        },
+
+        .time_delta = 0.005,
+
+        .schedule_parameters = {
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .tolerance = 10.0,
+                    .sample_size = 25,
+                    .observation_interval = 50,
+                    .observation_count = 4
+                }
+            }
+        }
+    };
+
+    // Each chain steps down in temperature, starting each link from the previous final state
+    std::vector<api::Simulation> simulations;
+    simulations.reserve(chain_count * chain_length);
+
+    for (auto i : std::views::iota(0, chain_count))
+    {
+        fs::path previous_state_path = "";
+
+        for (auto j : std::views::iota(0, chain_length))
+        {
+            fs::path subdirectory = test_dir / (std::to_string(i) + "_" + std::to_string(j));
+            fs::create_directory(subdirectory);
+
+            parameters.system_parameters.temperature = 1.0 - 0.1 * j;
+            parameters.event_log_path = subdirectory / "events.log";
+            parameters.thermodynamic_log_path = subdirectory / "thermodynamics.csv";
+            parameters.observation_log_path = subdirectory / "observations.csv";
+            parameters.snapshot_log_path = subdirectory / "snapshots.csv";
+            parameters.initial_state_path = previous_state_path;
+            parameters.final_state_path = subdirectory / "final_state.bin";
+
+            simulations.emplace_back(parameters);
+            previous_state_path = parameters.final_state_path;
+        }
+    }
+
+    api::SimulationPool simulation_pool(2);
+
+    WHEN("I push the chains onto the queue and wait for them to finish")
+    {
+        for (auto i : std::views::iota(0, chain_count))
+        {
+            api::SimulationPool::Chain chain;
+
+            for (auto j : std::views::iota(0, chain_length))
+            {
+                chain.push_back(simulations[i * chain_length + j]);
+            }
+
+            simulation_pool.push_chain(std::move(chain));
+        }
+
+        simulation_pool.wait();
+
+        THEN("Every simulation ran and saved its final state")
+        {
+            auto status = simulation_pool.status();
+            REQUIRE(status.completed == chain_count * chain_length);
+
+            for (auto& s : simulations)
+            {
+                REQUIRE(fs::exists(s.parameters().final_state_path));
+                REQUIRE(5 == count_lines(s.parameters().observation_log_path));
+            }
+        }
+    }
+
+    WHEN("I push the chains with completion handlers")
+    {
+        std::atomic<int> completed_chains{0};
+        std::atomic<int> errors{0};
+
+        for (auto i : std::views::iota(0, chain_count))
+        {
+            api::SimulationPool::Chain chain;
+
+            for (auto j : std::views::iota(0, chain_length))
+            {
+                chain.push_back(simulations[i * chain_length + j]);
+            }
+
+            simulation_pool.push_chain(
+                std::move(chain),
+                [&](std::exception_ptr error)
+                {
+                    if (error) {++errors;}
+                    ++completed_chains;
+                }
+            );
+        }
+
+        simulation_pool.wait();
+
+        THEN("Each handler was called once, without an error")
+        {
+            REQUIRE(completed_chains == chain_count);
+            REQUIRE(errors == 0);
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
+
+SCENARIO("Running simulations which ask for several cores")
+{
+    fs::path test_dir{"test_simulation_pool_cores"};
+    fs::create_directory(test_dir);
+
+    int observation_count = 4;
+
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 50
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.0
+        },
+
+        .time_delta = 0.005,
+
+        .schedule_parameters = {
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .tolerance = 10.0,
+                    .sample_size = 25,
+                    .observation_interval = 50,
+                    .observation_count = observation_count
+                }
+            }
+        }
+    };
+
+    // Alternate between jobs with three replicas (asking for three cores) and with one
+    std::vector<api::Simulation> simulations;
+
+    for (auto i : std::views::iota(0, 6))
+    {
+        fs::path subdirectory = test_dir / std::to_string(i);
+        fs::create_directory(subdirectory);
+
+        parameters.replica_count = (i % 2 == 0) ? 3 : 1;
+        parameters.event_log_path = subdirectory / "events.log";
+        parameters.thermodynamic_log_path = subdirectory / "thermodynamics.csv";
+        parameters.observation_log_path = subdirectory / "observations.csv";
+        parameters.snapshot_log_path = subdirectory / "snapshots.csv";
+
+        simulations.emplace_back(parameters);
+    }
+
+    // A budget of two cores, which is less than the large jobs ask for.  The workers are pinned
+    // to single cores, so they are widened to their node for the large jobs.
+    api::SimulationPool simulation_pool(2, 1, api::SimulationPool::Affinity::core);
+
+    WHEN("I push all the jobs onto the queue and wait for them to finish")
+    {
+        for (auto& s : simulations)
+        {
+            simulation_pool.push(s);
+        }
+
+        simulation_pool.wait();
+
+        THEN("Every job ran, and all cores were given back")
+        {
+            auto status = simulation_pool.status();
+
+            REQUIRE(status.completed == 6);
+            REQUIRE(status.cores_in_use == 0);
+
+            for (auto& s : simulations)
+            {
+                REQUIRE(observation_count + 1 == count_lines(s.parameters().observation_log_path));
+            }
+        }
+    }
+
+    WHEN("I ask for an affinity by name")
+    {
+        THEN("Only the known names are accepted")
+        {
+            REQUIRE(
+                api::SimulationPool::parse_affinity("core") == api::SimulationPool::Affinity::core
+            );
+            REQUIRE_THROWS_AS(api::SimulationPool::parse_affinity("socket"), std::invalid_argument);
+        }
     }
 
     // Clean up
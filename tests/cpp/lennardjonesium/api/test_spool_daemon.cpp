@@ -0,0 +1,184 @@
+/**
+ * Test running simulations from a spool directory
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <stop_token>
+#include <system_error>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/api/simulation_pool.hpp>
+#include <src/cpp/lennardjonesium/api/spool_daemon.hpp>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // A small simulation, which writes its logs to the job directory
+    const std::string config_text{
+        "[system]\n"
+        "temperature = 0.8\n"
+        "density = 0.8\n"
+        "particle_count = 50\n"
+        "cutoff_distance = 2.0\n"
+        "\n"
+        "[equilibration]\n"
+        "tolerance = 10.0\n"
+        "sample_size = 25\n"
+        "steady_state_time = 50\n"
+        "\n"
+        "[observation]\n"
+        "tolerance = 10.0\n"
+        "sample_size = 25\n"
+        "observation_interval = 50\n"
+        "observation_count = 4\n"
+        "\n"
+        "[filepaths]\n"
+        "observation_log = data/observations.csv\n"
+        "final_state = final_state.bin\n"
+    };
+
+    // A config which cannot be parsed
+    const std::string broken_text{"[system]\nparticle_count = many\n"};
+
+    // Writes a config into the incoming directory, as a submitter should (by renaming it in)
+    void submit(const fs::path& spool_dir, const std::string& name, const std::string& text)
+    {
+        auto temporary = spool_dir / (name + ".tmp");
+        std::ofstream{temporary} << text;
+        fs::rename(temporary, spool_dir / "incoming" / name);
+    }
+
+    // Waits (for a while) until the given path exists
+    bool wait_for(const fs::path& path)
+    {
+        for (int i = 0; i < 600 && !fs::exists(path); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        }
+
+        return fs::exists(path);
+    }
+}
+
+SCENARIO("Running simulations from a spool directory")
+{
+    fs::path spool_dir{"test_spool_daemon"};
+    fs::remove_all(spool_dir);
+
+    api::SpoolDaemon daemon{{
+        .spool_directory = spool_dir,
+        .thread_count = 2,
+        .affinity = api::SimulationPool::Affinity::none
+    }};
+
+    // A config which is already waiting when the daemon starts
+    submit(spool_dir, "early.ini", config_text);
+
+    // The daemon is stopped when the thread is asked to stop (including when a test fails)
+    std::ostringstream log;
+    std::jthread daemon_thread{
+        [&](std::stop_token stop_token)
+        {
+            std::stop_callback stop_daemon{stop_token, [&]() {daemon.stop();}};
+            daemon.run(log);
+        }
+    };
+
+    WHEN("I submit more configs while the daemon is running")
+    {
+        submit(spool_dir, "late.ini", config_text);
+        submit(spool_dir, "broken.ini", broken_text);
+
+        // A second job with the same name, once the first is out of the way
+        REQUIRE(wait_for(spool_dir / "done" / "early"));
+        submit(spool_dir, "early.ini", config_text);
+
+        REQUIRE(wait_for(spool_dir / "done" / "early.1"));
+        REQUIRE(wait_for(spool_dir / "done" / "late"));
+        REQUIRE(wait_for(spool_dir / "failed" / "broken"));
+
+        daemon_thread.request_stop();
+        daemon_thread.join();
+
+        THEN("Each job ran in its own directory, which was moved to done/")
+        {
+            for (auto name : {"early", "early.1", "late"})
+            {
+                auto job_dir = spool_dir / "done" / name;
+
+                REQUIRE(fs::exists(job_dir / "final_state.bin"));
+                REQUIRE(fs::exists(job_dir / "data" / "observations.csv"));
+                REQUIRE(fs::exists(job_dir / "events.log"));
+            }
+
+            REQUIRE(fs::exists(spool_dir / "done" / "early" / "early.ini"));
+        }
+
+        THEN("The config which could not be read was moved to failed/, with the error")
+        {
+            REQUIRE(fs::exists(spool_dir / "failed" / "broken" / "broken.ini"));
+            REQUIRE(fs::exists(spool_dir / "failed" / "broken" / "error.txt"));
+            REQUIRE(log.str().find("Failed broken") != std::string::npos);
+        }
+
+        THEN("Nothing is left in incoming/ or running/")
+        {
+            REQUIRE(fs::is_empty(spool_dir / "incoming"));
+            REQUIRE(fs::is_empty(spool_dir / "running"));
+        }
+    }
+
+    WHEN("Configs vanish while the daemon is taking them")
+    {
+        REQUIRE(wait_for(spool_dir / "done" / "early"));
+
+        // The configs are removed again, from the last one back, while the daemon takes them from
+        // the first one on, so some of them are gone between its scan and its move to running/
+        constexpr int config_count = 200;
+
+        for (int i = 0; i < config_count; ++i)
+        {
+            submit(spool_dir, "vanishing" + std::to_string(1000 + i) + ".ini", broken_text);
+        }
+
+        for (int i = config_count - 1; i >= 0; --i)
+        {
+            std::error_code error;
+            fs::remove(
+                spool_dir / "incoming" / ("vanishing" + std::to_string(1000 + i) + ".ini"), error
+            );
+        }
+
+        // The daemon is still taking new jobs
+        submit(spool_dir, "late.ini", config_text);
+        REQUIRE(wait_for(spool_dir / "done" / "late"));
+
+        daemon_thread.request_stop();
+        daemon_thread.join();
+
+        THEN("The jobs it did take failed, and nothing is left in incoming/ or running/")
+        {
+            for (const auto& entry : fs::directory_iterator{spool_dir / "failed"})
+            {
+                REQUIRE(entry.path().filename().string().starts_with("vanishing"));
+                REQUIRE(fs::exists(entry.path() / "error.txt"));
+            }
+
+            REQUIRE(fs::is_empty(spool_dir / "incoming"));
+            REQUIRE(fs::is_empty(spool_dir / "running"));
+        }
+    }
+
+    daemon_thread.request_stop();
+    if (daemon_thread.joinable()) {daemon_thread.join();}
+
+    // Clean up
+    fs::remove_all(spool_dir);
+}
@@ -0,0 +1,195 @@
+/**
+ * Test the equilibrated-state cache
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <chrono>
+
+#include <catch2/catch.hpp>
+#include <Eigen/Dense>
+
+#include <src/cpp/lennardjonesium/physics/system_state.hpp>
+#include <src/cpp/lennardjonesium/physics/lennard_jones_force.hpp>
+#include <src/cpp/lennardjonesium/control/simulation_phase.hpp>
+#include <src/cpp/lennardjonesium/api/simulation.hpp>
+#include <src/cpp/lennardjonesium/api/state_cache.hpp>
+
+namespace fs = std::filesystem;
+
+SCENARIO("Storing and loading equilibrated states")
+{
+    fs::path cache_dir{"test_state_cache"};
+    fs::remove_all(cache_dir);
+
+    physics::SystemState state{10};
+    state.positions = Eigen::Matrix4Xd::Random(4, 10);
+    state.velocities = Eigen::Matrix4Xd::Random(4, 10);
+    state.time = 3.5;
+
+    GIVEN("A cache with room for a few entries")
+    {
+        auto entry_size = [&]()
+        {
+            api::StateCache probe{cache_dir, 1 << 30};
+            probe.store("probe", state);
+            auto size = fs::file_size(probe.entry_path("probe"));
+            fs::remove(probe.entry_path("probe"));
+            return size;
+        }();
+
+        api::StateCache cache{cache_dir, 3 * entry_size + entry_size / 2};
+
+        WHEN("I store a state")
+        {
+            cache.store("key A", state);
+
+            THEN("I can load it back with the same key")
+            {
+                auto loaded = cache.load("key A");
+
+                REQUIRE(loaded.has_value());
+                REQUIRE(loaded->positions == state.positions);
+                REQUIRE(loaded->velocities == state.velocities);
+                REQUIRE(loaded->time == state.time);
+            }
+
+            THEN("A different key misses")
+            {
+                REQUIRE(!cache.load("key B").has_value());
+            }
+        }
+
+        WHEN("An entry file holds a different key")
+        {
+            cache.store("key A", state);
+            fs::rename(cache.entry_path("key A"), cache.entry_path("key B"));
+
+            THEN("The stored key is checked, and the lookup misses")
+            {
+                REQUIRE(!cache.load("key B").has_value());
+            }
+        }
+
+        WHEN("I store more entries than fit")
+        {
+            using namespace std::chrono_literals;
+
+            cache.store("key 1", state);
+            cache.store("key 2", state);
+            cache.store("key 3", state);
+
+            // Make the ages distinct, then use the oldest so that it becomes the newest
+            auto now = fs::file_time_type::clock::now();
+            fs::last_write_time(cache.entry_path("key 1"), now - 30s);
+            fs::last_write_time(cache.entry_path("key 2"), now - 20s);
+            fs::last_write_time(cache.entry_path("key 3"), now - 10s);
+            REQUIRE(cache.load("key 1").has_value());
+
+            cache.store("key 4", state);
+
+            THEN("The least recently used entry is evicted")
+            {
+                REQUIRE(cache.load("key 1").has_value());
+                REQUIRE(!cache.load("key 2").has_value());
+                REQUIRE(cache.load("key 3").has_value());
+                REQUIRE(cache.load("key 4").has_value());
+            }
+        }
+    }
+
+    fs::remove_all(cache_dir);
+}
+
+SCENARIO("Skipping equilibration with a cached state")
+{
+    fs::path test_dir{"test_state_cache_simulation"};
+    fs::remove_all(test_dir);
+    fs::create_directory(test_dir);
+
+    auto parameters = api::Simulation::Parameters
+    {
+        .system_parameters = {
+            .temperature = 0.8,
+            .density = 0.8,
+            .particle_count = 50
+        },
+
+        .force_parameters = physics::LennardJonesForce::Parameters
+        {
+            .cutoff_distance = 2.0
+        },
+
+        .time_delta = 0.005,
+
+        .schedule_parameters = {
+            {
+                "Equilibration Phase",
+                control::EquilibrationPhase::Parameters
+                {
+                    .tolerance = 0.2,
+                    .sample_size = 20,
+                    .adjustment_interval = 100,
+                    .steady_state_time = 200,
+                    .timeout = 3000
+                }
+            },
+            {
+                "Observation Phase",
+                control::ObservationPhase::Parameters
+                {
+                    .tolerance = 10.0,
+                    .sample_size = 20,
+                    .observation_interval = 50,
+                    .observation_count = 4
+                }
+            }
+        },
+
+        .event_log_path = test_dir / "events.log",
+        .thermodynamic_log_path = test_dir / "thermodynamics.csv",
+        .observation_log_path = test_dir / "observations.csv",
+        .snapshot_log_path = test_dir / "snapshots.csv",
+
+        .state_cache_path = test_dir / "cache"
+    };
+
+    auto read_events = [&]()
+    {
+        std::ifstream fin{parameters.event_log_path};
+        return std::string{std::istreambuf_iterator<char>{fin}, {}};
+    };
+
+    WHEN("I run the same simulation twice")
+    {
+        api::Simulation{parameters}.run();
+        auto first_events = read_events();
+
+        api::Simulation{parameters}.run();
+        auto second_events = read_events();
+
+        THEN("Only the first run equilibrates")
+        {
+            REQUIRE(first_events.find("Phase started: Equilibration Phase") != std::string::npos);
+            REQUIRE(second_events.find("0: Phase skipped: Equilibration Phase") == 0);
+            REQUIRE(second_events.find("Phase started: Equilibration Phase") == std::string::npos);
+            REQUIRE(second_events.find("Phase complete: Observation Phase") != std::string::npos);
+        }
+    }
+
+    WHEN("I change the seed")
+    {
+        api::Simulation{parameters}.run();
+
+        parameters.random_seed += 1;
+        api::Simulation{parameters}.run();
+
+        THEN("The cache misses and the simulation equilibrates")
+        {
+            REQUIRE(read_events().find("Phase started: Equilibration Phase") != std::string::npos);
+        }
+    }
+
+    fs::remove_all(test_dir);
+}
@@ -0,0 +1,174 @@
+/**
+ * Test MinimizationPhase
+ */
+
+#include <ranges>
+#include <variant>
+
+#include <catch2/catch.hpp>
+#include <Eigen/Dense>
+
+#include <src/cpp/lennardjonesium/tools/system_parameters.hpp>
+#include <src/cpp/lennardjonesium/physics/system_state.hpp>
+#include <src/cpp/lennardjonesium/physics/measurements.hpp>
+#include <src/cpp/lennardjonesium/control/command_queue.hpp>
+#include <src/cpp/lennardjonesium/control/simulation_phase.hpp>
+
+SCENARIO("Minimization Phase decision-making")
+{
+    // Define system parameters
+    tools::SystemParameters system_parameters{
+        .temperature {0.5},
+        .density {1.0},
+        .particle_count {10}
+    };
+
+    // Create a state whose potential energy we can set by hand
+    physics::SystemState state(system_parameters.particle_count);
+
+    // Create measurement object
+    physics::ThermodynamicMeasurement measurement;
+
+    // Create the minimization parameters
+    control::MinimizationPhase::Parameters minimization_parameters{
+        .energy_tolerance {1.0e-3},
+        .check_interval {10},
+        .timeout {100}
+    };
+
+    int start_time{42};
+
+    // Create the MinimizationPhase object
+    control::MinimizationPhase minimization_phase{
+        "Test Minimization Phase",
+        system_parameters,
+        minimization_parameters,
+        start_time
+    };
+
+    // Create empty command queue
+    control::CommandQueue command_queue;
+
+    // Helper to evaluate the phase at a given potential energy per particle
+    auto evaluate_at = [&](int time_step, double potential_energy)
+    {
+        state.potential_energy = potential_energy * system_parameters.particle_count;
+        state | measurement;
+        minimization_phase.evaluate(command_queue, time_step, measurement);
+    };
+
+    WHEN("I evaluate the first time step")
+    {
+        evaluate_at(start_time + 1, -1.0);
+
+        THEN("The velocities are stashed and time advances")
+        {
+            REQUIRE(2 == command_queue.size());
+            REQUIRE(std::holds_alternative<control::StashVelocities>(command_queue.front()));
+            command_queue.pop();
+            REQUIRE(std::holds_alternative<control::AdvanceTime>(command_queue.front()));
+        }
+    }
+
+    GIVEN("The phase has already started")
+    {
+        evaluate_at(start_time + 1, -1.0);
+        command_queue = {};
+
+        WHEN("The potential energy decreases")
+        {
+            evaluate_at(start_time + 2, -1.5);
+
+            THEN("The velocities are steered toward the forces")
+            {
+                REQUIRE(2 == command_queue.size());
+                REQUIRE(std::holds_alternative<control::MixVelocities>(command_queue.front()));
+                REQUIRE(
+                    Approx(minimization_parameters.mixing)
+                        == std::get<control::MixVelocities>(command_queue.front()).mixing
+                );
+                command_queue.pop();
+                REQUIRE(std::holds_alternative<control::AdvanceTime>(command_queue.front()));
+            }
+        }
+
+        WHEN("The potential energy increases")
+        {
+            evaluate_at(start_time + 2, -0.5);
+
+            THEN("The particles are brought to rest")
+            {
+                REQUIRE(2 == command_queue.size());
+                REQUIRE(std::holds_alternative<control::ZeroVelocities>(command_queue.front()));
+                command_queue.pop();
+                REQUIRE(std::holds_alternative<control::AdvanceTime>(command_queue.front()));
+            }
+        }
+
+        WHEN("The potential energy keeps decreasing for longer than the delay")
+        {
+            double mixing = minimization_parameters.mixing;
+
+            for (int step : std::views::iota(0, minimization_parameters.delay + 2))
+            {
+                evaluate_at(start_time + 2 + step, -1.0 - 1.0 * (step + 1));
+                mixing = std::get<control::MixVelocities>(command_queue.front()).mixing;
+                command_queue = {};
+            }
+
+            THEN("The mixing parameter is reduced")
+            {
+                REQUIRE(mixing < minimization_parameters.mixing);
+            }
+        }
+
+        WHEN("The potential energy settles down")
+        {
+            for (int time_step : std::views::iota(
+                start_time + 2, start_time + minimization_parameters.check_interval
+            ))
+            {
+                evaluate_at(time_step, -1.0);
+                command_queue = {};
+            }
+
+            evaluate_at(start_time + minimization_parameters.check_interval, -1.0);
+
+            THEN("The velocities are restored and the phase completes")
+            {
+                REQUIRE(3 == command_queue.size());
+                REQUIRE(std::holds_alternative<control::MixVelocities>(command_queue.front()));
+                command_queue.pop();
+                REQUIRE(std::holds_alternative<control::RestoreVelocities>(command_queue.front()));
+                command_queue.pop();
+                REQUIRE(std::holds_alternative<control::PhaseComplete>(command_queue.front()));
+            }
+        }
+
+        WHEN("The potential energy never settles down")
+        {
+            for (int time_step : std::views::iota(
+                start_time + 2, start_time + minimization_parameters.timeout
+            ))
+            {
+                evaluate_at(time_step, -1.0 * time_step);
+                command_queue = {};
+            }
+
+            evaluate_at(
+                start_time + minimization_parameters.timeout,
+                -1.0 * (start_time + minimization_parameters.timeout)
+            );
+
+            THEN("The phase still completes at the timeout")
+            {
+                REQUIRE(3 == command_queue.size());
+                REQUIRE(std::holds_alternative<control::MixVelocities>(command_queue.front()));
+                command_queue.pop();
+                REQUIRE(std::holds_alternative<control::RestoreVelocities>(command_queue.front()));
+                command_queue.pop();
+                REQUIRE(std::holds_alternative<control::PhaseComplete>(command_queue.front()));
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * Test the Progress record written by the SimulationController
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/control/progress.hpp>
+
+SCENARIO("Recording the progress of a run")
+{
+    control::Progress progress;
+    progress.set_expected_time_steps(1000);
+
+    WHEN("The run has not started")
+    {
+        auto report = progress.report();
+
+        THEN("It is not running, and there is no estimate")
+        {
+            REQUIRE_FALSE(report.running);
+            REQUIRE(report.expected_time_steps == 1000);
+            REQUIRE(report.eta_seconds < 0.0);
+        }
+    }
+
+    WHEN("The run has advanced some way from where it started")
+    {
+        progress.start(100, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        progress.update(400, 1);
+
+        auto report = progress.report();
+
+        THEN("The throughput and the ETA are estimated from the time steps since the start")
+        {
+            REQUIRE(report.running);
+            REQUIRE(report.time_step == 400);
+            REQUIRE(report.phases_completed == 1);
+            REQUIRE(report.elapsed_seconds >= 0.02);
+            REQUIRE(report.steps_per_second == Approx(300 / report.elapsed_seconds));
+            REQUIRE(report.eta_seconds == Approx(600 / report.steps_per_second));
+        }
+
+        AND_WHEN("The run finishes")
+        {
+            progress.update(1000, 2);
+            progress.finish();
+
+            THEN("It is no longer running")
+            {
+                auto final_report = progress.report();
+
+                REQUIRE_FALSE(final_report.running);
+                REQUIRE(final_report.time_step == 1000);
+            }
+        }
+    }
+}
@@ -5,6 +5,8 @@
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <string>
+#include <vector>
 #include <utility>
 #include <memory>
 
@@ -119,6 +121,90 @@ SCENARIO("SimulationController correctly interprets commands")
         }
     }
 
+    GIVEN("A run whose phases log every other time step, and blocks of two time steps")
+    {
+        std::ostringstream event_log, observation_log, snapshot_log;
+
+        fs::path thermodynamic_log_path = test_dir / "thermodynamics.csv";
+        std::ofstream thermodynamic_log{thermodynamic_log_path};
+
+        output::Logger logger{{
+            .event_log = event_log,
+            .thermodynamic_log = thermodynamic_log,
+            .observation_log = observation_log,
+            .snapshot_log = snapshot_log,
+            .thermodynamic_log_aggregated = true
+        }};
+
+        control::SimulationController::Schedule schedule;
+        schedule.push(std::make_unique<mock::SuccessPhase>(
+            "SuccessPhase", control::ThermodynamicLogPolicy{.interval = 2}
+        ));
+        schedule.push(std::make_unique<mock::FailurePhase>(
+            "FailurePhase", control::ThermodynamicLogPolicy{.interval = 2, .aggregate = true}
+        ));
+
+        auto integrator = builder.bounding_box(initial_condition.bounding_box()).build();
+        control::SimulationController simulation(std::move(integrator), std::move(schedule), logger);
+
+        physics::SystemState state = initial_condition.system_state();
+        state | simulation;
+
+        logger.close();
+        thermodynamic_log.close();
+
+        WHEN("I read the thermodynamic log back in")
+        {
+            std::ifstream fin{thermodynamic_log_path};
+            std::string line;
+
+            std::getline(fin, line);
+            bool aggregated_header = line.starts_with(
+                "TimeStep,Samples,Time,TimeMin,TimeMax,TimeVariance,KineticEnergy,"
+            );
+
+            std::vector<std::pair<int, int>> rows;  // (time step, samples)
+            std::vector<double> time_variances;
+
+            while (std::getline(fin, line))
+            {
+                std::istringstream row{line};
+                std::string time_step, samples, time, time_min, time_max, time_variance;
+
+                std::getline(row, time_step, ',');
+                std::getline(row, samples, ',');
+                std::getline(row, time, ',');
+                std::getline(row, time_min, ',');
+                std::getline(row, time_max, ',');
+                std::getline(row, time_variance, ',');
+
+                rows.emplace_back(std::stoi(time_step), std::stoi(samples));
+                time_variances.push_back(std::stod(time_variance));
+            }
+
+            THEN("The first phase is decimated, and the second is aggregated in blocks")
+            {
+                REQUIRE(aggregated_header);
+
+                std::vector<std::pair<int, int>> expected{
+                    {0, 1}, {2, 1}, {4, 1},     // Every other time step of the SuccessPhase
+                    {6, 2}, {8, 2},             // Blocks of two in the FailurePhase...
+                    {9, 1}                      // ...and the partial block before it aborts
+                };
+
+                REQUIRE(rows == expected);
+
+                // The times within a block of two are one time_delta apart
+                double block_variance = time_delta * time_delta / 2;
+
+                REQUIRE(time_variances[0] == 0.0);
+                REQUIRE(time_variances[3] == Approx(block_variance));
+                REQUIRE(time_variances[4] == Approx(block_variance));
+                REQUIRE(time_variances[5] == 0.0);
+            }
+        }
+    }
+
     // Clean up
     fs::remove_all(test_dir);
 }
@@ -2,6 +2,7 @@
  * Test the InitialCondition class
  */
 
+#include <cmath>
 #include <random>
 
 #include <catch2/catch.hpp>
@@ -56,3 +57,99 @@ SCENARIO("Creating initial conditions with specified properties")
         }
     }
 }
+
+SCENARIO("Warm-starting from the state of a nearby simulation")
+{
+    tools::SystemParameters previous_parameters{
+        .temperature{0.5},
+        .density{0.8},
+        .particle_count{108}
+    };
+
+    engine::InitialCondition previous{previous_parameters, 17};
+    physics::SystemState previous_state = previous.system_state();
+
+    WHEN("I change the temperature and density")
+    {
+        tools::SystemParameters system_parameters{
+            .temperature{0.9},
+            .density{0.6},
+            .particle_count{108}
+        };
+
+        engine::InitialCondition initial_condition{
+            system_parameters, previous_state, previous_parameters
+        };
+
+        physics::SystemState system_state = initial_condition.system_state();
+
+        THEN("The box and temperature match the new parameters")
+        {
+            REQUIRE(Approx(system_parameters.density) ==
+                static_cast<double>(system_parameters.particle_count)
+                    / initial_condition.bounding_box().volume()
+            );
+
+            REQUIRE(Approx(system_parameters.temperature) == physics::temperature(system_state));
+        }
+
+        THEN("The positions are rescaled with the box")
+        {
+            double scale = std::cbrt(previous_parameters.density / system_parameters.density);
+            REQUIRE(system_state.positions.isApprox(previous_state.positions * scale));
+        }
+
+        THEN("The total momentum is still zero")
+        {
+            REQUIRE(Approx(1.0) == 1.0 + physics::total_momentum(system_state).squaredNorm());
+        }
+    }
+
+    WHEN("I change only the temperature")
+    {
+        tools::SystemParameters system_parameters = previous_parameters;
+        system_parameters.temperature = 0.3;
+
+        previous_state.time = 12.5;
+        previous_state.displacements.setOnes();
+
+        engine::InitialCondition initial_condition{
+            system_parameters, previous_state, previous_parameters
+        };
+
+        physics::SystemState system_state = initial_condition.system_state();
+
+        THEN("The positions are unchanged and the clock and displacements are reset")
+        {
+            REQUIRE(system_state.positions == previous_state.positions);
+            REQUIRE(system_state.displacements.isZero());
+            REQUIRE(system_state.time == 0.0);
+            REQUIRE(Approx(system_parameters.temperature) == physics::temperature(system_state));
+        }
+    }
+}
+
+SCENARIO("Starting from given positions")
+{
+    tools::SystemParameters system_parameters{
+        .temperature{0.7},
+        .density{0.8},
+        .particle_count{108}
+    };
+
+    Eigen::Matrix4Xd positions = engine::InitialCondition{system_parameters, 3}
+        .system_state().positions;
+
+    WHEN("I create an initial condition from the positions")
+    {
+        engine::InitialCondition initial_condition{system_parameters, positions, 5};
+        physics::SystemState system_state = initial_condition.system_state();
+
+        THEN("The positions are kept, and the velocities are chosen at the temperature")
+        {
+            REQUIRE(system_state.positions == positions);
+            REQUIRE(Approx(system_parameters.temperature) == physics::temperature(system_state));
+            REQUIRE(Approx(1.0) == 1.0 + physics::total_momentum(system_state).squaredNorm());
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * Test the AsyncFileSink, with each of its ways of writing
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <src/cpp/lennardjonesium/output/async_file.hpp>
+
+namespace
+{
+    std::string read_file(const std::filesystem::path& path)
+    {
+        std::ifstream fin{path, std::ios::binary};
+        std::ostringstream contents;
+        contents << fin.rdbuf();
+        return contents.str();
+    }
+}
+
+SCENARIO("Writing files with the AsyncFileSink")
+{
+    namespace fs = std::filesystem;
+
+    fs::path test_dir{"test_async_file"};
+    fs::create_directory(test_dir);
+    fs::path path = test_dir / "output.txt";
+
+    // Small buffers, so that many writes are in flight
+    auto use_io_uring = GENERATE(true, false);
+    auto direct = GENERATE(false, true);
+
+    output::AsyncFileOptions options{
+        .buffer_size = 4096,
+        .buffer_count = 3,
+        .direct = direct,
+        .use_io_uring = use_io_uring
+    };
+
+    // Text which does not line up with the block size
+    std::string expected;
+    for (int i = 0; i < 5000; ++i) {expected += std::to_string(i) + ",";}
+
+    GIVEN("A stream writing through an AsyncFileSink")
+    {
+        output::AsyncFileSink sink{path, std::ios::out, options};
+        REQUIRE(sink.is_open());
+
+        boost::iostreams::stream<output::AsyncFileSink> destination{sink};
+
+        WHEN("I write some text and flush it")
+        {
+            destination << expected.substr(0, 10000);
+            destination.flush();
+
+            THEN("The file has exactly that text, even before it is closed")
+            {
+                REQUIRE(fs::file_size(path) == 10000);
+                REQUIRE(read_file(path) == expected.substr(0, 10000));
+            }
+
+            AND_WHEN("I write the rest and close the stream")
+            {
+                destination << expected.substr(10000);
+                destination.close();
+
+                THEN("The file has all of the text")
+                {
+                    REQUIRE(destination.good());
+                    REQUIRE(read_file(path) == expected);
+                }
+            }
+        }
+    }
+
+    GIVEN("A file which already has some text in it")
+    {
+        {
+            std::ofstream existing{path, std::ios::binary};
+            existing << expected.substr(0, 1234);
+        }
+
+        WHEN("I append the rest of the text")
+        {
+            {
+                boost::iostreams::stream<output::AsyncFileSink> destination{
+                    output::AsyncFileSink{path, std::ios::out | std::ios::app, options}
+                };
+
+                destination << expected.substr(1234);
+            }
+
+            THEN("The file has all of the text")
+            {
+                REQUIRE(read_file(path) == expected);
+            }
+        }
+    }
+
+    GIVEN("A file which cannot be opened")
+    {
+        output::AsyncFileSink sink{test_dir / "missing" / "output.txt", std::ios::out, options};
+
+        THEN("Writing to it fails")
+        {
+            boost::iostreams::stream<output::AsyncFileSink> destination{sink};
+            destination << expected;
+            destination.flush();
+
+            REQUIRE(!sink.is_open());
+            REQUIRE(!destination.good());
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
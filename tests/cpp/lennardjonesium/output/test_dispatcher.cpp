@@ -13,6 +13,7 @@
 #include <src/cpp/lennardjonesium/physics/observation.hpp>
 #include <src/cpp/lennardjonesium/output/log_message.hpp>
 #include <src/cpp/lennardjonesium/output/sinks.hpp>
+#include <src/cpp/lennardjonesium/output/checkpoint.hpp>
 #include <src/cpp/lennardjonesium/output/dispatcher.hpp>
 
 SCENARIO("Dispatcher sends to correct files")
@@ -189,3 +190,66 @@ SCENARIO("Dispatcher sends to correct files")
     // Clean up
     fs::remove_all(test_dir);
 }
+
+SCENARIO("Dispatcher reports checkpoints which cannot be written")
+{
+    namespace fs = std::filesystem;
+
+    fs::path test_dir{"test_dispatcher_checkpoint"};
+    fs::create_directory(test_dir);
+
+    std::ostringstream event_log, thermodynamic_log, observation_log, snapshot_log;
+    output::EventSink event_sink{event_log};
+    output::ThermodynamicSink thermodynamic_sink{thermodynamic_log};
+    output::ObservationSink observation_sink{observation_log};
+    output::SystemSnapshotSink snapshot_sink{snapshot_log};
+
+    GIVEN("A checkpoint in a directory which exists")
+    {
+        fs::path checkpoint_path = test_dir / "simulation.checkpoint";
+        output::CheckpointSink checkpoint_sink{checkpoint_path, {}, "prelude"};
+
+        output::Dispatcher dispatcher{
+            event_sink, thermodynamic_sink, observation_sink, snapshot_sink, &checkpoint_sink
+        };
+
+        WHEN("I send a checkpoint")
+        {
+            dispatcher.send(5, output::CheckpointData{"payload"});
+
+            THEN("It is written, and no failure is reported")
+            {
+                auto checkpoint = output::read_checkpoint(checkpoint_path);
+
+                REQUIRE(checkpoint);
+                REQUIRE(checkpoint->time_step == 5);
+                REQUIRE(checkpoint->payload == "payload");
+                REQUIRE(!fs::exists(test_dir / "simulation.checkpoint.tmp"));
+                REQUIRE(event_log.view().empty());
+            }
+        }
+    }
+
+    GIVEN("A checkpoint in a directory which does not exist")
+    {
+        output::CheckpointSink checkpoint_sink{
+            test_dir / "missing" / "simulation.checkpoint", {}, "prelude"
+        };
+
+        output::Dispatcher dispatcher{
+            event_sink, thermodynamic_sink, observation_sink, snapshot_sink, &checkpoint_sink
+        };
+
+        WHEN("I send a checkpoint")
+        {
+            dispatcher.send(5, output::CheckpointData{"payload"});
+
+            THEN("The failure is recorded in the event log")
+            {
+                REQUIRE(event_log.view().starts_with("5: Checkpoint failed: "));
+            }
+        }
+    }
+
+    fs::remove_all(test_dir);
+}
@@ -6,6 +6,8 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <catch2/catch.hpp>
 #include <Eigen/Dense>
@@ -14,6 +16,7 @@
 #include <src/cpp/lennardjonesium/physics/observation.hpp>
 #include <src/cpp/lennardjonesium/output/log_message.hpp>
 #include <src/cpp/lennardjonesium/output/logger.hpp>
+#include <src/cpp/lennardjonesium/output/io_service.hpp>
 
 SCENARIO("Size of a LogMessage")
 {
@@ -195,3 +198,160 @@ SCENARIO("Logger sends to correct files")
     // Clean up
     fs::remove_all(test_dir);
 }
+
+SCENARIO("Loggers sharing an IOService")
+{
+    int logger_count = 5;
+    int message_count = 3000;
+
+    // More messages than fit in the buffer, so that the producers must wait for the IOService
+    REQUIRE(static_cast<std::size_t>(message_count) > output::Logger::buffer_capacity);
+
+    std::vector<std::ostringstream> event_logs(logger_count);
+    std::vector<std::ostringstream> thermodynamic_logs(logger_count);
+    std::vector<std::ostringstream> observation_logs(logger_count);
+    std::vector<std::ostringstream> snapshot_logs(logger_count);
+
+    GIVEN("Several Loggers attached to an IOService with two threads")
+    {
+        output::IOService io_service{2};
+
+        REQUIRE(io_service.thread_count() == 2);
+
+        WHEN("Each Logger is sent messages from its own thread")
+        {
+            {
+                std::vector<std::jthread> producers;
+
+                for (int i = 0; i < logger_count; ++i)
+                {
+                    producers.emplace_back(
+                        [&, i]()
+                        {
+                            output::Logger logger{
+                                output::Logger::Streams{
+                                    .event_log = event_logs[i],
+                                    .thermodynamic_log = thermodynamic_logs[i],
+                                    .observation_log = observation_logs[i],
+                                    .snapshot_log = snapshot_logs[i]
+                                },
+                                std::nullopt,
+                                false,
+                                std::nullopt,
+                                &io_service
+                            };
+
+                            for (int time_step = 0; time_step < message_count; ++time_step)
+                            {
+                                logger.log(time_step, output::ThermodynamicData{
+                                    physics::ThermodynamicMeasurement::Result{
+                                        .time = 0.5 * time_step
+                                    }
+                                });
+                            }
+
+                            logger.log(message_count, output::PhaseCompleteEvent{"Test Phase"});
+                            logger.close();
+                        }
+                    );
+                }
+            }
+
+            THEN("Every log contains all of its messages, in order")
+            {
+                for (int i = 0; i < logger_count; ++i)
+                {
+                    std::istringstream contents{thermodynamic_logs[i].str()};
+                    std::string line;
+
+                    // Skip the header
+                    std::getline(contents, line);
+
+                    int time_step = 0;
+
+                    while (std::getline(contents, line))
+                    {
+                        REQUIRE(line.starts_with(std::to_string(time_step) + ","));
+                        ++time_step;
+                    }
+
+                    REQUIRE(time_step == message_count);
+                    REQUIRE(event_logs[i].str().find("Test Phase") != std::string::npos);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Logger backpressure policies")
+{
+    // More messages than fit in the buffer, so that the producer may outrun the consumer
+    constexpr int message_count = 4 * output::Logger::buffer_capacity;
+
+    auto policy = GENERATE(
+        tools::BackpressurePolicy::block,
+        tools::BackpressurePolicy::drop_oldest,
+        tools::BackpressurePolicy::spin
+    );
+
+    std::ostringstream event_log, thermodynamic_log, observation_log, snapshot_log;
+
+    GIVEN("A Logger with the given backpressure policy")
+    {
+        output::Logger logger{
+            output::Logger::Streams{
+                .event_log = event_log,
+                .thermodynamic_log = thermodynamic_log,
+                .observation_log = observation_log,
+                .snapshot_log = snapshot_log
+            },
+            std::nullopt,
+            false,
+            std::nullopt,
+            nullptr,
+            policy
+        };
+
+        REQUIRE(logger.backpressure() == policy);
+
+        WHEN("It is sent many messages at once")
+        {
+            for (int time_step = 0; time_step < message_count; ++time_step)
+            {
+                logger.log(time_step, output::ThermodynamicData{
+                    physics::ThermodynamicMeasurement::Result{.time = 0.5 * time_step}
+                });
+            }
+
+            logger.close();
+
+            THEN("Every message is either written in order, or counted as dropped")
+            {
+                std::istringstream contents{thermodynamic_log.str()};
+                std::string line;
+
+                // Skip the header
+                std::getline(contents, line);
+
+                int previous = -1;
+                int written = 0;
+
+                while (std::getline(contents, line))
+                {
+                    int time_step = std::stoi(line.substr(0, line.find(',')));
+
+                    REQUIRE(time_step > previous);
+                    previous = time_step;
+                    ++written;
+                }
+
+                REQUIRE(written + logger.dropped_messages() == message_count);
+
+                if (policy != tools::BackpressurePolicy::drop_oldest)
+                {
+                    REQUIRE(logger.dropped_messages() == 0);
+                }
+            }
+        }
+    }
+}
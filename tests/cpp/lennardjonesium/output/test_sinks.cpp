@@ -2,9 +2,12 @@
  * Test functionality of different Sinks.
  */
 
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <string>
 
 #include <catch2/catch.hpp>
 #include <Eigen/Dense>
@@ -37,9 +40,21 @@ SCENARIO("Testing Sink concept")
         ObservationData
     >;
 
+    constexpr bool binary_thermodynamic_sink_check = Sink<
+        BinaryThermodynamicSink,
+        ThermodynamicData
+    >;
+
+    constexpr bool binary_observation_sink_check = Sink<
+        BinaryObservationSink,
+        ObservationData
+    >;
+
     REQUIRE(event_sink_check);
     REQUIRE(thermodynamic_sink_check);
     REQUIRE(observation_sink_check);
+    REQUIRE(binary_thermodynamic_sink_check);
+    REQUIRE(binary_observation_sink_check);
 }
 
 SCENARIO("Sinks write correct output to files")
@@ -116,6 +131,7 @@ SCENARIO("Sinks write correct output to files")
 
         thermodynamic_sink.write_header();
         thermodynamic_sink.write(7, output::ThermodynamicData{thermodynamic_result});
+        thermodynamic_sink.flush();
 
         thermodynamic_log.close();
 
@@ -155,6 +171,7 @@ SCENARIO("Sinks write correct output to files")
 
         observation_sink.write_header();
         observation_sink.write(3, output::ObservationData{observation});
+        observation_sink.flush();
 
         observation_log.close();
 
@@ -177,6 +194,77 @@ SCENARIO("Sinks write correct output to files")
         }
     }
 
+    GIVEN("A BinaryThermodynamicSink has written a file")
+    {
+        fs::path thermodynamic_log_path = test_dir / "thermodynamics.bin";
+        std::ofstream thermodynamic_log{thermodynamic_log_path, std::ios::binary};
+        output::BinaryThermodynamicSink thermodynamic_sink{thermodynamic_log};
+
+        physics::ThermodynamicMeasurement::Result thermodynamic_result{
+            .time = 3.5,
+            .kinetic_energy = 2.25,
+            .potential_energy = 4.25,
+            .total_energy = 6.5,
+            .virial = 5.5,
+            .temperature = 0.5,
+            .mean_square_displacement = 7.25
+        };
+
+        thermodynamic_sink.write_header();
+        thermodynamic_sink.write(7, output::ThermodynamicData{thermodynamic_result});
+        thermodynamic_sink.write(8, output::ThermodynamicData{thermodynamic_result});
+        thermodynamic_sink.flush();
+
+        thermodynamic_log.close();
+
+        WHEN("I read the file back in")
+        {
+            std::ifstream fin{thermodynamic_log_path, std::ios::binary};
+            std::ostringstream contents;
+
+            contents << fin.rdbuf();
+            std::string bytes = contents.str();
+
+            auto read_u64 = [&bytes](std::size_t offset)
+            {
+                std::uint64_t value;
+                std::memcpy(&value, bytes.data() + offset, sizeof(value));
+                return value;
+            };
+
+            auto data_offset = read_u64(8);
+
+            THEN("The header describes the columns")
+            {
+                std::string description =
+                    "TimeStep:<i8\nTime:<f8\nKineticEnergy:<f8\nPotentialEnergy:<f8\n"
+                    "TotalEnergy:<f8\nVirial:<f8\nTemperature:<f8\nMeanSquareDisplacement:<f8\n";
+
+                REQUIRE(bytes.substr(0, 8) == "LJCOLS01");
+                REQUIRE(data_offset % 64 == 0);
+                REQUIRE(read_u64(16) == 64);
+                REQUIRE(read_u64(24) == 8);
+                REQUIRE(bytes.substr(32, description.size()) == description);
+            }
+
+            THEN("The records follow the header")
+            {
+                REQUIRE(bytes.size() == data_offset + 2 * 64);
+
+                std::int64_t time_step;
+                double values[7];
+
+                std::memcpy(&time_step, bytes.data() + data_offset + 64, sizeof(time_step));
+                std::memcpy(values, bytes.data() + data_offset + 64 + 8, sizeof(values));
+
+                REQUIRE(time_step == 8);
+                REQUIRE(values[0] == 3.5);
+                REQUIRE(values[3] == 6.5);
+                REQUIRE(values[6] == 7.25);
+            }
+        }
+    }
+
     GIVEN("A SystemSnapshotSink has written a file")
     {
         fs::path snapshot_log_path = test_dir / "snapshots.csv";
@@ -199,6 +287,7 @@ SCENARIO("Sinks write correct output to files")
 
         snapshot_sink.write_header();
         snapshot_sink.write(9, snapshot);
+        snapshot_sink.flush();
 
         snapshot_log.close();
 
@@ -0,0 +1,272 @@
+/**
+ * Test writing and reading trajectory files.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <Eigen/Dense>
+
+#include <src/cpp/lennardjonesium/tools/bounding_box.hpp>
+#include <src/cpp/lennardjonesium/output/log_message.hpp>
+#include <src/cpp/lennardjonesium/output/trajectory_codec.hpp>
+#include <src/cpp/lennardjonesium/output/trajectory.hpp>
+
+SCENARIO("Writing and reading trajectory files")
+{
+    namespace fs = std::filesystem;
+
+    fs::path test_dir{"test_trajectory"};
+    fs::create_directory(test_dir);
+
+    fs::path trajectory_path = test_dir / "trajectory.bin";
+
+    int particle_count = 3;
+
+    auto make_frame = [particle_count](double t)
+    {
+        output::TrajectoryFrame frame{
+            .time = t,
+            .positions = Eigen::Matrix4Xd::Zero(4, particle_count),
+            .velocities = Eigen::Matrix4Xd::Zero(4, particle_count)
+        };
+
+        frame.positions.topRows(3).setConstant(t);
+        frame.positions(0, 1) = 0.1;
+        frame.velocities.topRows(3).setConstant(-t);
+
+        return frame;
+    };
+
+    auto write_frames = [&](output::TrajectoryFormat format, bool with_index)
+    {
+        std::ofstream destination{trajectory_path, std::ios::binary};
+        output::TrajectorySink sink{destination, particle_count, format};
+
+        sink.write_header();
+        for (int i = 0; i < 3; ++i) {sink.write(100 * i, make_frame(0.5 * i));}
+        if (with_index) {sink.write_index();}
+    };
+
+    GIVEN("A double-precision trajectory with an index")
+    {
+        write_frames(output::TrajectoryFormat::float64, true);
+
+        output::TrajectoryReader reader{trajectory_path};
+
+        THEN("Every frame can be read back exactly")
+        {
+            REQUIRE(reader.good());
+            REQUIRE(reader.particle_count() == particle_count);
+            REQUIRE(reader.frame_count() == 3);
+
+            // Read out of order, to use the random access
+            auto frame = reader.frame(2);
+            REQUIRE(frame.time_step == 200);
+            REQUIRE(frame.frame.time == 1.0);
+            REQUIRE(frame.frame.positions == make_frame(1.0).positions);
+            REQUIRE(frame.frame.velocities == make_frame(1.0).velocities);
+
+            frame = reader.frame(0);
+            REQUIRE(frame.time_step == 0);
+            REQUIRE(frame.frame.positions == make_frame(0.0).positions);
+        }
+    }
+
+    GIVEN("A single-precision trajectory")
+    {
+        write_frames(output::TrajectoryFormat::float32, true);
+
+        output::TrajectoryReader reader{trajectory_path};
+
+        THEN("The frames are half the size, and read back to single precision")
+        {
+            REQUIRE(reader.format() == output::TrajectoryFormat::float32);
+            REQUIRE(reader.frame_count() == 3);
+
+            const auto& offsets = reader.index().frame_offsets;
+            REQUIRE(offsets[1] - offsets[0] == static_cast<std::uint64_t>(24 + 6 * particle_count * 4));
+
+            auto frame = reader.frame(1);
+            REQUIRE(frame.frame.positions.isApprox(make_frame(0.5).positions, 1.0e-7));
+            REQUIRE(frame.frame.positions(0, 1) != 0.1);
+            REQUIRE(frame.frame.positions(0, 1) == Approx(0.1).epsilon(1.0e-7));
+        }
+    }
+
+    GIVEN("A trajectory whose run was interrupted before the index was written")
+    {
+        write_frames(output::TrajectoryFormat::float64, false);
+
+        // Also cut the last frame short
+        auto full_size = fs::file_size(trajectory_path);
+        fs::resize_file(trajectory_path, full_size - 10);
+
+        auto index = output::read_trajectory_index(trajectory_path);
+
+        THEN("The complete frames are found by scanning")
+        {
+            REQUIRE(index.has_value());
+            REQUIRE(index->frame_offsets.size() == 2);
+            REQUIRE(index->end_offset == index->frame_offsets[1] + (full_size - 32) / 3);
+        }
+
+        WHEN("More frames are appended after the complete ones")
+        {
+            fs::resize_file(trajectory_path, index->end_offset);
+
+            {
+                std::ofstream destination{
+                    trajectory_path, std::ios::binary | std::ios::app
+                };
+
+                output::TrajectorySink sink{
+                    destination, particle_count, output::TrajectoryFormat::float64, index
+                };
+
+                sink.write(300, make_frame(1.5));
+                sink.write_index();
+            }
+
+            output::TrajectoryReader reader{trajectory_path};
+
+            THEN("The index covers all of the frames")
+            {
+                REQUIRE(reader.frame_count() == 3);
+                REQUIRE(reader.frame(1).time_step == 100);
+                REQUIRE(reader.frame(2).time_step == 300);
+                REQUIRE(reader.frame(2).frame.positions == make_frame(1.5).positions);
+            }
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
+
+SCENARIO("Writing and reading compressed trajectory files")
+{
+    namespace fs = std::filesystem;
+
+    fs::path test_dir{"test_compressed_trajectory"};
+    fs::create_directory(test_dir);
+
+    fs::path trajectory_path = test_dir / "trajectory.bin";
+
+    // A random walk of particles in a periodic box, with slowly changing velocities
+    int particle_count = 100;
+    int frame_count = 120;
+    double side_length = 5.0;
+
+    tools::BoundingBox bounding_box{side_length};
+
+    output::TrajectoryCompression compression{
+        .position_precision = 1.0e-3,
+        .velocity_precision = 1.0e-3,
+        .keyframe_interval = 50
+    };
+
+    std::mt19937_64 generator{42};
+    std::normal_distribution<double> step{0.0, 0.05};
+    std::uniform_real_distribution<double> uniform{0.0, side_length};
+
+    std::vector<output::TrajectoryFrame> frames;
+
+    output::TrajectoryFrame frame{
+        .time = 0.0,
+        .positions = Eigen::Matrix4Xd::Zero(4, particle_count),
+        .velocities = Eigen::Matrix4Xd::Zero(4, particle_count)
+    };
+
+    for (int i = 0; i < particle_count; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            frame.positions(k, i) = uniform(generator);
+            frame.velocities(k, i) = 10.0 * step(generator);
+        }
+    }
+
+    for (int f = 0; f < frame_count; ++f)
+    {
+        frame.time += 0.25;
+
+        for (int i = 0; i < particle_count; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                // Positions stay inside the box, as with the periodic boundary condition
+                frame.positions(k, i) = std::fmod(
+                    frame.positions(k, i) + step(generator) + side_length, side_length
+                );
+                frame.velocities(k, i) += step(generator);
+            }
+        }
+
+        frames.push_back(frame);
+    }
+
+    {
+        std::ofstream destination{trajectory_path, std::ios::binary};
+        output::TrajectorySink sink{destination, particle_count, bounding_box, compression};
+
+        sink.write_header();
+        for (int f = 0; f < frame_count; ++f) {sink.write(10 * f, frames[f]);}
+        sink.write_index();
+    }
+
+    // Largest error allowing for the periodic boundary (a coordinate near the side of the box may
+    // come back near 0, or the other way around)
+    auto position_error = [side_length](const Eigen::Matrix4Xd& a, const Eigen::Matrix4Xd& b)
+    {
+        Eigen::ArrayXXd difference = (a - b).topRows(3).array().abs();
+        return difference.min(side_length - difference).maxCoeff();
+    };
+
+    output::TrajectoryReader reader{trajectory_path};
+
+    THEN("The file is much smaller than the raw coordinates")
+    {
+        auto raw_size = static_cast<double>(frame_count) * 6 * particle_count * sizeof(double);
+        REQUIRE(raw_size / static_cast<double>(fs::file_size(trajectory_path)) > 5.0);
+    }
+
+    THEN("Every frame is read back within the requested precision")
+    {
+        REQUIRE(reader.good());
+        REQUIRE(reader.format() == output::TrajectoryFormat::compressed);
+        REQUIRE(reader.frame_count() == static_cast<std::size_t>(frame_count));
+
+        for (int f = 0; f < frame_count; ++f)
+        {
+            auto decoded = reader.frame(f);
+
+            REQUIRE(decoded.time_step == 10 * f);
+            REQUIRE(decoded.frame.time == frames[f].time);
+            REQUIRE(position_error(decoded.frame.positions, frames[f].positions) <= 0.5e-3);
+            REQUIRE(
+                (decoded.frame.velocities - frames[f].velocities).cwiseAbs().maxCoeff() <= 0.5e-3
+            );
+        }
+    }
+
+    THEN("Frames can be read out of order")
+    {
+        for (int f : {75, 10, 119, 50, 49})
+        {
+            auto decoded = reader.frame(f);
+
+            REQUIRE(decoded.time_step == 10 * f);
+            REQUIRE(position_error(decoded.frame.positions, frames[f].positions) <= 0.5e-3);
+        }
+    }
+
+    // Clean up
+    fs::remove_all(test_dir);
+}
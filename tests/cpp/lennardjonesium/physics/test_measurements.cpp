@@ -591,3 +591,56 @@ SCENARIO("Transformations of bulk properties on a larger random state")
         }
     }
 }
+
+SCENARIO("Velocity transformations used for energy minimization")
+{
+    int particle_count{2};
+
+    physics::SystemState state{particle_count};
+
+    state.velocities = Eigen::MatrixX4d{
+        {3, 0, 0, 0}, {0, 4, 0, 0}
+    }.transpose();
+
+    WHEN("I zero the velocities")
+    {
+        state | physics::zero_velocities();
+
+        THEN("Every particle is at rest")
+        {
+            REQUIRE(state.velocities.isZero());
+        }
+    }
+
+    WHEN("I fully mix the force direction into the velocities")
+    {
+        state.forces = Eigen::MatrixX4d{
+            {0, 0, 1, 0}, {0, 0, 0, 0}
+        }.transpose();
+
+        state | physics::mix_velocities_with_forces(1.0);
+
+        THEN("The velocities point along the forces with the same overall speed")
+        {
+            Eigen::Matrix4Xd expected = Eigen::MatrixX4d{
+                {0, 0, 5, 0}, {0, 0, 0, 0}
+            }.transpose();
+
+            REQUIRE(expected.isApprox(state.velocities));
+        }
+    }
+
+    WHEN("I mix with vanishing forces")
+    {
+        state.forces.setZero();
+
+        Eigen::Matrix4Xd old_velocities = state.velocities;
+
+        state | physics::mix_velocities_with_forces(0.5);
+
+        THEN("The velocities are unchanged")
+        {
+            REQUIRE(old_velocities == state.velocities);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * Test combining Observations from independent replicas.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/physics/observation.hpp>
+#include <src/cpp/lennardjonesium/physics/observation_statistics.hpp>
+
+SCENARIO("Combining Observations from independent replicas")
+{
+    auto observation = [](double temperature, double pressure)
+    {
+        return physics::Observation{
+            .temperature = temperature,
+            .density = 0.8,
+            .total_energy = -2.0 * temperature,
+            .pressure = pressure,
+            .specific_heat = 2.0,
+            .diffusion_coefficient = 0.1
+        };
+    };
+
+    WHEN("Three replicas are combined")
+    {
+        std::vector<physics::Observation> observations{
+            observation(1.0, 0.5), observation(2.0, 1.5), observation(3.0, 1.0)
+        };
+
+        auto statistics = physics::combine_observations(observations);
+
+        THEN("The means are correct")
+        {
+            REQUIRE(statistics.replica_count == 3);
+            REQUIRE(Approx(2.0) == statistics.mean.temperature);
+            REQUIRE(Approx(0.8) == statistics.mean.density);
+            REQUIRE(Approx(-4.0) == statistics.mean.total_energy);
+            REQUIRE(Approx(1.0) == statistics.mean.pressure);
+        }
+
+        THEN("The standard errors are those of the mean")
+        {
+            // The sample variances are 1 and 0.25 respectively, divided by 3 replicas
+            REQUIRE(Approx(std::sqrt(1.0 / 3.0)) == statistics.standard_error.temperature);
+            REQUIRE(Approx(std::sqrt(4.0 / 3.0)) == statistics.standard_error.total_energy);
+            REQUIRE(Approx(std::sqrt(0.25 / 3.0)) == statistics.standard_error.pressure);
+
+            // Quantities which agree between the replicas have no error
+            REQUIRE(statistics.standard_error.density == 0.0);
+            REQUIRE(statistics.standard_error.specific_heat == 0.0);
+        }
+    }
+
+    WHEN("A single replica is combined")
+    {
+        auto statistics = physics::combine_observations({observation(1.0, 0.5)});
+
+        THEN("The mean is the observation, and the error is zero")
+        {
+            REQUIRE(statistics.replica_count == 1);
+            REQUIRE(statistics.mean.temperature == 1.0);
+            REQUIRE(statistics.standard_error.temperature == 0.0);
+            REQUIRE(statistics.standard_error.pressure == 0.0);
+        }
+    }
+}
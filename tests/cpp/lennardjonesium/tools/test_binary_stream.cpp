@@ -0,0 +1,94 @@
+/**
+ * Test BinaryWriter and BinaryReader
+ */
+
+#include <sstream>
+#include <string>
+
+#include <catch2/catch.hpp>
+#include <Eigen/Dense>
+
+#include <src/cpp/lennardjonesium/tools/binary_stream.hpp>
+#include <src/cpp/lennardjonesium/tools/moving_sample.hpp>
+
+SCENARIO("Writing and reading values in binary form")
+{
+    std::stringstream stream;
+    tools::BinaryWriter writer{stream};
+    tools::BinaryReader reader{stream};
+
+    GIVEN("Some numbers, a string, and a matrix")
+    {
+        int number = -17;
+        double real = 0.1;
+        std::string text = "Lennard-Jonesium";
+        Eigen::Matrix4Xd matrix = Eigen::Matrix4Xd::Random(4, 7);
+
+        WHEN("I write them and read them back")
+        {
+            writer << number << real << text << matrix;
+
+            int number_read{};
+            double real_read{};
+            std::string text_read;
+            Eigen::Matrix4Xd matrix_read;
+
+            reader >> number_read >> real_read >> text_read >> matrix_read;
+
+            THEN("I get exactly the same values")
+            {
+                REQUIRE(reader.good());
+                REQUIRE(number == number_read);
+                REQUIRE(real == real_read);
+                REQUIRE(text == text_read);
+                REQUIRE(matrix == matrix_read);
+            }
+        }
+
+        WHEN("I read a dynamic matrix into a matrix of the wrong shape")
+        {
+            Eigen::MatrixXd wrong = Eigen::MatrixXd::Zero(3, 5);
+            writer << wrong;
+
+            THEN("The reader reports an error")
+            {
+                reader >> matrix;
+                REQUIRE(!reader.good());
+            }
+        }
+
+        WHEN("I read past the end of the data")
+        {
+            writer << number;
+
+            THEN("The reader reports an error")
+            {
+                reader >> real;
+                REQUIRE(!reader.good());
+            }
+        }
+    }
+
+    GIVEN("A MovingSample that has wrapped around")
+    {
+        tools::MovingSample<double> sample(3);
+        for (double x : {1.0, 2.0, 3.0, 4.0, 5.0}) {sample.push_back(x);}
+
+        WHEN("I save it and restore it into a new MovingSample")
+        {
+            sample.save(writer);
+
+            tools::MovingSample<double> restored(3);
+            restored.push_back(100.0);
+            restored.restore(reader);
+
+            THEN("The restored sample has the same contents and statistics")
+            {
+                REQUIRE(reader.good());
+                REQUIRE(restored.size() == sample.size());
+                REQUIRE(restored.statistics().mean == sample.statistics().mean);
+                REQUIRE(restored.statistics().variance == sample.statistics().variance);
+            }
+        }
+    }
+}
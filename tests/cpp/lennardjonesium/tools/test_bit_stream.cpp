@@ -0,0 +1,82 @@
+/**
+ * Test BitWriter and BitReader
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/tools/bit_stream.hpp>
+
+SCENARIO("Writing and reading bits and Rice codes")
+{
+    GIVEN("Fields of various widths")
+    {
+        tools::BitWriter writer;
+        writer.write(0b101, 3);
+        writer.write(0xABCD, 16);
+        writer.write(0x0123456789ABCDEF, 64);
+        writer.write(1, 1);
+
+        auto bytes = writer.finish();
+
+        THEN("They are packed into the fewest bytes, least significant bit first")
+        {
+            REQUIRE(bytes.size() == (3 + 16 + 64 + 1 + 7) / 8);
+            REQUIRE((bytes[0] & 0b111) == 0b101);
+        }
+
+        THEN("They are read back unchanged")
+        {
+            tools::BitReader reader{bytes.data(), bytes.size()};
+
+            REQUIRE(reader.read(3) == 0b101);
+            REQUIRE(reader.read(16) == 0xABCD);
+            REQUIRE(reader.read(64) == 0x0123456789ABCDEF);
+            REQUIRE(reader.read(1) == 1);
+        }
+    }
+
+    GIVEN("Signed values, including some too large for their Rice parameter")
+    {
+        std::vector<std::int64_t> values{0, -1, 1, -2, 7, -100, 12345678, INT64_MIN, INT64_MAX};
+
+        THEN("Zigzag mapping interleaves signs, and is reversible")
+        {
+            REQUIRE(tools::zigzag(0) == 0);
+            REQUIRE(tools::zigzag(-1) == 1);
+            REQUIRE(tools::zigzag(1) == 2);
+            REQUIRE(tools::zigzag(-2) == 3);
+
+            for (auto value : values) {REQUIRE(tools::unzigzag(tools::zigzag(value)) == value);}
+        }
+
+        WHEN("I Rice code them and read them back")
+        {
+            int k = 2;
+
+            tools::BitWriter writer;
+            std::uint64_t expected_length = 0;
+
+            for (auto value : values)
+            {
+                writer.write_rice(tools::zigzag(value), k);
+                expected_length += tools::rice_length(tools::zigzag(value), k);
+            }
+
+            auto bytes = writer.finish();
+            tools::BitReader reader{bytes.data(), bytes.size()};
+
+            THEN("The code has the expected length, and the values are unchanged")
+            {
+                REQUIRE(bytes.size() == (expected_length + 7) / 8);
+
+                for (auto value : values)
+                {
+                    REQUIRE(tools::unzigzag(reader.read_rice(k)) == value);
+                }
+            }
+        }
+    }
+}
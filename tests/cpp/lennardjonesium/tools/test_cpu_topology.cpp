@@ -0,0 +1,58 @@
+/**
+ * Test the CpuTopology used to place threads near their memory.
+ */
+
+#include <vector>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/tools/cpu_topology.hpp>
+
+SCENARIO("Describing the CPUs of a machine")
+{
+    WHEN("I parse a Linux CPU list")
+    {
+        auto cpus = tools::parse_cpu_list("0-3,8,10-11\n");
+
+        THEN("I get every CPU in the ranges")
+        {
+            REQUIRE(cpus == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+        }
+    }
+
+    GIVEN("A topology with two nodes of different sizes")
+    {
+        tools::CpuTopology topology{{{0, 1, 2}, {}, {4, 5}}};
+
+        THEN("Empty nodes are left out")
+        {
+            REQUIRE(topology.node_count() == 2);
+            REQUIRE(topology.cpu_count() == 5);
+            REQUIRE(topology.node(1) == std::vector<int>{4, 5});
+        }
+
+        THEN("The spread order alternates between the nodes")
+        {
+            REQUIRE(topology.spread_order() == std::vector<int>{0, 4, 1, 5, 2});
+        }
+    }
+
+    WHEN("I detect the topology of this machine")
+    {
+        auto topology = tools::CpuTopology::detect();
+
+        THEN("There is at least one CPU, and a thread can be pinned to the first node")
+        {
+            REQUIRE(topology.cpu_count() > 0);
+
+            bool pinned = false;
+            std::jthread thread{[&]() {pinned = tools::pin_this_thread(topology.node(0));}};
+            thread.join();
+
+#ifdef __linux__
+            REQUIRE(pinned);
+#endif
+        }
+    }
+}
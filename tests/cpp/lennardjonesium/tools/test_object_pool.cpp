@@ -0,0 +1,56 @@
+/**
+ * Test the ObjectPool used to recycle log messages.
+ */
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/tools/object_pool.hpp>
+
+SCENARIO("Recycling objects through an ObjectPool")
+{
+    tools::ObjectPool<std::vector<double>> pool{2};
+
+    WHEN("I acquire an object from an empty pool")
+    {
+        auto object = pool.acquire();
+
+        THEN("It is default-constructed")
+        {
+            REQUIRE(object.empty());
+        }
+    }
+
+    WHEN("I recycle an object and acquire it again")
+    {
+        auto object = pool.acquire();
+        object.assign(100, 1.0);
+        auto data = object.data();
+
+        pool.recycle(std::move(object));
+        auto recycled = pool.acquire();
+
+        THEN("Its storage is reused")
+        {
+            REQUIRE(recycled.data() == data);
+            REQUIRE(recycled.size() == 100);
+        }
+    }
+
+    WHEN("I recycle more objects than the pool holds")
+    {
+        for (int i = 1; i <= 3; ++i) {pool.recycle(std::vector<double>(i));}
+
+        auto first = pool.acquire();
+        auto second = pool.acquire();
+        auto third = pool.acquire();
+
+        THEN("The oldest ones are discarded")
+        {
+            REQUIRE(first.size() == 2);
+            REQUIRE(second.size() == 3);
+            REQUIRE(third.empty());
+        }
+    }
+}
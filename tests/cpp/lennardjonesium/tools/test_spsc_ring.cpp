@@ -0,0 +1,122 @@
+/**
+ * Test the lock-free SpscRing.
+ */
+
+#include <thread>
+#include <optional>
+#include <vector>
+#include <numeric>
+
+#include <catch2/catch.hpp>
+
+#include <src/cpp/lennardjonesium/tools/spsc_ring.hpp>
+
+SCENARIO("SPSC ring in single-threaded environment")
+{
+    GIVEN("A ring with room for 4 messages")
+    {
+        tools::SpscRing<int> ring{3};
+
+        THEN("The capacity is rounded up to a power of 2")
+        {
+            REQUIRE(ring.capacity() == 4);
+        }
+
+        WHEN("I put some values and close the ring")
+        {
+            ring.put(1);
+            ring.put(2);
+            ring.put(3);
+            ring.close();
+            ring.put(4);
+
+            THEN("I read back the values put before close(), then std::nullopt")
+            {
+                REQUIRE(1 == ring.get());
+                REQUIRE(2 == ring.get());
+                REQUIRE(3 == ring.get());
+                REQUIRE(std::nullopt == ring.get());
+            }
+        }
+
+        WHEN("I drain the ring")
+        {
+            ring.put(1);
+            ring.put(2);
+            ring.put(3);
+
+            std::vector<int> output;
+            auto collect = [&output](int value) {output.push_back(value);};
+
+            auto first = ring.drain(collect, 2);
+            auto second = ring.drain(collect);
+            ring.close();
+            auto third = ring.drain(collect);
+
+            THEN("The messages are delivered in batches")
+            {
+                REQUIRE(first == 2);
+                REQUIRE(second == 1);
+                REQUIRE(third == 0);
+                REQUIRE(output == std::vector<int>{1, 2, 3});
+            }
+        }
+    }
+
+    GIVEN("A ring that drops the oldest message when full")
+    {
+        tools::SpscRing<int> ring{4, tools::BackpressurePolicy::drop_oldest};
+
+        WHEN("I put more messages than fit")
+        {
+            for (int i = 0; i < 7; ++i) {ring.put(i);}
+            ring.close();
+
+            std::vector<int> output;
+            while (auto o = ring.get()) {output.push_back(o.value());}
+
+            THEN("Only the newest messages remain")
+            {
+                REQUIRE(ring.dropped() == 3);
+                REQUIRE(output == std::vector<int>{3, 4, 5, 6});
+            }
+        }
+    }
+}
+
+SCENARIO("SPSC ring with producer and consumer threads")
+{
+    // Use a small ring so that the producer frequently finds it full
+    auto policy = GENERATE(tools::BackpressurePolicy::block, tools::BackpressurePolicy::spin);
+    tools::SpscRing<int> ring{8, policy};
+
+    std::vector<int> input(10000);
+    std::iota(input.begin(), input.end(), 0);
+    std::vector<int> output;
+
+    WHEN("I create producer and consumer threads and join them")
+    {
+        std::thread producer(
+            [&ring, &input]()
+            {
+                for (auto i : input) {ring.put(i);}
+            }
+        );
+
+        std::thread consumer(
+            [&ring, &output]()
+            {
+                while (ring.drain([&output](int value) {output.push_back(value);}));
+            }
+        );
+
+        producer.join();
+        ring.close();
+        consumer.join();
+
+        THEN("The output vector now has the same contents as the input")
+        {
+            REQUIRE(input == output);
+        }
+    }
+}
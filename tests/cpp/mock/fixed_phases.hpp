@@ -35,7 +35,8 @@ namespace mock
     /**
      * We define some "fixed" SimulationPhases which ignore their input and just emit a fixed
      * sequence of Commands.  This allows us to predict exactly what the output will be to the
-     * various log files, so that we can test the Simulation properly.
+     * various log files, so that we can test the Simulation properly.  They can be given a
+     * ThermodynamicLogPolicy, for testing how the measurements are logged.
      */
 
     class SuccessPhase : public control::SimulationPhase
@@ -47,7 +48,17 @@ namespace mock
                 const physics::ThermodynamicMeasurement& measurement
             ) override;
 
-            SuccessPhase(const std::string& name) : control::SimulationPhase(name) {}
+            virtual control::ThermodynamicLogPolicy thermodynamic_log_policy() const override
+                {return thermodynamic_log_;}
+
+            SuccessPhase(
+                const std::string& name, control::ThermodynamicLogPolicy thermodynamic_log = {}
+            )
+                : control::SimulationPhase(name), thermodynamic_log_{thermodynamic_log}
+            {}
+
+        private:
+            control::ThermodynamicLogPolicy thermodynamic_log_;
     };
 
     class FailurePhase : public control::SimulationPhase
@@ -59,7 +70,17 @@ namespace mock
                 const physics::ThermodynamicMeasurement& measurement
             ) override;
 
-            FailurePhase(const std::string& name) : control::SimulationPhase(name) {}
+            virtual control::ThermodynamicLogPolicy thermodynamic_log_policy() const override
+                {return thermodynamic_log_;}
+
+            FailurePhase(
+                const std::string& name, control::ThermodynamicLogPolicy thermodynamic_log = {}
+            )
+                : control::SimulationPhase(name), thermodynamic_log_{thermodynamic_log}
+            {}
+
+        private:
+            control::ThermodynamicLogPolicy thermodynamic_log_;
     };
 } // namespace mock
 
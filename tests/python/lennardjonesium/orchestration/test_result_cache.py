@@ -0,0 +1,156 @@
+"""
+Test storing and restoring simulation results with a ResultCache
+"""
+
+import unittest
+import pathlib
+import shutil
+import os
+from copy import deepcopy
+from unittest import mock
+
+from lennardjonesium.simulation import Configuration
+from lennardjonesium.orchestration.result_cache import ResultCache
+
+from tests.python.paths import temp_dir
+
+
+def _write_outputs(output_dir: pathlib.Path) -> dict[str, pathlib.Path]:
+    """
+    Writes some stand-in output files, and returns them by role.
+    """
+    output_dir.mkdir(parents=True, exist_ok=True)
+
+    files = {
+        'event_log': output_dir / 'events.log',
+        'thermodynamic_log': output_dir / 'thermodynamics.csv',
+        'observation_log': output_dir / 'observations.csv'
+    }
+
+    for role, path in files.items():
+        path.write_text(f'Contents of the {role}\n')
+
+    return files
+
+
+class TestResultCache(unittest.TestCase):
+    def setUp(self):
+        self.test_dir = temp_dir / pathlib.Path(__file__).stem
+        shutil.rmtree(self.test_dir, ignore_errors=True)
+        self.cache = ResultCache(self.test_dir / 'cache')
+
+    def tearDown(self):
+        shutil.rmtree(self.test_dir, ignore_errors=True)
+
+    def test_key(self):
+        run_cfg = Configuration()
+        key = ResultCache.key(run_cfg)
+
+        self.assertEqual(key, ResultCache.key(deepcopy(run_cfg)))
+
+        # File names and the way files are written do not change the results
+        other_cfg = deepcopy(run_cfg)
+        other_cfg.system.thread_count = 4
+        other_cfg.system.checkpoint_interval = 100
+        other_cfg.filepaths.event_log = 'elsewhere/events.log'
+        other_cfg.filepaths.file_backend = 'async'
+        self.assertEqual(key, ResultCache.key(other_cfg))
+
+        # Of the optional files, only whether they are written matters
+        with_trajectory = deepcopy(run_cfg)
+        with_trajectory.filepaths.trajectory = 'trajectory.bin'
+        trajectory_key = ResultCache.key(with_trajectory)
+        self.assertNotEqual(key, trajectory_key)
+
+        with_trajectory.filepaths.trajectory = 'elsewhere/trajectory.bin'
+        self.assertEqual(trajectory_key, ResultCache.key(with_trajectory))
+
+        # The seed and the physical parameters do change the results
+        other_seed = deepcopy(run_cfg)
+        other_seed.system.random_seed += 1
+        self.assertNotEqual(key, ResultCache.key(other_seed))
+
+        other_temperature = deepcopy(run_cfg)
+        other_temperature.system.temperature += 0.1
+        self.assertNotEqual(key, ResultCache.key(other_temperature))
+
+        # A warm start is keyed by the run it starts from
+        chained_key = ResultCache.key(run_cfg, previous_key=key)
+        self.assertNotEqual(key, chained_key)
+        self.assertEqual(chained_key, ResultCache.key(run_cfg, previous_key=key))
+        self.assertNotEqual(chained_key, ResultCache.key(run_cfg, previous_key=trajectory_key))
+
+    def test_store_and_restore(self):
+        files = _write_outputs(self.test_dir / 'original')
+        self.cache.store('key', files)
+
+        for link_available in (True, False):
+            with self.subTest(link_available=link_available):
+                restored = {
+                    role: self.test_dir / f'restored_{link_available}' / path.name
+                    for role, path in files.items()
+                }
+
+                if link_available:
+                    self.assertTrue(self.cache.restore('key', restored))
+                else:
+                    # Without hard links (e.g. across file systems), the files are copied
+                    with mock.patch.object(os, 'link', side_effect=OSError):
+                        self.assertTrue(self.cache.restore('key', restored))
+
+                for role, path in files.items():
+                    cached = self.cache.directory / 'key' / role
+
+                    self.assertEqual(path.read_text(), restored[role].read_text())
+                    self.assertEqual(
+                        link_available, restored[role].stat().st_ino == cached.stat().st_ino
+                    )
+
+    def test_missing_files(self):
+        files = _write_outputs(self.test_dir / 'original')
+        files['final_state'] = self.test_dir / 'original' / 'final_state.bin'
+        self.cache.store('key', files)
+
+        # A file which was missing when stored is removed when restored
+        restored = {role: self.test_dir / 'restored' / path.name for role, path in files.items()}
+        _write_outputs(self.test_dir / 'restored')
+        restored['final_state'].write_text('Left over from an earlier run\n')
+
+        self.assertTrue(self.cache.restore('key', restored))
+        self.assertFalse(restored['final_state'].exists())
+        self.assertTrue(restored['event_log'].exists())
+
+    def test_unknown_key(self):
+        self.assertFalse(self.cache.restore('missing', _write_outputs(self.test_dir / 'restored')))
+
+    def test_corrupted_entry(self):
+        files = _write_outputs(self.test_dir / 'original')
+        self.cache.store('key', files)
+
+        entry = self.cache.directory / 'key'
+        (entry / 'observation_log').write_text('Rewritten in place\n')
+
+        # The entry fails the check against its manifest, and is removed
+        self.assertFalse(self.cache.restore('key', files))
+        self.assertFalse(entry.exists())
+
+    def test_unexpected_roles(self):
+        files = _write_outputs(self.test_dir / 'original')
+        self.cache.store('key', files)
+
+        # The entry holds a file the caller has no place for, so it cannot be restored
+        fewer_files = {
+            role: self.test_dir / 'restored' / path.name
+            for role, path in files.items() if role != 'observation_log'
+        }
+
+        self.assertFalse(self.cache.restore('key', fewer_files))
+        self.assertFalse((self.test_dir / 'restored' / 'events.log').exists())
+
+        # But the entry itself is still valid
+        self.assertTrue((self.cache.directory / 'key').is_dir())
+        self.assertTrue(self.cache.restore('key', files))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,158 @@
+"""
+Test sharing a WorkQueue between several worker processes
+"""
+
+import unittest
+import pathlib
+import shutil
+import multiprocessing
+import os
+import time
+
+from lennardjonesium.orchestration.work_queue import WorkQueue
+
+from tests.python.paths import temp_dir
+
+
+def _work(queue_dir: pathlib.Path, worker_index: int):
+    """
+    Claims jobs until the queue is finished, and records each one in the done/ directory.
+    """
+    with WorkQueue(queue_dir, heartbeat_timeout=1.0, worker_name=f'worker{worker_index}') as queue:
+        while not queue.finished():
+            job = queue.claim()
+
+            if job is None:
+                time.sleep(0.05)
+                continue
+
+            time.sleep(0.01)
+            (queue_dir / 'results' / f'{job.name}.{worker_index}').touch()
+            queue.complete(job)
+
+
+def _reclaim_continually(queue_dir: pathlib.Path, started, stop):
+    """
+    Reclaims stale jobs as fast as possible, until told to stop.
+    """
+    queue = WorkQueue(queue_dir, heartbeat_timeout=2.0, worker_name='reclaimer')
+
+    while not stop.is_set():
+        queue.reclaim_stale()
+        started.set()
+
+
+class TestWorkQueue(unittest.TestCase):
+    def test_several_workers(self):
+        queue_dir = temp_dir / (pathlib.Path(__file__).stem + '_workers')
+        shutil.rmtree(queue_dir, ignore_errors=True)
+        (queue_dir / 'results').mkdir(parents=True)
+
+        queue = WorkQueue(queue_dir)
+        self.assertTrue(queue.populate((f'{i:03d}', [i]) for i in range(40)))
+
+        # A second attempt to populate the queue (as by a second node) does nothing
+        self.assertFalse(WorkQueue(queue_dir).populate([('extra', [])]))
+
+        workers = [
+            multiprocessing.Process(target=_work, args=(queue_dir, i)) for i in range(4)
+        ]
+
+        for worker in workers:
+            worker.start()
+
+        for worker in workers:
+            worker.join()
+
+        # Every job was run exactly once
+        results = sorted(path.name.partition('.')[0] for path in (queue_dir / 'results').iterdir())
+        self.assertEqual(results, [f'{i:03d}' for i in range(40)])
+        self.assertEqual(queue.counts(), (0, 0, 40))
+        self.assertTrue(queue.finished())
+
+        shutil.rmtree(queue_dir)
+
+    def test_reclaim_from_dead_worker(self):
+        queue_dir = temp_dir / (pathlib.Path(__file__).stem + '_reclaim')
+        shutil.rmtree(queue_dir, ignore_errors=True)
+
+        queue = WorkQueue(queue_dir, heartbeat_timeout=0.5, worker_name='dead')
+        queue.populate([('000', [0])])
+
+        # Claim the job without a heartbeat, as a worker which dies straight away
+        dead_job = queue.claim()
+        self.assertEqual(dead_job.data, [0])
+
+        live_queue = WorkQueue(queue_dir, heartbeat_timeout=0.5, worker_name='live')
+        self.assertIsNone(live_queue.claim())
+
+        # Once the claim is stale, it is taken over
+        old_time = time.time() - 1.0
+        os.utime(dead_job.claim_path, (old_time, old_time))
+
+        with live_queue:
+            job = live_queue.claim()
+            self.assertEqual(job.name, '000')
+
+            # The heartbeat keeps the new claim alive
+            time.sleep(0.6)
+            self.assertEqual(live_queue.reclaim_stale(), 0)
+
+            live_queue.complete(job)
+
+        # The dead worker's late completion does nothing
+        queue.complete(dead_job)
+        self.assertTrue(live_queue.finished())
+
+        shutil.rmtree(queue_dir)
+
+    def test_claim_old_jobs_while_reclaiming(self):
+        queue_dir = temp_dir / (pathlib.Path(__file__).stem + '_old_jobs')
+        job_count = 500
+        shutil.rmtree(queue_dir, ignore_errors=True)
+
+        queue = WorkQueue(queue_dir, heartbeat_timeout=2.0, worker_name='worker')
+        queue.populate((f'{i:03d}', [i]) for i in range(job_count))
+
+        # Every job has waited longer than the timeout
+        old_time = time.time() - 10.0
+        for pending in queue.pending_dir.iterdir():
+            os.utime(pending, (old_time, old_time))
+
+        # Several other workers reclaim stale jobs all the while
+        started = [multiprocessing.Event() for _ in range(4)]
+        stop = multiprocessing.Event()
+        reclaimers = [
+            multiprocessing.Process(target=_reclaim_continually, args=(queue_dir, event, stop))
+            for event in started
+        ]
+
+        for reclaimer in reclaimers:
+            reclaimer.start()
+
+        for event in started:
+            event.wait()
+
+        try:
+            with queue:
+                jobs = [queue.claim() for _ in range(job_count)]
+
+                # None of the fresh claims was taken back
+                self.assertEqual(sorted(job.data[0] for job in jobs), list(range(job_count)))
+                self.assertEqual(queue.counts(), (0, job_count, 0))
+
+                for job in jobs:
+                    queue.complete(job)
+        finally:
+            stop.set()
+
+            for reclaimer in reclaimers:
+                reclaimer.join()
+
+        self.assertTrue(queue.finished())
+
+        shutil.rmtree(queue_dir)
+
+
+if __name__ == '__main__':
+    unittest.main()
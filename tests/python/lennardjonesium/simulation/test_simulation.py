@@ -5,16 +5,16 @@ Test running a Simulation from a config file
 import unittest
 import pathlib
 import shutil
+import asyncio
 
-from lennardjonesium.simulation import Configuration, Simulation
+from lennardjonesium.simulation import Configuration, Simulation, SimulationPool
 
 from tests.python.paths import temp_dir
 
 
 class TestSimulation(unittest.TestCase):
-    def test_simulation_from_file(self):
+    def _configuration(self, test_dir):
         this_file = pathlib.Path(__file__)
-        test_dir = temp_dir / this_file.stem
         input_file = this_file.parent / 'test_simulation.ini'
 
         cfg = Configuration.from_file(input_file)
@@ -36,12 +36,111 @@ class TestSimulation(unittest.TestCase):
         observation_log.parent.mkdir(parents=True, exist_ok=True)
         snapshot_log.parent.mkdir(parents=True, exist_ok=True)
 
+        return cfg
+
+    def test_simulation_from_file(self):
+        test_dir = temp_dir / pathlib.Path(__file__).stem
+        cfg = self._configuration(test_dir)
+
         # Create and run the simulation
         sim = Simulation(cfg)
         sim.run(echo=False)
 
         # Make sure observation log has the correct number of lines
-        line_count = sum(1 for _ in open(observation_log))
+        line_count = sum(1 for _ in open(cfg.filepaths.observation_log))
+        self.assertEqual(cfg.observation.observation_count + 1, line_count)
+
+        # Clean up
+        shutil.rmtree(test_dir)
+
+    def test_simulation_in_memory(self):
+        test_dir = temp_dir / (pathlib.Path(__file__).stem + '_in_memory')
+        cfg = self._configuration(test_dir)
+        cfg.filepaths.file_backend = 'memory'
+
+        sim = Simulation(cfg)
+        sim.run(echo=False)
+        logs = sim.memory_logs()
+
+        # The observations are kept in memory, and no log file is written
+        self.assertEqual(cfg.observation.observation_count, len(logs.observations))
+        self.assertIn('Temperature', logs.observations.dtype.names)
+        self.assertFalse(pathlib.Path(cfg.filepaths.observation_log).exists())
+
+        # The arrays remain valid when the simulation is run again
+        temperatures = logs.observations['Temperature'].copy()
+        sim.run(echo=False)
+        self.assertTrue((temperatures == logs.observations['Temperature']).all())
+
+        # Clean up
+        shutil.rmtree(test_dir)
+
+    def test_final_state_and_initial_state(self):
+        test_dir = temp_dir / (pathlib.Path(__file__).stem + '_state')
+        cfg = self._configuration(test_dir)
+
+        sim = Simulation(cfg)
+        self.assertIsNone(sim.final_state())
+
+        sim.run(echo=False)
+        state = sim.final_state()
+
+        # The arrays are read-only views of the final state
+        self.assertEqual((cfg.system.particle_count, 3), state.positions.shape)
+        self.assertFalse(state.positions.flags.writeable)
+
+        # A new simulation can start from them, and the old arrays remain valid
+        next_sim = Simulation(cfg)
+        next_sim.set_initial_state(state.positions, state.velocities)
+        positions = state.positions.copy()
+        next_sim.run(echo=False)
+
+        self.assertTrue((positions == state.positions).all())
+        self.assertFalse((next_sim.final_state().positions == state.positions).all())
+
+        with self.assertRaises(ValueError):
+            next_sim.set_initial_state(state.positions[:-1])
+
+        # Clean up
+        shutil.rmtree(test_dir)
+
+    def test_failing_run(self):
+        test_dir = temp_dir / (pathlib.Path(__file__).stem + '_failing')
+        cfg = self._configuration(test_dir)
+
+        # The log directories are gone, so the run fails
+        shutil.rmtree(test_dir)
+        sim = Simulation(cfg)
+
+        # The C++ exception is raised in Python, rather than terminating the interpreter
+        with self.assertRaises(RuntimeError):
+            sim.run(echo=False)
+
+        with self.assertRaises(RuntimeError):
+            sim.run(echo=True)
+
+        with self.assertRaises(RuntimeError):
+            asyncio.run(sim.run_async())
+
+    def test_simulation_with_asyncio(self):
+        test_dir = temp_dir / (pathlib.Path(__file__).stem + '_asyncio')
+        cfg = self._configuration(test_dir)
+
+        sim = Simulation(cfg)
+        pool_sim = Simulation(cfg)
+        pool = SimulationPool(2)
+
+        # Run one after the other, since both write to the same logs
+        async def run_in_turn():
+            await sim.run_async()
+            pool.push(pool_sim)
+            return await pool.wait_async()
+
+        status = asyncio.run(run_in_turn())
+
+        self.assertEqual(1, status.completed)
+
+        line_count = sum(1 for _ in open(cfg.filepaths.observation_log))
         self.assertEqual(cfg.observation.observation_count + 1, line_count)
 
         # Clean up